@@ -0,0 +1,304 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "mymem.h"
+#include "ordolim.h"
+
+enum BATCHLIMITS {MAX_BATCHLINE = 4096, MAX_TOKENS = 64};
+
+// splits s in place, "quoted strings" are one token
+static int
+tokenize (char *s, char **tok, int max)
+{
+	int n = 0;
+
+	for (;;) {
+		while (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') s++;
+		if (*s == '\0' || *s == '#') break;
+		if (n == max) return -1;
+		if (*s == '"') {
+			tok[n++] = ++s;
+			while (*s != '\0' && *s != '"') s++;
+		} else {
+			tok[n++] = s;
+			while (*s != '\0' && *s != ' ' && *s != '\t' && *s != '\n' && *s != '\r') s++;
+		}
+		if (*s == '\0') break;
+		*s++ = '\0';
+	}
+	return n;
+}
+
+static bool_t
+number (const char *s, double *x)
+{
+	return s != NULL && 1 == sscanf (s, "%lf", x);
+}
+
+// same meaning as in the command line, see main.c
+static const char *
+job_parse (char *s, const struct ordo_config *base, long simulate, struct BATCHJOB *j)
+{
+	char *tok[MAX_TOKENS];
+	int i, n;
+	bool_t switch_w = FALSE, switch_u = FALSE, switch_d = FALSE, switch_k = FALSE;
+	double wa_sd = 0, dr_pc = 0, dr_pc_sd = 0, x;
+	struct ordo_config *cfg = &j->cfg;
+
+	*cfg = *base;
+	cfg->quiet = TRUE; // lines run at the same time
+	j->simulate = simulate;
+	j->textstr = NULL;
+	j->csvstr = NULL;
+	j->ctx = NULL;
+	j->ok = FALSE;
+
+	if (0 > (n = tokenize (s, tok, MAX_TOKENS)))
+		return "too many switches";
+
+	for (i = 0; i < n; i++) {
+		const char *sw = tok[i];
+		const char *arg = i+1 < n? tok[i+1]: NULL;
+
+		if (sw[0] != '-' || sw[1] == '\0' || sw[2] != '\0')
+			return "switches are expected";
+
+		switch (sw[1]) {
+			case 'V':	cfg->anchor_err_rel2avg = TRUE; continue;
+			case 'M':	cfg->force_ml = TRUE; continue;
+			case 'X':	cfg->ignore_draws = TRUE; continue;
+			case 'G':	cfg->groupcheck = FALSE; continue;
+			case 'W':	cfg->adjust_white_advantage = TRUE;
+						cfg->wa_prior.isset = FALSE;
+						cfg->wa_prior.value = 0;
+						cfg->wa_prior.sigma = 200.0;
+						continue;
+			case 'D':	cfg->adjust_draw_rate = TRUE;
+						cfg->dr_prior.isset = FALSE;
+						cfg->dr_prior.value = 0.5;
+						cfg->dr_prior.sigma = 0.5;
+						continue;
+			default:	break;
+		}
+
+		if (arg == NULL) return "switch without its parameter";
+		i++;
+
+		switch (sw[1]) {
+			case 'A':	cfg->anchor_name = arg; break;
+			case 'y':	cfg->loose_anchors = arg; break;
+			case 'm':	cfg->multi_anchors = arg; break;
+			case 'r':	cfg->relations = arg; break;
+			case 'o':	j->textstr = arg; break;
+			case 'c':	j->csvstr = arg; break;
+			case 'a':	if (!number (arg, &cfg->general_average)) return "wrong average parameter";
+						break;
+			case 'z':	if (!number (arg, &cfg->rtng_76)) return "wrong scaling parameter";
+						break;
+			case 's':	if (!number (arg, &x) || x < 0) return "wrong simulation parameter";
+						j->simulate = (long)x;
+						break;
+			case 'w':	if (!number (arg, &cfg->white_advantage)) return "wrong white advantage parameter";
+						cfg->adjust_white_advantage = FALSE;
+						cfg->wa_prior.isset = FALSE;
+						switch_w = TRUE;
+						break;
+			case 'u':	if (!number (arg, &wa_sd)) return "wrong white advantage uncertainty parameter";
+						switch_u = TRUE;
+						break;
+			case 'd':	if (!number (arg, &dr_pc) || dr_pc < 0.0 || dr_pc > 100.0) return "wrong draw rate parameter";
+						cfg->drawrate = dr_pc/100.0;
+						cfg->adjust_draw_rate = FALSE;
+						cfg->dr_prior.isset = FALSE;
+						switch_d = TRUE;
+						break;
+			case 'k':	if (!number (arg, &dr_pc_sd)) return "wrong draw rate uncertainty parameter";
+						switch_k = TRUE;
+						break;
+			default:	return "switch not allowed in a batch file";
+		}
+	}
+
+	if (switch_w && switch_u) {
+		cfg->wa_prior.isset = wa_sd > PRIOR_SMALLEST_SIGMA;
+		cfg->wa_prior.value = cfg->white_advantage;
+		cfg->wa_prior.sigma = wa_sd;
+		cfg->adjust_white_advantage = cfg->wa_prior.isset;
+	}
+	if (switch_d && switch_k) {
+		cfg->dr_prior.isset = dr_pc_sd > PRIOR_SMALLEST_SIGMA;
+		cfg->dr_prior.value = dr_pc/100.0;
+		cfg->dr_prior.sigma = dr_pc_sd/100.0;
+		cfg->adjust_draw_rate = cfg->dr_prior.isset;
+	}
+	cfg->prior_mode = cfg->prior_mode || switch_u || switch_k;
+
+	return NULL;
+}
+
+static char *
+string_dup (const char *s)
+{
+	char *p = memnew (strlen(s) + 1);
+	if (p) strcpy (p, s);
+	return p;
+}
+
+void
+batch_load (const char *fname, const struct ordo_config *base, long simulate, struct BATCH *b)
+{
+	FILE *f;
+	char buffer[MAX_BATCHLINE];
+	char scan[MAX_BATCHLINE];
+	char *tok[1];
+	size_t size = 0;
+	long line_n = 0;
+
+	b->n = 0;
+	b->job = NULL;
+	b->line = NULL;
+
+	if (NULL == (f = fopen (fname, "r"))) {
+		fprintf (stderr, "Errors with file: %s\n", fname);
+		exit(EXIT_FAILURE);
+	}
+
+	while (NULL != fgets (buffer, MAX_BATCHLINE, f)) {
+		const char *err;
+		char *copy;
+
+		line_n++;
+		if (NULL == strchr (buffer, '\n') && !feof(f)) {
+			fprintf (stderr, "Batch file \"%s\", line %ld: too long\n", fname, line_n);
+			exit(EXIT_FAILURE);
+		}
+
+		strcpy (scan, buffer);
+		if (0 == tokenize (scan, tok, 1)) continue; // empty or comment
+
+		if (b->n == size) {
+			size_t newsize = size == 0? 16: 2 * size;
+			struct BATCHJOB *j = memnew (sizeof(struct BATCHJOB) * newsize);
+			char **l = memnew (sizeof(char *) * newsize);
+			if (j == NULL || l == NULL) {
+				fprintf (stderr, "Not enough memory for the batch file\n");
+				exit(EXIT_FAILURE);
+			}
+			if (size > 0) {
+				memcpy (j, b->job, sizeof(struct BATCHJOB) * size);
+				memcpy (l, b->line, sizeof(char *) * size);
+				memrel (b->job);
+				memrel (b->line);
+			}
+			b->job = j;
+			b->line = l;
+			size = newsize;
+		}
+
+		if (NULL == (copy = string_dup (buffer))) {
+			fprintf (stderr, "Not enough memory for the batch file\n");
+			exit(EXIT_FAILURE);
+		}
+		b->line[b->n] = copy;
+		if (NULL != (err = job_parse (copy, base, simulate, &b->job[b->n]))) {
+			fprintf (stderr, "Batch file \"%s\", line %ld: %s\n", fname, line_n, err);
+			exit(EXIT_FAILURE);
+		}
+		b->job[b->n].line_n = line_n;
+		b->n++;
+	}
+
+	fclose (f);
+
+	if (b->n == 0) {
+		fprintf (stderr, "Batch file \"%s\" has no configurations\n", fname);
+		exit(EXIT_FAILURE);
+	}
+}
+
+void
+batch_done (struct BATCH *b)
+{
+	size_t i;
+	for (i = 0; i < b->n; i++) {
+		ordo_free (b->job[i].ctx);
+		memrel (b->line[i]);
+	}
+	if (b->job) memrel (b->job);
+	if (b->line) memrel (b->line);
+	b->n = 0;
+	b->job = NULL;
+	b->line = NULL;
+}
+
+struct SOLVEARG {
+	  struct BATCH *		b
+	; const struct ordo_ctx *lender
+	;
+};
+
+static void
+solve_range (void *arg, long first, long last, int worker)
+{
+	struct SOLVEARG *sa = arg;
+	long i;
+	(void)worker;
+
+	for (i = first; i < last; i++) {
+		struct BATCHJOB *j = &sa->b->job[i];
+		j->ok	=  ordo_load_shared (j->ctx, sa->lender)
+				&& ordo_priors (j->ctx)
+				&& ordo_transform (j->ctx)
+				&& ordo_solve (j->ctx);
+	}
+}
+
+bool_t
+batch_solve (struct BATCH *b, const struct ordo_ctx *lender, thpool_t *pool, const struct SIMCTRL *simctrl)
+{
+	struct SOLVEARG sa;
+	bool_t ok = TRUE;
+	size_t i;
+
+	for (i = 0; i < b->n; i++) {
+		if (NULL == (b->job[i].ctx = ordo_new (&b->job[i].cfg))) {
+			fprintf (stderr, "Not enough memory for the batch configurations\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	sa.b = b;
+	sa.lender = lender;
+	thpool_parallel_for (pool, 0, (long)b->n, 1, solve_range, &sa);
+
+	// each one uses the whole pool
+	for (i = 0; i < b->n; i++) {
+		struct BATCHJOB *j = &b->job[i];
+		if (j->ok && j->simulate > 1)
+			j->simulate = ordo_simulate (j->ctx, pool, j->simulate, simctrl, FALSE);
+		ok = ok && j->ok;
+	}
+	return ok;
+}
@@ -0,0 +1,72 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_BATCH)
+#define H_BATCH
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "boolean.h"
+#include "libordo.h"
+#include "sim.h"
+#include "thpool.h"
+
+/*
+|	Several configurations of the same games, one per line of a batch file:
+|
+|		# comment
+|		-o plain.txt -c plain.csv
+|		-W -D -o white.txt
+|		-A "Some Engine" -a 3000 -s 200 -o anchored.txt -c anchored.csv
+|		-X -o nodraws.txt
+|
+|	Every line starts from the configuration of the command line. Allowed
+|	switches are -a -A -V -M -w -u -W -d -k -D -z -X -G -y -m -r -s -o -c.
+|	The games are parsed and sorted once, in the context given to
+|	batch_solve. The lines are solved in parallel, their simulations run
+|	one after the other on the whole pool.
+\*--------------------------------------------------------------*/
+
+struct BATCHJOB {
+	  struct ordo_config	cfg
+	; long					simulate
+	; const char *			textstr		// NULL, standard output
+	; const char *			csvstr		// NULL if not used
+	; struct ordo_ctx *		ctx
+	; bool_t				ok
+	; long					line_n		// in the batch file
+	;
+};
+
+struct BATCH {
+	  size_t				n
+	; struct BATCHJOB *		job
+	; char **				line		// storage of the strings pointed by job
+	;
+};
+
+// exits with a message if the file cannot be read or a line is wrong
+extern void		batch_load (const char *fname, const struct ordo_config *base, long simulate, struct BATCH *b);
+extern void		batch_done (struct BATCH *b);
+
+// FALSE if any job failed, its reason is in ordo_errmsg(job->ctx)
+extern bool_t	batch_solve (struct BATCH *b, const struct ordo_ctx *lender, thpool_t *pool, const struct SIMCTRL *simctrl);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
@@ -35,6 +35,7 @@ struct GAMEBLOCK {
 	player_t	white	[MAXGAMESxBLOCK];
 	player_t	black	[MAXGAMESxBLOCK];
 	int32_t		score	[MAXGAMESxBLOCK];
+	int32_t		date	[MAXGAMESxBLOCK];	// yyyymmdd, 0 if unknown
 };
 
 struct NAMENODE {
@@ -45,6 +46,9 @@ struct NAMENODE {
 
 typedef struct NAMENODE namenode_t;
 
+// receives the games instead of the game blocks, FALSE if it failed
+typedef bool_t (*gamesink_t) (void *arg, player_t white, player_t black, int result);
+
 struct DATA {	
 	player_t	n_players;
 	gamesnum_t	n_games;
@@ -63,6 +67,11 @@ struct DATA {
 	size_t		gb_allocated;
 
 	struct GAMEBLOCK *gb[MAXBLOCKS];
+
+	gamesink_t	sink;			// NULL, games are kept in gb
+	void *		sink_arg;
+
+	struct NAMESTORE *names;	// name lookup, see namehash.c
 };
 
 
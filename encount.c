@@ -22,12 +22,16 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
+#include <stddef.h>
 
 #include "encount.h"
 #include "mytypes.h"
 #include "pgnget.h"
 #include "xpect.h"
 #include "mymem.h"
+#include "stats.h"
+#include "radix.h"
 
 //Statics
 
@@ -96,8 +100,8 @@ encounters_copy (const struct ENCOUNTERS *src, struct ENCOUNTERS *tgt)
 	gamesnum_t i, n = src->n;
 	struct ENC *s = src->enc;
 	struct ENC *t = tgt->enc; 
+	assert (tgt->size >= n);
 	tgt->n = src->n;
-	tgt->size = src->size;
 	for (i = 0; i < n; i++) {
 		t[i] = s[i];
 	}
@@ -107,7 +111,7 @@ bool_t
 encounters_replicate (const struct ENCOUNTERS *src, struct ENCOUNTERS *tgt)
 {
 	bool_t ok;
-	ok = encounters_init (src->size, tgt);
+	ok = encounters_init (src->n > 0? src->n: 1, tgt);
 	if (ok) {
 		encounters_copy (src, tgt);
 	}
@@ -129,6 +133,230 @@ encounters_calculate
 					, g
 					, flagged
 					, e->enc);
+	STAT_ADD (STAT_ENCOUNTERS, e->n);
+}
+
+/*
+|	Same result as encounters_calculate(), but derived from a list
+|	previously obtained with ENCOUNTERS_FULL. That list is already sorted
+|	and merged, so no games need to be scanned and no sorting is needed.
+*/
+// no globals
+void
+encounters_select
+				( int selectivity
+				, const struct ENCOUNTERS *full
+				, const bool_t *flagged
+				, struct ENCOUNTERS	*e
+) 
+{
+	gamesnum_t i, n = full->n;
+	const struct ENC *s = full->enc;
+	struct ENC *t = e->enc;
+	gamesnum_t ne = 0;
+
+	assert (e->size >= n);
+
+	if (selectivity == ENCOUNTERS_NOFLAGGED) {
+		for (i = 0; i < n; i++) {
+			if (!flagged[s[i].wh] && !flagged[s[i].bl])
+				t[ne++] = s[i];
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			t[ne++] = s[i];
+		}
+	}
+	e->n = ne;
+}
+
+/*
+|	a and b sorted and merged as encounters_calculate() leaves them. tgt
+|	gets the encounters of both in that same order, pairs found in both
+|	are added up. Same result as calculating them from all the games.
+*/
+bool_t
+encounters_merge (const struct ENCOUNTERS *a, const struct ENCOUNTERS *b, struct ENCOUNTERS *tgt)
+{
+	const struct ENC *x = a->enc;
+	const struct ENC *y = b->enc;
+	gamesnum_t i = 0, j = 0, n = 0;
+	int c;
+
+	if (!encounters_init (a->n + b->n > 0? a->n + b->n: 1, tgt))
+		return FALSE;
+
+	while (i < a->n && j < b->n) {
+		c = compare_ENC (&x[i], &y[j]);
+		if (c < 0)
+			tgt->enc[n++] = x[i++];
+		else if (c > 0)
+			tgt->enc[n++] = y[j++];
+		else
+			tgt->enc[n++] = encounter_merge (&x[i++], &y[j++]);
+	}
+	while (i < a->n) tgt->enc[n++] = x[i++];
+	while (j < b->n) tgt->enc[n++] = y[j++];
+	tgt->n = n;
+	return TRUE;
+}
+
+// no globals
+gamesnum_t
+encounters_played (const struct ENCOUNTERS *e)
+{
+	gamesnum_t i, n = e->n;
+	gamesnum_t played = 0;
+	for (i = 0; i < n; i++) {
+		played += e->enc[i].played;
+	}
+	return played;
+}
+
+/*
+|	With no white advantage, A-B and B-A are the same encounter seen from
+|	opposite sides. encmerge_apply() adds them up as one, with the lower
+|	player as white and the wins and losses of the other side swapped.
+|	The pairs are matched once and kept in ENCMERGE, they are matched again
+|	only when e does not have the same ones. e should be sorted as
+|	encounters_calculate() leaves it, otherwise some pairs are not merged.
+*/
+
+void
+encmerge_init (struct ENCMERGE *m)
+{
+	m->n		= 0;
+	m->merged	= 0;
+	m->slot		= NULL;
+	m->enc		= NULL;
+}
+
+void
+encmerge_done (struct ENCMERGE *m)
+{
+	if (m->slot) memrel (m->slot);
+	if (m->enc)  memrel (m->enc);
+	encmerge_init (m);
+}
+
+bool_t
+encmerge_replicate (const struct ENCMERGE *src, struct ENCMERGE *tgt)
+{
+	encmerge_init (tgt);
+	if (src == NULL || src->slot == NULL) return TRUE; // nothing matched yet
+
+	tgt->slot	= memnew (sizeof(gamesnum_t) * (size_t)src->n);
+	tgt->enc	= memnew (sizeof(struct ENC) * (size_t)src->merged);
+	if (tgt->slot == NULL || tgt->enc == NULL) {
+		encmerge_done (tgt);
+		return FALSE;
+	}
+	memcpy (tgt->slot, src->slot, sizeof(gamesnum_t) * (size_t)src->n);
+	memcpy (tgt->enc,  src->enc,  sizeof(struct ENC) * (size_t)src->merged);
+	tgt->n		= src->n;
+	tgt->merged	= src->merged;
+	return TRUE;
+}
+
+// every encounter of e still goes to a pair of the same two players
+static bool_t
+encmerge_matches (const struct ENCMERGE *m, const struct ENCOUNTERS *e)
+{
+	gamesnum_t i;
+	if (m->slot == NULL || m->n != e->n) return FALSE;
+	for (i = 0; i < e->n; i++) {
+		const struct ENC *x = &e->enc[i];
+		const struct ENC *p = &m->enc[m->slot[i]];
+		if (x->wh < x->bl? (p->wh != x->wh || p->bl != x->bl): (p->wh != x->bl || p->bl != x->wh))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+// index of (wh, bl) among the first n encounters of e, -1 if not there
+static gamesnum_t
+encounter_find (const struct ENCOUNTERS *e, gamesnum_t n, player_t wh, player_t bl)
+{
+	gamesnum_t lo = 0, hi = n, mid;
+	struct ENC key;
+	int c;
+
+	key.wh = wh;
+	key.bl = bl;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		c = compare_ENC (&e->enc[mid], &key);
+		if (c == 0) return mid;
+		if (c < 0) lo = mid + 1; else hi = mid;
+	}
+	return -1;
+}
+
+static bool_t
+encmerge_build (struct ENCMERGE *m, const struct ENCOUNTERS *e)
+{
+	gamesnum_t i, j, k = 0;
+
+	encmerge_done (m);
+	if (NULL == (m->slot = memnew (sizeof(gamesnum_t) * (size_t)(e->n > 0? e->n: 1))))
+		return FALSE;
+
+	for (i = 0; i < e->n; i++) {
+		const struct ENC *x = &e->enc[i];
+		// the other color sorts first, its white is the lower player
+		if (x->wh > x->bl && (j = encounter_find (e, i, x->bl, x->wh)) >= 0)
+			m->slot[i] = m->slot[j];
+		else
+			m->slot[i] = k++;
+	}
+
+	if (NULL == (m->enc = memnew (sizeof(struct ENC) * (size_t)(k > 0? k: 1)))) {
+		encmerge_done (m);
+		return FALSE;
+	}
+	for (i = 0; i < e->n; i++) {
+		const struct ENC *x = &e->enc[i];
+		m->enc[m->slot[i]].wh = x->wh < x->bl? x->wh: x->bl;
+		m->enc[m->slot[i]].bl = x->wh < x->bl? x->bl: x->wh;
+	}
+	m->n = e->n;
+	m->merged = k;
+	STAT_INC (STAT_ENCMERGE_BUILDS);
+	return TRUE;
+}
+
+const struct ENC *
+encmerge_apply (struct ENCMERGE *m, const struct ENCOUNTERS *e, gamesnum_t *n_merged)
+{
+	gamesnum_t i, k;
+
+	if (!encmerge_matches (m, e) && !encmerge_build (m, e))
+		return NULL;
+
+	for (k = 0; k < m->merged; k++) {
+		m->enc[k].W = m->enc[k].D = m->enc[k].L = 0;
+	}
+	// integer sums, the same whatever the order
+	for (i = 0; i < e->n; i++) {
+		const struct ENC *x = &e->enc[i];
+		struct ENC *p = &m->enc[m->slot[i]];
+		if (p->wh == x->wh) {
+			p->W += x->W;
+			p->L += x->L;
+		} else {
+			p->W += x->L;
+			p->L += x->W;
+		}
+		p->D += x->D;
+	}
+	for (k = 0; k < m->merged; k++) {
+		m->enc[k].played = m->enc[k].W + m->enc[k].D + m->enc[k].L;
+		m->enc[k].wscore = (double)m->enc[k].W + 0.5 * (double)m->enc[k].D;
+	}
+
+	STAT_ADD (STAT_ENCOUNTERS_MERGED, e->n - m->merged);
+	*n_merged = m->merged;
+	return m->enc;
 }
 
 // no globals
@@ -174,7 +402,11 @@ calc_encounters ( int selectivity
 
 	ne = shrink_ENC (enc, ne);
 	if (ne > 0) {
-		qsort (enc, (size_t)ne, sizeof(struct ENC), compare_ENC);
+		// no pool, it may run inside the simulation threads
+		if (!radix_sort_pairs	( enc, (size_t)ne, sizeof(struct ENC)
+								, offsetof(struct ENC, wh), offsetof(struct ENC, bl)
+								, sizeof(player_t), NULL))
+			qsort (enc, (size_t)ne, sizeof(struct ENC), compare_ENC);
 		ne = shrink_ENC (enc, ne);
 	}
 	return ne;
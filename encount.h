@@ -44,6 +44,32 @@ encounters_calculate
 				, struct ENCOUNTERS	*e
 );
 
+// no globals
+extern void
+encounters_select
+				( int selectivity
+				, const struct ENCOUNTERS *full
+				, const bool_t *flagged
+				, struct ENCOUNTERS	*e
+);
+
+// FALSE if there is no memory, tgt is initialized here
+extern bool_t
+encounters_merge (const struct ENCOUNTERS *a, const struct ENCOUNTERS *b, struct ENCOUNTERS *tgt);
+
+// no globals
+extern gamesnum_t
+encounters_played (const struct ENCOUNTERS *e);
+
+extern void		encmerge_init (struct ENCMERGE *m);
+extern void		encmerge_done (struct ENCMERGE *m);
+extern bool_t	encmerge_replicate (const struct ENCMERGE *src, struct ENCMERGE *tgt); // src may be NULL
+
+// e with both colors of each pair added up, merged ones in n_merged, or
+// NULL if there is no memory. The result is kept in m until the next call
+extern const struct ENC *
+encmerge_apply (struct ENCMERGE *m, const struct ENCOUNTERS *e, gamesnum_t *n_merged);
+
 // no globals
 extern void
 calc_obtained_playedby 	( const struct ENC *enc
@@ -0,0 +1,376 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "extenc.h"
+#include "pgnget.h"
+#include "mymem.h"
+#include "sysport.h"
+#include "radix.h"
+
+#define EXT_FANIN	64			// runs merged at once, fewer if files are limited
+#define EXT_IOBUF	(1 << 16)	// stdio buffer of each run
+
+struct EXTENC {
+	  char				dir[FILENAME_MAX]
+	; long				id						// process, in the file names
+	; bool_t			ignore_draws
+	; struct gamei *	buf						// games of the run being filled
+	; size_t			buf_n
+	; size_t			buf_size
+	; int				run_first				// runs not merged yet, run_first..run_next-1
+	; int				run_next
+	; bool_t			failed
+	; gamesnum_t		gamestat[8]
+	; gamesnum_t		kept					// games with a valid result
+	; bool_t			merged					// the file of encounters exists
+	; const struct ENC *map
+	; size_t			map_size
+	;
+};
+
+struct RUNHEAD {
+	  FILE *			f
+	; struct ENC		e						// next encounter of the run
+	;
+};
+
+/*--------------------------------------------------------------*\
+|	File names
+\*--------------------------------------------------------------*/
+
+static bool_t
+run_name (const extenc_t *x, int k, char *s, size_t n)
+{
+	int r = snprintf (s, n, "%s%sordo-%ld-%d.run", x->dir, FOLDERSEP, x->id, k);
+	return r > 0 && (size_t)r < n;
+}
+
+static bool_t
+enc_name (const extenc_t *x, char *s, size_t n)
+{
+	int r = snprintf (s, n, "%s%sordo-%ld.enc", x->dir, FOLDERSEP, x->id);
+	return r > 0 && (size_t)r < n;
+}
+
+static FILE *
+fopen_buffered (const char *s, const char *mode)
+{
+	FILE *f = fopen (s, mode);
+	if (f != NULL) setvbuf (f, NULL, _IOFBF, EXT_IOBUF);
+	return f;
+}
+
+/*--------------------------------------------------------------*\
+|	Runs
+\*--------------------------------------------------------------*/
+
+static int
+compare_gamei (const void *a, const void *b)
+{
+	const struct gamei *ap = a;
+	const struct gamei *bp = b;
+	if (ap->whiteplayer != bp->whiteplayer) return ap->whiteplayer > bp->whiteplayer? 1: -1;
+	if (ap->blackplayer != bp->blackplayer) return ap->blackplayer > bp->blackplayer? 1: -1;
+	return 0;
+}
+
+static int
+compare_pair (const struct ENC *a, const struct ENC *b)
+{
+	if (a->wh != b->wh) return a->wh > b->wh? 1: -1;
+	if (a->bl != b->bl) return a->bl > b->bl? 1: -1;
+	return 0;
+}
+
+static void
+enc_from_game (const struct gamei *g, struct ENC *e)
+{
+	e->wh = g->whiteplayer;
+	e->bl = g->blackplayer;
+	e->played = 1;
+	e->W = e->D = e->L = 0;
+	switch (g->score) {
+		case WHITE_WIN: 	e->wscore = 1.0; e->W = 1; break;
+		case RESULT_DRAW:	e->wscore = 0.5; e->D = 1; break;
+		default:			e->wscore = 0.0; e->L = 1; break;
+	}
+}
+
+static void
+enc_add (struct ENC *a, const struct ENC *b)
+{
+	a->wscore += b->wscore;
+	a->played += b->played;
+	a->W += b->W;
+	a->D += b->D;
+	a->L += b->L;
+}
+
+static bool_t
+run_write (extenc_t *x)
+{
+	char s[FILENAME_MAX];
+	struct ENC e, g;
+	size_t i;
+	FILE *f;
+	bool_t ok;
+
+	if (x->buf_n == 0) return TRUE;
+
+	if (!radix_sort_pairs	( x->buf, x->buf_n, sizeof(struct gamei)
+							, offsetof(struct gamei, whiteplayer), offsetof(struct gamei, blackplayer)
+							, sizeof(player_t), NULL))
+		qsort (x->buf, x->buf_n, sizeof(struct gamei), compare_gamei);
+
+	if (!run_name (x, x->run_next, s, sizeof(s)) || NULL == (f = fopen_buffered (s, "wb")))
+		return FALSE;
+	x->run_next++;
+
+	enc_from_game (&x->buf[0], &e);
+	ok = TRUE;
+	for (i = 1; ok && i < x->buf_n; i++) {
+		enc_from_game (&x->buf[i], &g);
+		if (0 == compare_pair (&e, &g)) {
+			enc_add (&e, &g);
+		} else {
+			ok = 1 == fwrite (&e, sizeof(e), 1, f);
+			e = g;
+		}
+	}
+	ok = ok && 1 == fwrite (&e, sizeof(e), 1, f);
+	ok = 0 == fclose (f) && ok;
+
+	x->buf_n = 0;
+	return ok;
+}
+
+/*--------------------------------------------------------------*\
+|	Merge, a heap of the heads of the runs
+\*--------------------------------------------------------------*/
+
+static void
+sift_down (struct RUNHEAD *h, int n, int i)
+{
+	struct RUNHEAD t;
+	int c;
+
+	while ((c = 2*i + 1) < n) {
+		if (c + 1 < n && compare_pair (&h[c+1].e, &h[c].e) < 0) c++;
+		if (compare_pair (&h[c].e, &h[i].e) >= 0) break;
+		t = h[i]; h[i] = h[c]; h[c] = t;
+		i = c;
+	}
+}
+
+// runs first..first+k-1 go to fout, and are removed
+static bool_t
+runs_merge (extenc_t *x, int first, int k, FILE *fout)
+{
+	char s[FILENAME_MAX];
+	struct RUNHEAD *h;
+	struct ENC e;
+	int i, n = 0;
+	bool_t ok = TRUE, pending = FALSE;
+
+	if (NULL == (h = memnew (sizeof(struct RUNHEAD) * (size_t)k)))
+		return FALSE;
+
+	for (i = 0; ok && i < k; i++) {
+		ok = run_name (x, first + i, s, sizeof(s)) && NULL != (h[n].f = fopen_buffered (s, "rb"));
+		if (ok) {
+			if (1 == fread (&h[n].e, sizeof(struct ENC), 1, h[n].f))
+				n++;
+			else
+				fclose (h[n].f);
+		}
+	}
+
+	for (i = n/2 - 1; i >= 0; i--) sift_down (h, n, i);
+
+	while (ok && n > 0) {
+		if (pending && 0 == compare_pair (&e, &h[0].e)) {
+			enc_add (&e, &h[0].e);
+		} else {
+			ok = !pending || 1 == fwrite (&e, sizeof(e), 1, fout);
+			e = h[0].e;
+			pending = TRUE;
+		}
+		if (1 != fread (&h[0].e, sizeof(struct ENC), 1, h[0].f)) {
+			fclose (h[0].f);
+			h[0] = h[--n];
+		}
+		sift_down (h, n, 0);
+	}
+	ok = ok && (!pending || 1 == fwrite (&e, sizeof(e), 1, fout));
+
+	for (i = 0; i < n; i++) fclose (h[i].f); // only if it failed
+	for (i = 0; i < k; i++) {
+		if (run_name (x, first + i, s, sizeof(s))) remove (s);
+	}
+
+	memrel (h);
+	return ok;
+}
+
+static int
+fanin (void)
+{
+	int m = mysys_fopen_max () / 2;
+	return m < 2? 2: (m < EXT_FANIN? m: EXT_FANIN);
+}
+
+/*--------------------------------------------------------------*\
+|	Interface
+\*--------------------------------------------------------------*/
+
+extenc_t *
+extenc_open (const char *dir, size_t run_games, bool_t ignore_draws)
+{
+	char s[FILENAME_MAX];
+	extenc_t *x;
+	FILE *f;
+
+	if (strlen(dir) >= FILENAME_MAX || NULL == (x = memnew (sizeof(extenc_t))))
+		return NULL;
+
+	memset (x, 0, sizeof(extenc_t));
+	if (NULL == (x->buf = memnew (sizeof(struct gamei) * run_games))) {
+		memrel (x);
+		return NULL;
+	}
+	strcpy (x->dir, dir);
+	x->id = mysys_pid ();
+	x->ignore_draws = ignore_draws;
+	x->buf_size = run_games;
+
+	// fails now, not after parsing, if dir cannot be written
+	if (!enc_name (x, s, sizeof(s)) || NULL == (f = fopen (s, "wb"))) {
+		extenc_close (x);
+		return NULL;
+	}
+	fclose (f);
+	remove (s);
+	return x;
+}
+
+bool_t
+extenc_add (void *p, player_t white, player_t black, int result)
+{
+	extenc_t *x = p;
+
+	if (x->ignore_draws && result == RESULT_DRAW) result |= IGNORED;
+	if (result >= 0 && result < 8) x->gamestat[result]++;
+	if (result >= DISCARD) return TRUE;
+	x->kept++;
+
+	x->buf[x->buf_n].whiteplayer = white;
+	x->buf[x->buf_n].blackplayer = black;
+	x->buf[x->buf_n].score = result;
+	x->buf_n++;
+
+	if (x->buf_n == x->buf_size && !run_write (x))
+		x->failed = TRUE;
+	return !x->failed;
+}
+
+bool_t
+extenc_finish (extenc_t *x)
+{
+	char s[FILENAME_MAX];
+	int k, f = fanin ();
+	FILE *fout;
+	bool_t ok;
+
+	ok = !x->failed && run_write (x);
+
+	memrel (x->buf);
+	x->buf = NULL;
+
+	// several passes if there are too many runs
+	while (ok && x->run_next - x->run_first > f) {
+		ok = run_name (x, x->run_next, s, sizeof(s)) && NULL != (fout = fopen_buffered (s, "wb"));
+		if (ok) {
+			x->run_next++;
+			ok = runs_merge (x, x->run_first, f, fout);
+			ok = 0 == fclose (fout) && ok;
+			x->run_first += f;
+		}
+	}
+
+	ok = ok && enc_name (x, s, sizeof(s)) && NULL != (fout = fopen_buffered (s, "wb"));
+	if (ok) {
+		x->merged = TRUE;
+		k = x->run_next - x->run_first;
+		ok = runs_merge (x, x->run_first, k, fout);
+		ok = 0 == fclose (fout) && ok;
+		x->run_first += k;
+	}
+
+	// nothing to map if there are no valid games
+	ok = ok && (x->kept == 0 || NULL != (x->map = map_file (s, &x->map_size)));
+
+	// a mapped file can be removed, except on Windows, so nothing is left after an exit()
+	if (ok && 0 == remove (s))
+		x->merged = FALSE;
+
+	x->failed = !ok;
+	return ok;
+}
+
+const struct ENC *
+extenc_enc (const extenc_t *x, gamesnum_t *n)
+{
+	assert (x->map != NULL || x->kept == 0); // the file may be removed already
+	*n = (gamesnum_t)(x->map_size / sizeof(struct ENC));
+	return x->map;
+}
+
+void
+extenc_stats (const extenc_t *x, struct GAMESTATS *gs)
+{
+	const gamesnum_t *g = x->gamestat;
+	gs->white_wins	= g[WHITE_WIN];
+	gs->draws		= g[RESULT_DRAW];
+	gs->black_wins	= g[BLACK_WIN];
+	gs->noresult	= g[DISCARD] + g[IGNORED|WHITE_WIN] + g[IGNORED|RESULT_DRAW] + g[IGNORED|BLACK_WIN];
+}
+
+void
+extenc_close (extenc_t *x)
+{
+	char s[FILENAME_MAX];
+	int k;
+
+	if (x == NULL) return;
+
+	if (x->map != NULL) unmap_file (x->map, x->map_size);
+	if (x->merged && enc_name (x, s, sizeof(s))) remove (s);
+	for (k = x->run_first; k < x->run_next; k++) { // left by a failure
+		if (run_name (x, k, s, sizeof(s))) remove (s);
+	}
+	if (x->buf != NULL) memrel (x->buf); // released by extenc_finish
+	memrel (x);
+}
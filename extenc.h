@@ -0,0 +1,50 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_EXTENC)
+#define H_EXTENC
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include <stddef.h>
+#include "boolean.h"
+#include "mytypes.h"
+
+/*
+|	Encounters of databases that do not fit in memory. Games arrive one
+|	by one (extenc_add is a gamesink_t), and every run_games of them are
+|	sorted and written, already merged by pair of players, to a file in
+|	dir. At the end, the runs are merged into one file of encounters,
+|	sorted as encounters_calculate() would, which is mapped read-only.
+|	All the files are removed by extenc_close.
+\*--------------------------------------------------------------*/
+
+typedef struct EXTENC extenc_t;
+
+extern extenc_t *	extenc_open (const char *dir, size_t run_games, bool_t ignore_draws);
+extern bool_t		extenc_add (void *x, player_t white, player_t black, int result);
+extern bool_t		extenc_finish (extenc_t *x);
+extern void			extenc_close (extenc_t *x);
+
+// after extenc_finish
+extern const struct ENC *extenc_enc (const extenc_t *x, gamesnum_t *n);
+extern void			extenc_stats (const extenc_t *x, struct GAMESTATS *gs);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
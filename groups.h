@@ -28,83 +28,30 @@
 #include "boolean.h"
 #include "ordolim.h"
 #include "mytypes.h"
+#include "scc.h"
 
-typedef struct GROUP 		group_t;
-typedef struct CONNECT 		connection_t;
-typedef struct NODE 		node_t;
-typedef struct PARTICIPANT 	participant_t;
-
-struct GROUP {
-	group_t *		next;
-	group_t *		prev;
-	group_t *		combined;
-	participant_t *	pstart;
-	participant_t *	plast;
-	connection_t *	cstart; // beat to
-	connection_t *	clast;
-	connection_t *	lstart; // lost to
-	connection_t *	llast;
-	player_t		id;
-	bool_t			isolated;
-};
-
-struct CONNECT {
-	connection_t *	next;
-	node_t	*		node;
-};
-
-struct NODE {
-	group_t *		group;
-};
-
-struct PARTICIPANT {
-	participant_t *	next;
-	const char	*	name;
-	player_t		id;
-};
-
-struct GROUP_BUFFER {
-	group_t	*		list; //buffer
-	group_t	*		tail;
-	group_t	*		prehead;
-	player_t		n;
-	player_t		max;
-};
-
-struct PARTICIPANT_BUFFER {
-	participant_t *	list; //buffer
-	player_t		n;
-	player_t		max;
-};
-
-struct CONNECT_BUFFER {
-	connection_t *	list; //buffer
-	gamesnum_t		n;
-	gamesnum_t		max;
-};
+/*
+|	Groups are the strongly connected components of the beat/lost
+|	digraph (see scc.h). Links between groups are the arcs of the
+|	condensation, which is acyclic.
+*/
 
-struct GROUPCELL {
-	group_t * 	group;
-	player_t 	count;
+struct GROUPLINKS {
+	player_t *		start;		// links of component c are to[start[c]..start[c+1])
+	player_t *		to;
 };
 
-typedef struct GROUPCELL groupcell_t;
-
 struct GROUPVAR {
-	player_t		nplayers;
-	player_t	*	groupbelong;
-	player_t *		getnewid;
-	groupcell_t	*	groupfinallist;
-	player_t		groupfinallist_n;
-	node_t	*		node;
-	player_t *		gchain;
-
-	group_t **		tofindgroup;
-
-	struct GROUP_BUFFER 		groupbuffer;
-	struct PARTICIPANT_BUFFER	participantbuffer;
-	struct CONNECT_BUFFER		connectionbuffer;
-
+	player_t			nplayers;
+	const char **		name;
+	struct SCC			scc;				// scc.comp[] is the component of each player
+	player_t			groupfinallist_n;	// number of groups
+	player_t *			groupfinallist;		// components in output order
+	player_t *			getnewid;			// component -> number used in the output
+	player_t *			mstart;				// members of component c are member[mstart[c]..mstart[c+1])
+	player_t *			member;				// sorted by name within each component
+	struct GROUPLINKS	beat;				// in topological order
+	struct GROUPLINKS	lost;				// in topological order
 };
 
 typedef struct GROUPVAR group_var_t;
@@ -0,0 +1,442 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "incconn.h"
+#include "plyrs.h"
+#include "scc.h"
+#include "mymem.h"
+
+#define ARCLIST_MIN 4
+
+static bool_t only_wins   (const struct ENC *e) {return e->W  > 0 && e->D == 0 && e->L == 0;}
+static bool_t only_losses (const struct ENC *e) {return e->W == 0 && e->D == 0 && e->L  > 0;}
+
+bool_t
+incconn_init (struct INCCONN *c, player_t n_players)
+{
+	size_t n = (size_t)n_players + 1;
+	player_t i;
+
+	c->n 		 = n_players;
+	c->n_present = 0;
+	c->n_comp	 = 0;
+	c->epoch	 = 0;
+	c->present	 = memnew (sizeof(bool_t) * n);
+	c->parent	 = memnew (sizeof(player_t) * n);
+	c->size		 = memnew (sizeof(player_t) * n);
+	c->out		 = memnew (sizeof(struct ARCLIST) * n);
+	c->obt		 = memnew (sizeof(double) * n);
+	c->pla		 = memnew (sizeof(gamesnum_t) * n);
+	c->seen		 = memnew (sizeof(long) * n);
+	c->reach	 = memnew (sizeof(bool_t) * n);
+	c->iter		 = memnew (sizeof(player_t) * n);
+	c->stack	 = memnew (sizeof(player_t) * n);
+	c->merge	 = memnew (sizeof(player_t) * n);
+
+	if (NULL == c->present || NULL == c->parent || NULL == c->size || NULL == c->out
+	 || NULL == c->obt 	   || NULL == c->pla 	|| NULL == c->seen || NULL == c->reach
+	 || NULL == c->iter    || NULL == c->stack  || NULL == c->merge) {
+		if (c->out) {memrel (c->out); c->out = NULL;}
+		incconn_done (c);
+		return FALSE;
+	}
+
+	for (i = 0; i < n_players; i++) {
+		c->present[i] = FALSE;
+		c->parent[i]  = i;
+		c->size[i]	  = 1;
+		c->out[i].to  = NULL;
+		c->out[i].n	  = 0;
+		c->out[i].max = 0;
+		c->obt[i]	  = 0.0;
+		c->pla[i]	  = 0;
+		c->seen[i]	  = 0;
+	}
+	return TRUE;
+}
+
+void
+incconn_done (struct INCCONN *c)
+{
+	player_t i;
+
+	if (c->out) {
+		for (i = 0; i < c->n; i++) {
+			if (c->out[i].to) memrel (c->out[i].to);
+		}
+		memrel (c->out);
+	}
+	if (c->present) memrel (c->present);
+	if (c->parent)	memrel (c->parent);
+	if (c->size)	memrel (c->size);
+	if (c->obt)		memrel (c->obt);
+	if (c->pla)		memrel (c->pla);
+	if (c->seen)	memrel (c->seen);
+	if (c->reach)	memrel (c->reach);
+	if (c->iter)	memrel (c->iter);
+	if (c->stack)	memrel (c->stack);
+	if (c->merge)	memrel (c->merge);
+
+	c->out = NULL;
+	c->present = NULL;
+	c->parent = NULL;
+	c->size = NULL;
+	c->obt = NULL;
+	c->pla = NULL;
+	c->seen = NULL;
+	c->reach = NULL;
+	c->iter = NULL;
+	c->stack = NULL;
+	c->merge = NULL;
+	c->n = 0;
+	c->n_present = 0;
+	c->n_comp = 0;
+}
+
+// room for players added to the database, they start alone and absent
+bool_t
+incconn_grow (struct INCCONN *c, player_t n_players)
+{
+	struct INCCONN g;
+	size_t n = (size_t)c->n;
+
+	if (n_players <= c->n) return TRUE;
+	if (!incconn_init (&g, n_players)) return FALSE;
+
+	memcpy (g.present, c->present, sizeof(bool_t) * n);
+	memcpy (g.parent,  c->parent,  sizeof(player_t) * n);
+	memcpy (g.size,    c->size,    sizeof(player_t) * n);
+	memcpy (g.out,     c->out,     sizeof(struct ARCLIST) * n);
+	memcpy (g.obt,     c->obt,     sizeof(double) * n);
+	memcpy (g.pla,     c->pla,     sizeof(gamesnum_t) * n);
+	memcpy (g.seen,    c->seen,    sizeof(long) * n);
+	g.n_present = c->n_present;
+	g.n_comp	= c->n_comp;
+	g.epoch		= c->epoch;
+
+	memrel (c->out); // arc lists moved to g
+	c->out = NULL;
+	incconn_done (c);
+	*c = g;
+	return TRUE;
+}
+
+static player_t
+find (struct INCCONN *c, player_t x)
+{
+	player_t *parent = c->parent;
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]]; // path halving
+		x = parent[x];
+	}
+	return x;
+}
+
+// removes stale and repeated entries of the list of root r
+static void
+arclist_compact (struct INCCONN *c, player_t r)
+{
+	struct ARCLIST *l = &c->out[r];
+	player_t i, k, y;
+
+	c->epoch++;
+	for (i = 0, k = 0; i < l->n; i++) {
+		y = find (c, l->to[i]);
+		if (y != r && c->seen[y] != c->epoch) {
+			c->seen[y] = c->epoch;
+			l->to[k++] = y;
+		}
+	}
+	l->n = k;
+}
+
+static void
+arclist_push (struct INCCONN *c, player_t r, player_t y)
+{
+	struct ARCLIST *l = &c->out[r];
+	player_t *p;
+
+	if (l->n == l->max) {
+		arclist_compact (c, r);
+	}
+	if (l->n == l->max) {
+		player_t max = l->max < ARCLIST_MIN? ARCLIST_MIN: 2 * l->max;
+		if (NULL == (p = memnew (sizeof(player_t) * (size_t)max))) {
+			fprintf(stderr, "Not enough memory\n");
+			exit(EXIT_FAILURE);
+		}
+		if (l->to) {
+			memcpy (p, l->to, sizeof(player_t) * (size_t)l->n);
+			memrel (l->to);
+		}
+		l->to  = p;
+		l->max = max;
+	}
+	l->to[l->n++] = y;
+}
+
+/*
+|	Collects in c->merge the components that are reachable from b and
+|	reach a (a included). The condensation is acyclic, so a depth first
+|	search that does not go beyond a is enough. Returns how many.
+*/
+static player_t
+collect_cycle (struct INCCONN *c, player_t b, player_t a)
+{
+	long 		epoch = ++c->epoch;
+	long *		seen  = c->seen;
+	bool_t *	reach = c->reach;
+	player_t *	iter  = c->iter;
+	player_t *	stack = c->stack;
+	player_t	sp = 0, k = 0;
+	player_t	x, y;
+
+	seen[b] = epoch; reach[b] = FALSE; iter[b] = 0;
+	stack[sp++] = b;
+
+	while (sp > 0) {
+		x = stack[sp-1];
+		if (x != a && iter[x] < c->out[x].n) {
+			y = find (c, c->out[x].to[iter[x]++]);
+			if (y == x) continue;
+			if (seen[y] != epoch) {
+				seen[y] = epoch; reach[y] = FALSE; iter[y] = 0;
+				stack[sp++] = y;
+			} else if (reach[y]) {
+				reach[x] = TRUE;
+			}
+		} else {
+			sp--;
+			if (x == a) reach[x] = TRUE;
+			if (reach[x]) {
+				c->merge[k++] = x;
+				if (sp > 0) reach[stack[sp-1]] = TRUE;
+			}
+		}
+	}
+	return k;
+}
+
+static void
+merge_components (struct INCCONN *c, player_t k)
+{
+	player_t i, j, r, x, y, total;
+	player_t *p, *q;
+
+	// biggest one becomes the root
+	for (i = 1, r = c->merge[0]; i < k; i++) {
+		if (c->size[c->merge[i]] > c->size[r]) r = c->merge[i];
+	}
+
+	for (i = 0, total = 0; i < k; i++) {
+		x = c->merge[i];
+		total += c->out[x].n;
+		if (x != r) {
+			c->parent[x] = r;
+			c->size[r] += c->size[x];
+		}
+	}
+
+	if (NULL == (p = memnew (sizeof(player_t) * (size_t)(total + ARCLIST_MIN)))) {
+		fprintf(stderr, "Not enough memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	c->epoch++;
+	for (i = 0, j = 0; i < k; i++) {
+		x = c->merge[i];
+		for (q = c->out[x].to; q < c->out[x].to + c->out[x].n; q++) {
+			y = find (c, *q);
+			if (y != r && c->seen[y] != c->epoch) {
+				c->seen[y] = c->epoch;
+				p[j++] = y;
+			}
+		}
+		if (c->out[x].to) memrel (c->out[x].to);
+		c->out[x].to  = NULL;
+		c->out[x].n	  = 0;
+		c->out[x].max = 0;
+	}
+
+	c->out[r].to  = p;
+	c->out[r].n	  = j;
+	c->out[r].max = total + ARCLIST_MIN;
+
+	c->n_comp -= k - 1;
+}
+
+// arc u -> v, u only beat v
+static void
+arc_add (struct INCCONN *c, player_t u, player_t v)
+{
+	player_t a = find (c, u);
+	player_t b = find (c, v);
+	player_t k;
+
+	if (a == b) return;
+
+	k = collect_cycle (c, b, a);
+	if (k == 0) {
+		arclist_push (c, a, b);
+	} else {
+		merge_components (c, k);
+	}
+}
+
+static void
+mark_present (struct INCCONN *c, player_t x)
+{
+	if (!c->present[x]) {
+		c->present[x] = TRUE;
+		c->n_present++;
+		c->n_comp++;
+	}
+}
+
+// e may also be a part of an encounter already added (new games only)
+void
+incconn_add (struct INCCONN *c, const struct ENC *e)
+{
+	player_t w = e->wh;
+	player_t b = e->bl;
+
+	assert (w >= 0 && w < c->n && b >= 0 && b < c->n);
+
+	if (e->played == 0) return;
+
+	c->obt[w] += e->wscore;
+	c->obt[b] += (double)e->played - e->wscore;
+	c->pla[w] += e->played;
+	c->pla[b] += e->played;
+
+	mark_present (c, w);
+	mark_present (c, b);
+
+	if (only_wins(e)) {
+		arc_add (c, w, b);
+	} else if (only_losses(e)) {
+		arc_add (c, b, w);
+	} else {
+		arc_add (c, w, b);
+		arc_add (c, b, w);
+	}
+}
+
+/*
+|	Loads a structure that has no encounters yet with one pass of Tarjan
+|	(see scc.h). Adding them one by one may search the condensation for
+|	each arc, which is slow for pools that are far from connected.
+*/
+static bool_t
+seed (struct INCCONN *c, const struct ENCOUNTERS *ee)
+{
+	struct SCC 	s;
+	player_t *	root = c->merge; // of each component, free until arcs are added
+	player_t	i, k, r, u, v;
+	gamesnum_t	e;
+
+	if (!scc_init (&s, c->n, ee->n)) return FALSE;
+
+	for (e = 0; e < ee->n; e++) {
+		const struct ENC *x = &ee->enc[e];
+		if (x->played == 0) continue;
+		c->obt[x->wh] += x->wscore;
+		c->obt[x->bl] += (double)x->played - x->wscore;
+		c->pla[x->wh] += x->played;
+		c->pla[x->bl] += x->played;
+		mark_present (c, x->wh);
+		mark_present (c, x->bl);
+	}
+
+	scc_load (&s, ee);
+	k = scc_find_present (&s, c->present);
+
+	for (i = 0; i < k; i++) root[i] = SCC_NONE;
+	for (i = 0; i < c->n; i++) {
+		if (!c->present[i]) continue;
+		r = root[s.comp[i]];
+		if (r == SCC_NONE) {
+			root[s.comp[i]] = i;
+		} else {
+			c->parent[i] = r;
+			c->size[r]++;
+		}
+	}
+	c->n_comp = k;
+
+	// arcs of the condensation
+	for (e = 0; e < ee->n; e++) {
+		const struct ENC *x = &ee->enc[e];
+		if (x->played == 0) continue;
+		u = find (c, x->wh);
+		v = find (c, x->bl);
+		if (u == v) continue;
+		if (only_wins(x)) 	arclist_push (c, u, v);
+		else 				arclist_push (c, v, u); // only losses, any other is within one
+	}
+
+	scc_done (&s);
+	return TRUE;
+}
+
+void
+incconn_load (struct INCCONN *c, const struct ENCOUNTERS *ee)
+{
+	gamesnum_t e;
+
+	if (c->n_present == 0 && seed (c, ee))
+		return;
+
+	for (e = 0; e < ee->n; e++) {
+		incconn_add (c, &ee->enc[e]);
+	}
+}
+
+player_t
+incconn_groups (const struct INCCONN *c)
+{
+	return c->n_comp;
+}
+
+bool_t
+incconn_connected (const struct INCCONN *c)
+{
+	return c->n_present > 0 && c->n_comp == 1;
+}
+
+bool_t
+incconn_same_group (struct INCCONN *c, player_t i, player_t j)
+{
+	return find (c, i) == find (c, j);
+}
+
+// same as players_set_super() on all the encounters added so far
+player_t
+incconn_set_super (bool_t quiet, const struct INCCONN *c, struct PLAYERS *pl)
+{
+	assert (pl->n == c->n);
+	return players_set_perf (quiet, c->obt, c->pla, pl);
+}
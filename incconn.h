@@ -0,0 +1,76 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if !defined(H_INCCONN)
+#define H_INCCONN
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "boolean.h"
+#include "mytypes.h"
+
+/*
+|	Connectivity of the beat/lost digraph (see scc.h) maintained while
+|	encounters are added, so a database that grows does not need a
+|	rebuild. Players of the same strongly connected component are kept
+|	in a union-find; encounters with draws or mixed results join their
+|	players directly. An arc between two components that closes a cycle
+|	collapses every component on that cycle into one. The first
+|	encounters loaded are taken in one pass of Tarjan instead.
+|	Scores and games played are kept to classify super players.
+*/
+
+struct ARCLIST {
+	player_t *		to;		// roots when added, may be stale later (use find)
+	player_t		n;
+	player_t		max;
+};
+
+struct INCCONN {
+	player_t			n;
+	player_t			n_present;
+	player_t			n_comp;		// components among players present in games
+	bool_t *			present;
+	player_t *			parent;
+	player_t *			size;
+	struct ARCLIST *	out;		// arcs of the condensation, kept at the root
+	double *			obt;		// score of each player
+	gamesnum_t *		pla;		// games of each player
+	// work
+	long				epoch;
+	long *				seen;
+	bool_t *			reach;
+	player_t *			iter;
+	player_t *			stack;
+	player_t *			merge;
+};
+
+extern bool_t		incconn_init (struct INCCONN *c, player_t n_players);
+extern void			incconn_done (struct INCCONN *c);
+extern bool_t		incconn_grow (struct INCCONN *c, player_t n_players);
+extern void			incconn_add (struct INCCONN *c, const struct ENC *e);
+extern void			incconn_load (struct INCCONN *c, const struct ENCOUNTERS *ee);
+extern player_t		incconn_groups (const struct INCCONN *c);
+extern bool_t		incconn_connected (const struct INCCONN *c);
+extern bool_t		incconn_same_group (struct INCCONN *c, player_t i, player_t j);
+extern player_t		incconn_set_super (bool_t quiet, const struct INCCONN *c, struct PLAYERS *pl);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
@@ -20,6 +20,7 @@
 
 #include <stddef.h>
 #include <assert.h>
+#include <string.h>
 
 #include "inidone.h"
 #include "mymem.h"
@@ -116,6 +117,78 @@ ratings_replicate (const struct RATINGS *src, struct RATINGS *tgt)
 	return ok;
 }
 
+/*
+|	Replicas for threads that only need their own working arrays.
+|	The sorted index and the *_results arrays are pointed to the source
+|	and must not be modified through the replica.
+*/
+
+bool_t
+ratings_replicate_shared (const struct RATINGS *src, struct RATINGS *tgt)
+{
+	enum {MAXU=5};
+	void	 	*pu[MAXU];
+	bool_t		ok;
+	int i,u;
+	size_t szu[MAXU] = {
+		sizeof(gamesnum_t),
+		sizeof(double),sizeof(double),
+		sizeof(double),sizeof(double)
+	};
+	player_t j, n = src->size;
+	assert (n > 0);
+
+	for (ok = TRUE, u = 0, i = 0; i < MAXU && ok; i++) {
+		if (NULL != (pu[i] = memnew (szu[i] * (size_t)n))) { 
+			u++;
+		} else {
+			while (u-->0) memrel(pu[u]);
+			ok = FALSE;
+		}
+	}
+	if (ok) {
+		tgt->size				= n;
+
+		tgt->sorted 			= src->sorted;
+		tgt->playedby 			= pu[0];
+		tgt->playedby_results 	= src->playedby_results;
+
+		tgt->obtained 			= pu[1];
+ 		tgt->ratingof 			= pu[2];
+ 		tgt->ratingbk 			= pu[3];
+
+ 		tgt->changing 			= pu[4];
+		tgt->ratingof_results 	= src->ratingof_results;
+		tgt->obtained_results 	= src->obtained_results;
+
+		for (j = 0; j < n; j++) {
+			tgt->playedby[j]	= src->playedby[j];
+			tgt->obtained[j]	= src->obtained[j];
+			tgt->ratingof[j]	= src->ratingof[j];
+			tgt->ratingbk[j]	= src->ratingbk[j];
+			tgt->changing[j]	= src->changing[j];
+		}
+	}
+	return ok;
+}
+
+void 
+ratings_done_shared (struct RATINGS *r)
+{
+	r->size	= 0;
+
+	memrel(r->playedby);
+	memrel(r->obtained);
+ 	memrel(r->ratingof);
+ 	memrel(r->ratingbk);
+ 	memrel(r->changing);
+
+	r->sorted			= NULL;
+	r->playedby_results	= NULL;
+	r->ratingof_results	= NULL;
+	r->obtained_results	= NULL;
+} 
+
 //
 
 bool_t 
@@ -139,6 +212,28 @@ games_init (gamesnum_t n, struct GAMES *g)
 }
 
 
+// keeps the games, room for n at least. It doubles the size, so that
+// games added one update at a time are copied O(1) times on average.
+bool_t
+games_grow (gamesnum_t n, struct GAMES *g)
+{
+	struct gamei *p;
+	gamesnum_t size = g->size;
+
+	if (n <= size) return TRUE;
+
+	size = n > 2 * size? n: 2 * size;
+	if (NULL == (p = memnew (sizeof(struct gamei) * (size_t)size)))
+		return FALSE;
+	if (g->n > 0) 
+		memcpy (p, g->ga, sizeof(struct gamei) * (size_t)g->n);
+	if (g->ga != NULL) 
+		memrel (g->ga);
+	g->ga	= p;
+	g->size	= size;
+	return TRUE;
+}
+
 void 
 games_done (struct GAMES *g)
 {
@@ -225,12 +320,14 @@ players_done (struct PLAYERS *x)
 {
 	assert(x->name);
 	assert(x->flagged);
+	assert(x->present_in_games);
 	assert(x->prefed);
 	assert(x->priored);
 	assert(x->performance_type);
 
 	memrel(x->name);
 	memrel(x->flagged);
+	memrel(x->present_in_games);
 	memrel(x->prefed);
 	memrel(x->priored);
 	memrel(x->performance_type);
@@ -238,6 +335,7 @@ players_done (struct PLAYERS *x)
 	x->size	= 0;
 	x->name = NULL;
 	x->flagged = NULL;
+	x->present_in_games = NULL;
 	x->prefed = NULL;
 	x->priored = NULL;
 	x->performance_type = NULL;
@@ -256,6 +354,71 @@ players_replicate (const struct PLAYERS *src, struct PLAYERS *tgt)
 	return ok;
 }
 
+// names, presence and prefed are pointed to the source, not copied
+bool_t
+players_replicate_shared (const struct PLAYERS *src, struct PLAYERS *tgt)
+{
+	enum VARIAB {NV = 3};
+	bool_t failed;
+	size_t sz[NV];
+	void * pv[NV];
+	player_t k;
+	int i, j;
+
+	assert (src->size > 0);
+
+	sz[0] = sizeof(bool_t);
+	sz[1] = sizeof(bool_t);
+	sz[2] = sizeof(int);
+
+	for (failed = FALSE, i = 0; !failed && i < NV; i++) {
+		if (NULL == (pv[i] = memnew (sz[i] * (size_t)src->size))) {
+			for (j = 0; j < i; j++) memrel(pv[j]);
+			failed = TRUE;
+		}
+	}
+	if (failed) return FALSE;
+
+	tgt->n					= src->n;
+	tgt->size				= src->size;
+	tgt->anchored_n			= src->anchored_n;
+	tgt->perf_set			= src->perf_set;
+	tgt->name 				= src->name;
+	tgt->flagged			= pv[0];
+	tgt->present_in_games	= src->present_in_games;
+	tgt->prefed				= src->prefed;
+	tgt->priored			= pv[1]; 
+	tgt->performance_type 	= pv[2]; 
+
+	for (k = 0; k < src->n; k++) {
+		tgt->flagged[k] 			= src->flagged[k];
+		tgt->priored[k] 			= src->priored[k];
+		tgt->performance_type[k]	= src->performance_type[k]; 
+	}
+
+	return TRUE;
+}
+
+void 
+players_done_shared (struct PLAYERS *x)
+{
+	assert(x->flagged);
+	assert(x->priored);
+	assert(x->performance_type);
+
+	memrel(x->flagged);
+	memrel(x->priored);
+	memrel(x->performance_type);
+	x->n = 0;
+	x->size	= 0;
+	x->name = NULL;
+	x->flagged = NULL;
+	x->present_in_games = NULL;
+	x->prefed = NULL;
+	x->priored = NULL;
+	x->performance_type = NULL;
+} 
+
 //
 
 bool_t
@@ -324,7 +487,7 @@ priorlist_done 	(struct prior **pPP)
 
 bool_t
 priorlist_replicate ( player_t nplayers
-					, struct prior *PP
+					, const struct prior *PP
 					, struct prior **pQQ
 					)
 {
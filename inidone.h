@@ -28,14 +28,19 @@
 extern bool_t 	ratings_init (player_t n, struct RATINGS *r); 
 extern void 	ratings_done (struct RATINGS *r);
 extern bool_t	ratings_replicate (const struct RATINGS *src, struct RATINGS *tgt);
+extern bool_t	ratings_replicate_shared (const struct RATINGS *src, struct RATINGS *tgt);
+extern void 	ratings_done_shared (struct RATINGS *r);
 
 extern bool_t 	games_init (gamesnum_t n, struct GAMES *g);
 extern void 	games_done (struct GAMES *g);
+extern bool_t	games_grow (gamesnum_t n, struct GAMES *g);
 extern bool_t	games_replicate (const struct GAMES *src, struct GAMES *tgt);
 
 extern bool_t 	players_init (player_t n, struct PLAYERS *x);
 extern void 	players_done (struct PLAYERS *x);
 extern bool_t 	players_replicate (const struct PLAYERS *src, struct PLAYERS *tgt);
+extern bool_t 	players_replicate_shared (const struct PLAYERS *src, struct PLAYERS *tgt);
+extern void 	players_done_shared (struct PLAYERS *x);
 
 extern bool_t 	supporting_auxmem_init 	
 						( player_t nplayers
@@ -53,7 +58,7 @@ extern struct prior *priorlist_init 	(player_t nplayers);
 extern void 	priorlist_done 	(struct prior **pPP);
 
 extern bool_t	priorlist_replicate ( player_t nplayers
-									, struct prior *PP
+									, const struct prior *PP
 									, struct prior **pQQ);
 
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
@@ -0,0 +1,674 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+|	kernbench: timings of the innermost kernels of ordo. Each kernel is
+|	first checked against a plain reference implementation, written
+|	differently on purpose, and then run repeatedly for a minimum time.
+|	Rewrites of a kernel can be validated for speed and accuracy here.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "myopt.h"
+#include "boolean.h"
+#include "mytypes.h"
+#include "datatype.h"
+#include "mymem.h"
+#include "mytimer.h"
+#include "randfast.h"
+#include "xpect.h"
+#include "encount.h"
+#include "ratingb.h"
+#include "summations.h"
+#include "namehash.h"
+#include "gauss.h"
+#include "radix.h"
+
+#define XN 4096 // evaluations per call of the scalar kernels
+
+struct BENCH {
+	double			min_time;	// seconds per kernel
+	struct ranctx	rng;
+	bool_t			failed;
+};
+
+typedef void (*kernel_fn) (void *arg);
+
+static double Sink = 0; // results go here, so they are not optimized away
+
+static double
+uniform (struct ranctx *r, double lo, double hi)
+{
+	return lo + (hi - lo) * ((double)ranctx_val(r) / 4294967296.0);
+}
+
+static double
+relerr (double x, double ref)
+{
+	double d = fabs(x - ref);
+	return fabs(ref) > 1? d / fabs(ref): d;
+}
+
+// average nanoseconds of one call, called repeatedly for at least min_time
+static double
+measure (const struct BENCH *b, kernel_fn fn, void *arg)
+{
+	long reps = 1, i;
+	double t, elapsed;
+
+	fn (arg); // warm up
+	for (;;) {
+		t = wallclock();
+		for (i = 0; i < reps; i++) fn (arg);
+		elapsed = wallclock() - t;
+		if (elapsed >= b->min_time) break;
+		reps = elapsed > 0.001? (long)((double)reps * 1.2 * b->min_time / elapsed) + 1: reps * 10;
+	}
+	return 1E9 * elapsed / (double)reps;
+}
+
+static void
+report (struct BENCH *b, const char *name, long size, double ns_call, double ops_call, double err, double tol)
+{
+	bool_t ok = err <= tol;
+	double ns = ns_call / ops_call;
+	if (!ok) b->failed = TRUE;
+	printf ("%-32s %9ld %10.2f %10.2f %11.2e  %s\n", name, size, ns, 1E3 / ns, err, ok? "ok": "FAILED");
+}
+
+/*------------------------------------------------------------------
+	xpect, draw_rate_fperf, get_pWDL, gauss_integral
+------------------------------------------------------------------*/
+
+struct SCALAR {
+	double	x[XN];
+	double	y[XN];
+	double	d0;
+	double	beta;
+};
+
+static double
+xpect_ref (double delta, double beta)
+{
+	return 0.5 * (1.0 + tanh (0.5 * delta * beta));
+}
+
+// root in [0,1] of c + 2x + a*x*x, by bisection
+static double
+draw_rate_fperf_ref (double p, double d0)
+{
+	double fi = (1-d0)/(2*d0);
+	double a = 4*fi*fi-1;
+	double c = 4*(p*p-p);
+	double lo = 0, hi = 1;
+	int i;
+	for (i = 0; i < 100; i++) {
+		double m = 0.5 * (lo + hi);
+		if (c + 2*m + a*m*m < 0) lo = m; else hi = m;
+	}
+	return 0.5 * (lo + hi);
+}
+
+static void
+k_xpect (void *p)
+{
+	struct SCALAR *s = p;
+	double acc = 0;
+	int i;
+	for (i = 0; i < XN; i++) acc += xpect (s->x[i], 0, s->beta);
+	Sink += acc;
+}
+
+static void
+k_draw_rate_fperf (void *p)
+{
+	struct SCALAR *s = p;
+	double acc = 0;
+	int i;
+	for (i = 0; i < XN; i++) acc += draw_rate_fperf (s->y[i], s->d0);
+	Sink += acc;
+}
+
+static void
+k_get_pWDL (void *p)
+{
+	struct SCALAR *s = p;
+	double acc = 0, pw, pd, pl;
+	int i;
+	for (i = 0; i < XN; i++) {
+		get_pWDL (s->x[i], &pw, &pd, &pl, s->d0, s->beta);
+		acc += pd;
+	}
+	Sink += acc;
+}
+
+static void
+k_gauss_integral (void *p)
+{
+	struct SCALAR *s = p;
+	double acc = 0;
+	int i;
+	for (i = 0; i < XN; i++) acc += gauss_integral (s->x[i]);
+	Sink += acc;
+}
+
+static void
+bench_scalar (struct BENCH *b, double beta)
+{
+	static const double D0[] = {0.2, 0.5, 0.8}; // closed form, Newton, closed form
+	static const char *D0_name[] = {"d0=0.2", "d0=0.5 (Newton)", "d0=0.8"};
+	struct SCALAR *s = memnew (sizeof(struct SCALAR));
+	double err, pw, pd, pl;
+	char name[64];
+	int i, k;
+
+	if (s == NULL) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+	s->beta = beta;
+
+	for (i = 0; i < XN; i++) {
+		s->x[i] = uniform (&b->rng, -600, 600);
+		s->y[i] = uniform (&b->rng, 0.001, 0.999);
+	}
+
+	for (err = 0, i = 0; i < XN; i++)
+		err = fmax (err, relerr (xpect (s->x[i], 0, beta), xpect_ref (s->x[i], beta)));
+	report (b, "xpect", XN, measure (b, k_xpect, s), XN, err, 1E-12);
+
+	for (k = 0; k < 3; k++) {
+		s->d0 = D0[k];
+		for (err = 0, i = 0; i < XN; i++)
+			err = fmax (err, relerr (draw_rate_fperf (s->y[i], s->d0), draw_rate_fperf_ref (s->y[i], s->d0)));
+		sprintf (name, "draw_rate_fperf %s", D0_name[k]);
+		report (b, name, XN, measure (b, k_draw_rate_fperf, s), XN, err, 1E-6);
+	}
+
+	for (k = 0; k < 3; k++) {
+		s->d0 = D0[k];
+		for (err = 0, i = 0; i < XN; i++) {
+			double perf = xpect_ref (s->x[i], beta);
+			get_pWDL (s->x[i], &pw, &pd, &pl, s->d0, beta);
+			err = fmax (err, fabs (pw + pd + pl - 1));
+			err = fmax (err, fabs (pw + 0.5 * pd - perf));
+			err = fmax (err, fabs (pd - draw_rate_fperf_ref (perf, s->d0)));
+		}
+		sprintf (name, "get_pWDL %s", D0_name[k]);
+		report (b, name, XN, measure (b, k_get_pWDL, s), XN, err, 1E-6);
+	}
+
+	for (i = 0; i < XN; i++)
+		s->x[i] = uniform (&b->rng, -7, 7);
+	for (err = 0, i = 0; i < XN; i++)
+		err = fmax (err, fabs (gauss_integral (s->x[i]) - 0.5 * erfc (-s->x[i] / sqrt(2.0))));
+	report (b, "gauss_integral", XN, measure (b, k_gauss_integral, s), XN, err, 1E-7);
+
+	memrel (s);
+}
+
+/*------------------------------------------------------------------
+	calc_expected, probarray_build
+------------------------------------------------------------------*/
+
+#define LINE_U32 16 // uint32_t in a 64-byte line
+
+// the encounters as 32-bit columns, each one aligned to a line and padded
+// to whole lines, 20 bytes per encounter instead of sizeof(struct ENC).
+// played is W+D+L. Only here, to measure the layout against struct ENC
+struct ENCCOLS {
+	uint32_t *	wh;
+	uint32_t *	bl;
+	uint32_t *	W;
+	uint32_t *	D;
+	uint32_t *	L;
+	void *		mem;
+};
+
+static void
+enccols_build (const struct ENC *enc, gamesnum_t n_enc, struct ENCCOLS *c)
+{
+	size_t stride = ((size_t)n_enc + LINE_U32 - 1) / LINE_U32 * LINE_U32;
+	uint32_t *p;
+	gamesnum_t i;
+
+	if (NULL == (c->mem = memnew (sizeof(uint32_t) * (5 * stride + LINE_U32)))) {
+		fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);
+	}
+	p = (uint32_t *)(((uintptr_t)c->mem + 63) & ~(uintptr_t)63);
+	c->wh	= p;
+	c->bl	= p + stride;
+	c->W	= p + 2 * stride;
+	c->D	= p + 3 * stride;
+	c->L	= p + 4 * stride;
+	for (i = 0; i < n_enc; i++) {
+		c->wh[i]	= (uint32_t)enc[i].wh;
+		c->bl[i]	= (uint32_t)enc[i].bl;
+		c->W[i]		= (uint32_t)enc[i].W;
+		c->D[i]		= (uint32_t)enc[i].D;
+		c->L[i]		= (uint32_t)enc[i].L;
+	}
+}
+
+// calc_expected over struct ENCCOLS
+static void
+calc_expected_cols	( const struct ENCCOLS *c
+					, gamesnum_t n_enc
+					, double white_advantage
+					, player_t n_players
+					, const double *ratingof
+					, double *expected
+					, double beta)
+{
+	gamesnum_t i;
+	player_t j;
+
+	for (j = 0; j < n_players; j++)
+		expected[j] = 0.0;
+	for (i = 0; i < n_enc; i++) {
+		double played = (double)(c->W[i] + c->D[i] + c->L[i]);
+		double wperf = played * xpect (ratingof[c->wh[i]] + white_advantage, ratingof[c->bl[i]], beta);
+		expected [c->bl[i]] += played - wperf;
+		expected [c->wh[i]] += wperf;
+	}
+}
+
+struct ENCBENCH {
+	struct ENC *	enc;
+	struct ENCCOLS	cols;
+	gamesnum_t		n_enc;
+	player_t		n_players;
+	double *		rating;
+	double *		out;
+	double *		ref;
+	double			beta;
+	double			wadv;
+	double			d0;
+};
+
+static void
+k_calc_expected (void *p)
+{
+	struct ENCBENCH *e = p;
+	calc_expected (e->enc, e->n_enc, e->wadv, e->n_players, e->rating, e->out, e->beta);
+	Sink += e->out[0];
+}
+
+static void
+k_calc_expected_cols (void *p)
+{
+	struct ENCBENCH *e = p;
+	calc_expected_cols (&e->cols, e->n_enc, e->wadv, e->n_players, e->rating, e->out, e->beta);
+	Sink += e->out[0];
+}
+
+static void
+k_probarray_build (void *p)
+{
+	struct ENCBENCH *e = p;
+	probarray_build (e->n_enc, e->enc, 10.0, e->d0, e->beta, e->rating, e->wadv, e->out);
+	Sink += e->out[0];
+}
+
+static double
+loglik_ref (const struct ENC *x, double delta, double d0, double beta)
+{
+	double perf = xpect_ref (delta, beta);
+	double pd = draw_rate_fperf_ref (perf, d0);
+	double pw = perf - 0.5 * pd;
+	double pl = 1 - pw - pd;
+	return (double)x->W * log(pw) + (double)x->D * log(pd) + (double)x->L * log(pl);
+}
+
+static void
+bench_encounters (struct BENCH *b, double beta, player_t n_players, gamesnum_t n_enc)
+{
+	struct ENCBENCH e;
+	double err;
+	player_t j;
+	gamesnum_t i;
+
+	e.n_players = n_players;
+	e.n_enc		= n_enc;
+	e.beta		= beta;
+	e.wadv		= 30;
+	e.d0		= 0.4;
+	e.enc		= memnew (sizeof(struct ENC) * (size_t)n_enc);
+	e.rating	= memnew (sizeof(double) * (size_t)n_players);
+	e.out		= memnew (sizeof(double) * (size_t)n_players * 4);
+	e.ref		= memnew (sizeof(double) * (size_t)n_players * 4);
+
+	if (!e.enc || !e.rating || !e.out || !e.ref) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+
+	for (j = 0; j < n_players; j++)
+		e.rating[j] = rand_gauss_r (&b->rng, 0, 200);
+	for (i = 0; i < n_enc; i++) {
+		struct ENC *x = &e.enc[i];
+		x->wh = (player_t)(ranctx_val(&b->rng) % (uint32_t)n_players);
+		do x->bl = (player_t)(ranctx_val(&b->rng) % (uint32_t)n_players); while (x->bl == x->wh);
+		x->W = 1 + (gamesnum_t)(ranctx_val(&b->rng) % 4);
+		x->D = 1 + (gamesnum_t)(ranctx_val(&b->rng) % 4);
+		x->L = 1 + (gamesnum_t)(ranctx_val(&b->rng) % 4);
+		x->played = x->W + x->D + x->L;
+		x->wscore = (double)x->W + 0.5 * (double)x->D;
+	}
+
+	// calc_expected
+	for (j = 0; j < n_players; j++) e.ref[j] = 0;
+	for (i = 0; i < n_enc; i++) {
+		const struct ENC *x = &e.enc[i];
+		double pw = (double)x->played * xpect_ref (e.rating[x->wh] + e.wadv - e.rating[x->bl], beta);
+		e.ref[x->wh] += pw;
+		e.ref[x->bl] += (double)x->played - pw;
+	}
+	calc_expected (e.enc, n_enc, e.wadv, n_players, e.rating, e.out, beta);
+	for (err = 0, j = 0; j < n_players; j++)
+		err = fmax (err, relerr (e.out[j], e.ref[j]));
+	report (b, "calc_expected", (long)n_enc, measure (b, k_calc_expected, &e), (double)n_enc, err, 1E-9);
+
+	// the same, over 32-bit columns
+	enccols_build (e.enc, n_enc, &e.cols);
+	calc_expected_cols (&e.cols, n_enc, e.wadv, n_players, e.rating, e.out, beta);
+	for (err = 0, j = 0; j < n_players; j++)
+		err = fmax (err, relerr (e.out[j], e.ref[j]));
+	report (b, "calc_expected (columns)", (long)n_enc, measure (b, k_calc_expected_cols, &e), (double)n_enc, err, 1E-9);
+	memrel (e.cols.mem);
+
+	// probarray_build
+	for (j = 0; j < 4 * n_players; j++) e.ref[j] = e.out[j] = 0;
+	for (i = 0; i < n_enc; i++) {
+		const struct ENC *x = &e.enc[i];
+		double delta = e.rating[x->wh] + e.wadv - e.rating[x->bl];
+		double p0 = loglik_ref (x, delta, e.d0, beta);
+		double pp = loglik_ref (x, delta + 10, e.d0, beta);
+		double pm = loglik_ref (x, delta - 10, e.d0, beta);
+		e.ref[4*x->wh+1] -= p0; e.ref[4*x->bl+1] -= p0;
+		e.ref[4*x->wh+2] -= pp; e.ref[4*x->bl+0] -= pp;
+		e.ref[4*x->wh+0] -= pm; e.ref[4*x->bl+2] -= pm;
+	}
+	probarray_build (n_enc, e.enc, 10.0, e.d0, beta, e.rating, e.wadv, e.out);
+	for (err = 0, j = 0; j < 4 * n_players; j++)
+		err = fmax (err, relerr (e.out[j], e.ref[j]));
+	report (b, "probarray_build", (long)n_enc, measure (b, k_probarray_build, &e), (double)n_enc, err, 1E-6);
+
+	memrel (e.ref);
+	memrel (e.out);
+	memrel (e.rating);
+	memrel (e.enc);
+}
+
+/*------------------------------------------------------------------
+	summations_update
+------------------------------------------------------------------*/
+
+struct SUMBENCH {
+	struct summations	sm;
+	player_t			n;
+	double *			rating;
+};
+
+static void
+k_summations_update (void *p)
+{
+	struct SUMBENCH *s = p;
+	summations_update (&s->sm, s->n, s->rating, 30, 0.4);
+}
+
+static void
+bench_summations (struct BENCH *b, player_t n)
+{
+	struct SUMBENCH s;
+	double err = 0, ns;
+	player_t i, j;
+	int k;
+
+	s.n = n;
+	summations_init (&s.sm);
+	if (NULL == (s.rating = memnew (sizeof(double) * (size_t)n)) || !summations_calloc (&s.sm, n)) {
+		fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < n; i++)
+		s.rating[i] = rand_gauss_r (&b->rng, 0, 200);
+
+	// after k updates with the same ratings, every sum is k times the term
+	for (k = 0; k < 3; k++)
+		summations_update (&s.sm, n, s.rating, 30, 0.4);
+	for (i = 0; i < n; i++) {
+		double r = s.rating[i];
+		err = fmax (err, relerr (s.sm.sum1[i], 3 * r));
+		err = fmax (err, relerr (s.sm.sum2[i], 3 * r*r));
+		err = fmax (err, relerr (s.sm.sum3[i], 3 * r*r*r));
+		err = fmax (err, relerr (s.sm.sum4[i], 3 * r*r*r*r));
+		for (j = 0; j < i; j++) {
+			const struct DEVIATION_ACC *d = &s.sm.relative[(i*i-i)/2+j];
+			double diff = r - s.rating[j];
+			err = fmax (err, relerr (d->sum1, 3 * diff));
+			err = fmax (err, relerr (d->sum2, 3 * diff*diff));
+		}
+	}
+
+	ns = measure (b, k_summations_update, &s);
+	report (b, "summations_update", (long)n, ns, (double)n * (double)(n - 1) / 2, err, 1E-12);
+
+	summations_done (&s.sm);
+	memrel (s.rating);
+}
+
+/*------------------------------------------------------------------
+	namehash and lookup
+------------------------------------------------------------------*/
+
+struct NAMEBENCH {
+	struct DATA *	d;
+	char **			name;
+	player_t		n;
+};
+
+static void
+k_name_lookup (void *p)
+{
+	struct NAMEBENCH *s = p;
+	player_t i, idx, acc = 0;
+	for (i = 0; i < s->n; i++) {
+		if (name_ispresent (s->d, s->name[i], namehash (s->name[i]), &idx)) acc += idx;
+	}
+	Sink += (double)acc;
+}
+
+static void
+bench_names (struct BENCH *b, player_t n)
+{
+	struct NAMEBENCH s;
+	size_t blocks = ((size_t)n + MAXNAMESxBLOCK - 1) / MAXNAMESxBLOCK;
+	player_t i, idx;
+	double err = 0;
+	size_t k;
+
+	s.n = n;
+	s.d = calloc (1, sizeof(struct DATA));
+	s.name = memnew (sizeof(char *) * (size_t)n);
+	if (!s.d || !s.name) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+
+	for (k = 0; k < blocks; k++) {
+		if (NULL == (s.d->nm[k] = calloc (1, sizeof(struct NAMEBLOCK)))) {
+			fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!name_storage_init (s.d)) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+	for (i = 0; i < n; i++) {
+		char buf[64];
+		sprintf (buf, "Engine %08x %ld", (unsigned)ranctx_val(&b->rng), (long)i);
+		if (NULL == (s.name[i] = memnew (strlen(buf) + 1))) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+		strcpy (s.name[i], buf);
+		s.d->nm[(size_t)i / MAXNAMESxBLOCK]->p[(size_t)i % MAXNAMESxBLOCK] = s.name[i];
+		if (!name_register (s.d, namehash (s.name[i]), i, i)) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+	}
+	s.d->n_players = n;
+
+	for (i = 0; i < n; i++) {
+		if (!name_ispresent (s.d, s.name[i], namehash (s.name[i]), &idx) || idx != i) err = 1;
+	}
+	report (b, "namehash+lookup", (long)n, measure (b, k_name_lookup, &s), (double)n, err, 0);
+
+	name_storage_done (s.d);
+	for (i = 0; i < n; i++) memrel (s.name[i]);
+	for (k = 0; k < blocks; k++) free (s.d->nm[k]);
+	memrel (s.name);
+	free (s.d);
+}
+
+/*------------------------------------------------------------------
+	sort of games by pair of players, qsort and radix_sort_pairs
+------------------------------------------------------------------*/
+
+struct SORTBENCH {
+	const struct gamei *	orig;	// unsorted
+	struct gamei *			ga;
+	size_t					n;
+};
+
+static int
+compare_game_ref (const void *a, const void *b)
+{
+	const struct gamei *ap = a;
+	const struct gamei *bp = b;
+	int64_t ka = ap->whiteplayer * 0x100000000LL + ap->blackplayer;
+	int64_t kb = bp->whiteplayer * 0x100000000LL + bp->blackplayer;
+	return (ka > kb) - (ka < kb);
+}
+
+static void
+k_qsort_games (void *p)
+{
+	struct SORTBENCH *s = p;
+	memcpy (s->ga, s->orig, sizeof(struct gamei) * s->n);
+	qsort (s->ga, s->n, sizeof(struct gamei), compare_game_ref);
+	Sink += (double)s->ga[0].score;
+}
+
+static void
+k_radix_games (void *p)
+{
+	struct SORTBENCH *s = p;
+	memcpy (s->ga, s->orig, sizeof(struct gamei) * s->n);
+	if (!radix_sort_pairs	( s->ga, s->n, sizeof(struct gamei)
+							, offsetof(struct gamei, whiteplayer), offsetof(struct gamei, blackplayer)
+							, sizeof(player_t), NULL)) {
+		fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);
+	}
+	Sink += (double)s->ga[0].score;
+}
+
+static void
+bench_sort (struct BENCH *b, player_t n_players, size_t n)
+{
+	struct SORTBENCH s;
+	struct gamei *orig, *ref;
+	double err = 0;
+	size_t i;
+
+	orig	= memnew (sizeof(struct gamei) * n);
+	ref		= memnew (sizeof(struct gamei) * n);
+	s.ga	= memnew (sizeof(struct gamei) * n);
+	if (!orig || !ref || !s.ga) {fprintf (stderr, "not enough memory\n"); exit(EXIT_FAILURE);}
+	s.orig	= orig;
+	s.n		= n;
+
+	for (i = 0; i < n; i++) {
+		orig[i].whiteplayer = (player_t)(ranctx_val(&b->rng) % (uint32_t)n_players);
+		orig[i].blackplayer = (player_t)(ranctx_val(&b->rng) % (uint32_t)n_players);
+		orig[i].score = (int32_t)(ranctx_val(&b->rng) % 3);
+	}
+
+	k_qsort_games (&s);
+	memcpy (ref, s.ga, sizeof(struct gamei) * n);
+	report (b, "qsort games", (long)n, measure (b, k_qsort_games, &s), (double)n, 0, 0);
+
+	k_radix_games (&s);
+	for (i = 0; i < n; i++) {
+		if (0 != compare_game_ref (&ref[i], &s.ga[i])) err = 1;
+	}
+	report (b, "radix_sort_pairs games", (long)n, measure (b, k_radix_games, &s), (double)n, err, 0);
+
+	memrel (s.ga);
+	memrel (ref);
+	memrel (orig);
+}
+
+/*------------------------------------------------------------------*/
+
+static const char *Usage =
+	"usage: kernbench [-t seconds] [-S seed]\n"
+	"\n"
+	" -t <num>   minimum time for each kernel (default 0.5)\n"
+	" -S <num>   seed (default 1)\n"
+	" -h         this help\n"
+	;
+
+int
+main (int argc, char *argv[])
+{
+	struct BENCH b;
+	double beta = (-log(1.0/0.76-1.0)) / 202;
+	long seed = 1;
+	int op;
+
+	b.min_time = 0.5;
+	b.failed = FALSE;
+
+	while (END_OF_OPTIONS != (op = options (argc, argv, "t:S:h"))) {
+		switch (op) {
+			case 't':	if (1 != sscanf (opt_arg, "%lf", &b.min_time) || b.min_time <= 0) {
+							fprintf (stderr, "wrong time parameter\n"); exit(EXIT_FAILURE);
+						}
+						break;
+			case 'S':	if (1 != sscanf (opt_arg, "%ld", &seed)) {
+							fprintf (stderr, "wrong seed parameter\n"); exit(EXIT_FAILURE);
+						}
+						break;
+			case 'h':	printf ("%s", Usage); exit(EXIT_SUCCESS);
+			default:	fprintf (stderr, "%s", Usage); exit(EXIT_FAILURE);
+		}
+	}
+
+	randfast_init ((uint32_t)seed);
+	ranctx_init (&b.rng, (uint32_t)seed, 0);
+	timer_reset();
+
+	printf ("%-32s %9s %10s %10s %11s  %s\n", "kernel", "size", "ns/op", "Mops/s", "max error", "check");
+
+	bench_scalar (&b, beta);
+	bench_encounters (&b, beta, 1000, 20000);
+	bench_encounters (&b, beta, 100000, 1000000);
+	bench_summations (&b, 100);
+	bench_summations (&b, 1000);
+	bench_summations (&b, 3000);
+	bench_names (&b, 1000);
+	bench_names (&b, 100000);
+	bench_sort (&b, 1000, 100000);
+	bench_sort (&b, 100000, 10000000);
+
+	if (Sink == 12345.6789) printf ("\n"); // keeps the results alive
+
+	return b.failed? EXIT_FAILURE: EXIT_SUCCESS;
+}
@@ -0,0 +1,1058 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "libordo.h"
+#include "pgnget.h"
+#include "randfast.h"
+#include "encount.h"
+#include "groups.h"
+#include "inidone.h"
+#include "plyrs.h"
+#include "ra.h"
+#include "relprior.h"
+#include "rtngcalc.h"
+#include "summations.h"
+#include "xpect.h"
+#include "mystr.h"
+#include "mymem.h"
+#include "radix.h"
+
+enum STAGES {
+	  STAGE_NEW = 0
+	, STAGE_LOADED
+	, STAGE_PRIORS
+	, STAGE_TRANSFORMED
+	, STAGE_SOLVED
+};
+
+static bool_t
+errmsg_add (struct ordo_ctx *ctx, const char *s)
+{
+	size_t len = strlen (ctx->errmsg);
+	mystrncpy (ctx->errmsg + len, s, (int)(sizeof(ctx->errmsg) - len));
+	return FALSE;
+}
+
+static bool_t
+fail (struct ordo_ctx *ctx, int error, const char *msg)
+{
+	ctx->error = error;
+	ctx->errmsg[0] = '\0';
+	return errmsg_add (ctx, msg);
+}
+
+static bool_t
+stage_is (struct ordo_ctx *ctx, int stage)
+{
+	if (ctx->stage != stage)
+		return fail (ctx, ORDO_ERR_SEQUENCE, "ERROR: library functions called out of sequence\n");
+	return TRUE;
+}
+
+/*
+|
+|	PROCESS
+|
+\*--------------------------------------------------------------*/
+
+void
+ordo_init (void)
+{
+	mythread_mutex_init (&Printmtx);
+	randfast_init (1324561);
+}
+
+void
+ordo_done (void)
+{
+	mythread_mutex_destroy (&Printmtx);
+}
+
+/*
+|
+|	CONTEXT
+|
+\*--------------------------------------------------------------*/
+
+void
+ordo_config_default (struct ordo_config *cfg)
+{
+	struct prior wa_prior = {40.0,20.0,FALSE};
+	struct prior dr_prior = { 0.5, 0.1,FALSE};
+
+	memset (cfg, 0, sizeof(struct ordo_config));
+	cfg->general_average	= 2300.0;
+	cfg->white_advantage	= 0;
+	cfg->drawrate			= STANDARD_DRAWRATE;
+	cfg->wa_prior			= wa_prior;
+	cfg->dr_prior			= dr_prior;
+	cfg->rtng_76			= 202;
+	cfg->name_warnings		= TRUE;
+	cfg->groupcheck			= TRUE;
+	cfg->approx.batch		= 4096;
+}
+
+struct ordo_ctx *
+ordo_new (const struct ordo_config *cfg)
+{
+	struct ordo_ctx *ctx = memnew (sizeof(struct ordo_ctx));
+	if (ctx == NULL) return NULL;
+
+	memset (ctx, 0, sizeof(struct ordo_ctx));
+	ctx->stage = STAGE_NEW;
+	ordo_configure (ctx, cfg);
+	ctx->white_advantage = cfg->white_advantage;
+	ctx->drawrate = cfg->drawrate;
+	summations_init (&ctx->sfe);
+	encmerge_init (&ctx->encmerge);
+	return ctx;
+}
+
+static void
+games_release (struct ordo_ctx *ctx)
+{
+	if (ctx->games_owned)
+		games_done (&ctx->games);
+	else
+		memset (&ctx->games, 0, sizeof(ctx->games)); // borrowed from ctx->lender
+}
+
+static void
+conn_release (struct ordo_ctx *ctx)
+{
+	if (ctx->conn_ready)
+		incconn_done (&ctx->conn);
+	ctx->conn_ready = FALSE;
+}
+
+// releases everything built from ctx->pdaba
+static void
+job_release (struct ordo_ctx *ctx)
+{
+	summations_done (&ctx->sfe);
+	summations_init (&ctx->sfe);
+	ctx->simulations = 0;
+
+	if (ctx->stage >= STAGE_LOADED) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		players_done (&ctx->players);
+		supporting_auxmem_done (&ctx->pp, &ctx->pp_store);
+	}
+	if (ctx->stage >= STAGE_TRANSFORMED) {
+		if (ctx->ext != NULL)
+			memset (&ctx->encounters_full, 0, sizeof(ctx->encounters_full)); // mapped
+		else
+			encounters_done (&ctx->encounters_full);
+	}
+	conn_release (ctx);
+	encmerge_done (&ctx->encmerge);
+
+	relpriors_done2 (&ctx->rpset, &ctx->rpset_store);
+	ctx->stage = STAGE_NEW;
+}
+
+void
+ordo_free (struct ordo_ctx *ctx)
+{
+	if (ctx == NULL) return;
+
+	job_release (ctx);
+
+	if (ctx->pdaba != NULL && ctx->pdaba_owned)
+		database_done (ctx->pdaba);
+
+	if (ctx->follow != NULL)
+		pgnfollow_close (ctx->follow);
+
+	extenc_close (ctx->ext);
+
+	memrel (ctx);
+}
+
+void
+ordo_configure (struct ordo_ctx *ctx, const struct ordo_config *cfg)
+{
+	ctx->cfg = *cfg;
+	ctx->prior_mode = cfg->prior_mode || NULL != cfg->relations || NULL != cfg->loose_anchors;
+	ctx->anchor_use = NULL != cfg->anchor_name;
+	ctx->beta = (-log(1.0/0.76-1.0)) / cfg->rtng_76;
+}
+
+void
+ordo_use_pool (struct ordo_ctx *ctx, thpool_t *pool)
+{
+	ctx->pool = pool;
+}
+
+/*
+|
+|	INPUT
+|
+\*--------------------------------------------------------------*/
+
+static int
+compare_GAME (const void * a, const void * b)
+{
+	const struct gamei *ap = a;
+	const struct gamei *bp = b;
+	if (ap->whiteplayer == bp->whiteplayer && ap->blackplayer == bp->blackplayer) return 0;
+	if (ap->whiteplayer == bp->whiteplayer) {
+		if (ap->blackplayer > bp->blackplayer) return 1; else return -1;
+	} else {	 
+		if (ap->whiteplayer > bp->whiteplayer) return 1; else return -1;
+	}
+	return 0;	
+}
+
+// encounters of all the games of a lender, whatever stage it is in
+static const struct ENCOUNTERS *
+lender_encounters (const struct ordo_ctx *lender)
+{
+	return lender->stage >= STAGE_TRANSFORMED? &lender->encounters_full: &lender->encounters;
+}
+
+// same games, with the draws flagged as ignored
+static void
+games_copy_nodraws (const struct GAMES *src, struct GAMES *tgt)
+{
+	gamesnum_t i;
+	for (i = 0; i < src->n; i++) {
+		tgt->ga[i] = src->ga[i];
+		if (tgt->ga[i].score == RESULT_DRAW)
+			tgt->ga[i].score |= IGNORED;
+	}
+	tgt->n = src->n;
+}
+
+// anchor and draw rate, once the players are loaded
+static bool_t
+load_check (struct ordo_ctx *ctx)
+{
+	/*==== process anchor ====*/
+
+	if (ctx->anchor_use) {
+		player_t anch_idx;
+		if (players_name2idx(&ctx->players, ctx->cfg.anchor_name, &anch_idx)) {
+			ctx->anchor = anch_idx;
+			anchor_j (anch_idx, ctx->cfg.general_average, &ctx->ra, &ctx->players);
+		} else {
+			fail (ctx, ORDO_ERR_ANCHOR, "ERROR: No games of anchor player, mispelled, wrong capital letters, or extra spaces = \"");
+			errmsg_add (ctx, ctx->cfg.anchor_name);
+			return errmsg_add (ctx, "\"\nSurround the name with \"quotes\" if it contains spaces\n\n");
+		} 
+	}
+
+	/*==== more wrong input ====*/
+
+	if (ctx->drawrate < 0.0 || ctx->drawrate > 1.0)
+		return fail (ctx, ORDO_ERR_DRAWRATE, "ERROR: Invalide draw rate set\n");
+
+	if (!(ctx->drawrate > 0.0) && ctx->game_stats.draws > 0 && ctx->prior_mode)
+		return fail (ctx, ORDO_ERR_DRAWRATE, "ERROR: Draws present in the database but -d switch specified an invalid number\n");
+
+	if (ctx->drawrate > 0.999)
+		return fail (ctx, ORDO_ERR_DRAWRATE, "ERROR: Draw rate set with -d switch is too high, > 99.9%\n");
+
+	return TRUE;
+}
+
+// read-only view of the encounters in ctx->ext
+static void
+ext_encounters (const struct ordo_ctx *ctx, struct ENCOUNTERS *e)
+{
+	gamesnum_t n;
+	e->enc	= (struct ENC *)extenc_enc (ctx->ext, &n);
+	e->n	= n;
+	e->size	= n;
+}
+
+// players and statistics when there are no games, only encounters
+static void
+ext_players (struct ordo_ctx *ctx, const struct ENCOUNTERS *ext)
+{
+	gamesnum_t e;
+	database_players (ctx->pdaba, &ctx->games, &ctx->players, &ctx->game_stats);
+	extenc_stats (ctx->ext, &ctx->game_stats);
+	for (e = 0; e < ext->n; e++) {
+		ctx->players.present_in_games[ext->enc[e].wh] = TRUE;
+		ctx->players.present_in_games[ext->enc[e].bl] = TRUE;
+	}
+}
+
+// ctx->pdaba is ready, builds everything else from it,
+// or from the games already sorted by ctx->lender, or from ctx->ext
+static bool_t
+load_finish (struct ordo_ctx *ctx)
+{
+	const struct DATA *pdaba = ctx->pdaba;
+	const struct ordo_ctx *lender = ctx->lender;
+	player_t mpr 	= pdaba->n_players; 
+	player_t mpp 	= pdaba->n_players; 
+	gamesnum_t mg  	= pdaba->n_games;
+	gamesnum_t me  	= pdaba->n_games;
+	bool_t borrow	= lender != NULL && lender->stage >= STAGE_LOADED;
+	bool_t nodraws	= borrow && ctx->cfg.ignore_draws && !lender->cfg.ignore_draws;
+	struct ENCOUNTERS ext;
+
+	memset (&ext, 0, sizeof(ext)); // only used with ctx->ext
+	if (0 == pdaba->n_players || 0 == pdaba->n_games)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games\n");
+
+	if (borrow && !ctx->cfg.ignore_draws && lender->cfg.ignore_draws)
+		return fail (ctx, ORDO_ERR_INPUT, "ERROR: draws are ignored in the shared games\n");
+
+	ctx->games_owned = !borrow || nodraws;
+	if (!ctx->games_owned) ctx->games = lender->games;
+
+	if (ctx->ext != NULL) {
+		ext_encounters (ctx, &ext);
+		if (0 == ext.n)
+			return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games to process\n");
+		me = ext.n;
+		ctx->games_owned = FALSE; // no games, only encounters
+	}
+
+	/*==== memory initialization ====*/
+
+	if (!ratings_init (mpr, &ctx->ra)) {
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize rating memory\n");
+	} else 
+	if (ctx->games_owned && !games_init (mg, &ctx->games)) {
+		ratings_done (&ctx->ra);
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Games memory\n");
+	} else 
+	if (!encounters_init (me, &ctx->encounters)) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Encounters memory\n");
+	} else 
+	if (!players_init (mpp, &ctx->players)) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Players memory\n");
+	} else
+	if (!supporting_auxmem_init (mpp, &ctx->pp, &ctx->pp_store)) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		players_done (&ctx->players);
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize auxiliary Players memory\n");
+	}
+	ctx->stage = STAGE_LOADED; // from here on, ordo_free releases the memory
+
+	assert(players_have_clear_flags(&ctx->players));
+
+	/*==== data translation ====*/
+
+	if (ctx->ext != NULL) {
+		ext_players (ctx, &ext);
+	} else if (borrow) {
+		if (nodraws) games_copy_nodraws (&lender->games, &ctx->games); // still sorted
+		database_players (pdaba, &ctx->games, &ctx->players, &ctx->game_stats);
+	} else {
+		database_transform (pdaba, &ctx->games, &ctx->players, &ctx->game_stats);
+		if (!radix_sort_pairs	( ctx->games.ga, (size_t)ctx->games.n, sizeof(struct gamei)
+								, offsetof(struct gamei, whiteplayer), offsetof(struct gamei, blackplayer)
+								, sizeof(player_t), ctx->pool))
+			qsort (ctx->games.ga, (size_t)ctx->games.n, sizeof(struct gamei), compare_GAME);
+	}
+	if (0 == ctx->games.n && ctx->ext == NULL)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games\n");
+
+	if (!load_check (ctx))
+		return FALSE;
+
+	assert(players_have_clear_flags(&ctx->players));
+	if (ctx->ext != NULL)
+		encounters_copy (&ext, &ctx->encounters);
+	else if (borrow && !nodraws)
+		encounters_copy (lender_encounters (lender), &ctx->encounters);
+	else
+		encounters_calculate(ENCOUNTERS_FULL, &ctx->games, ctx->players.flagged, &ctx->encounters);
+
+	if (0 == ctx->encounters.n)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games to process\n");
+
+	ctx->folded = ctx->games_owned? ctx->games.n: 0;
+	return TRUE;
+}
+
+static bool_t
+include_only (struct ordo_ctx *ctx, const char *fname, bool_t negate, bool_t warnings, gamesnum_t first)
+{
+	bitarray_t ba;
+	if (!ba_init (&ba, ctx->pdaba->n_players))
+		return fail (ctx, ORDO_ERR_MEMORY, "ERROR\n");
+	namelist_to_bitarray (ctx->cfg.quiet, warnings, fname, ctx->pdaba, &ba);
+	if (negate) ba_setnot(&ba);
+	database_include_only(ctx->pdaba, &ba, first);
+	ba_done(&ba);
+	return TRUE;
+}
+
+// to the games from first on, the ones before are filtered already
+static bool_t
+filters_apply (struct ordo_ctx *ctx, gamesnum_t first, bool_t warnings)
+{
+	if (ctx->cfg.ignore_draws) database_ignore_draws(ctx->pdaba, first);
+
+	if (NULL != ctx->cfg.includes && !include_only (ctx, ctx->cfg.includes, FALSE, warnings, first))
+		return FALSE;
+	if (NULL != ctx->cfg.excludes && !include_only (ctx, ctx->cfg.excludes, TRUE, warnings, first))
+		return FALSE;
+	return TRUE;
+}
+
+// games are spilled to cfg.tmpdir while parsing, and merged there into encounters
+static bool_t
+load_external (struct ordo_ctx *ctx, strlist_t *files)
+{
+	if (NULL != ctx->cfg.includes || NULL != ctx->cfg.excludes)
+		return fail (ctx, ORDO_ERR_INPUT, "ERROR: games kept in temporary files cannot be filtered by name\n");
+
+	if (NULL == (ctx->ext = extenc_open (ctx->cfg.tmpdir, EXT_RUN_GAMES, ctx->cfg.ignore_draws))) {
+		fail (ctx, ORDO_ERR_INPUT, "ERROR: temporary files cannot be written in \"");
+		errmsg_add (ctx, ctx->cfg.tmpdir);
+		return errmsg_add (ctx, "\"\n");
+	}
+
+	if (NULL == (ctx->pdaba = database_init_spilled (files, ctx->cfg.synonyms, ctx->cfg.quiet, extenc_add, ctx->ext)))
+		return fail (ctx, ORDO_ERR_INPUT, "Problems reading results, or writing temporary files\n");
+	ctx->pdaba_owned = TRUE;
+
+	if (!extenc_finish (ctx->ext)) {
+		fail (ctx, ORDO_ERR_INPUT, "ERROR: temporary files could not be written in \"");
+		errmsg_add (ctx, ctx->cfg.tmpdir);
+		return errmsg_add (ctx, "\"\n");
+	}
+
+	return load_finish (ctx);
+}
+
+bool_t
+ordo_load_pgn (struct ordo_ctx *ctx, strlist_t *files)
+{
+	if (!stage_is (ctx, STAGE_NEW)) return FALSE;
+
+	if (ctx->cfg.tmpdir != NULL)
+		return load_external (ctx, files);
+
+	if (NULL == (ctx->pdaba = database_init_frompgn (files, ctx->cfg.synonyms, ctx->cfg.quiet)))
+		return fail (ctx, ORDO_ERR_INPUT, "Problems reading results\n");
+	ctx->pdaba_owned = TRUE;
+
+	if (0 == ctx->pdaba->n_players || 0 == ctx->pdaba->n_games)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games\n");
+
+	return filters_apply (ctx, 0, ctx->cfg.name_warnings) && load_finish (ctx);
+}
+
+bool_t
+ordo_load_follow (struct ordo_ctx *ctx, const char *fname)
+{
+	if (!stage_is (ctx, STAGE_NEW)) return FALSE;
+
+	if (NULL == (ctx->follow = pgnfollow_open (fname)))
+		return fail (ctx, ORDO_ERR_INPUT, "Problems reading results\n");
+	if (NULL == (ctx->pdaba = database_init_empty (ctx->cfg.synonyms, ctx->cfg.quiet)))
+		return fail (ctx, ORDO_ERR_MEMORY, "Problems reading results\n");
+	ctx->pdaba_owned = TRUE;
+
+	pgnfollow_read (ctx->follow, ctx->pdaba);
+
+	if (0 == ctx->pdaba->n_players || 0 == ctx->pdaba->n_games)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games\n");
+
+	return filters_apply (ctx, 0, ctx->cfg.name_warnings) && load_finish (ctx);
+}
+
+gamesnum_t
+ordo_follow_read (struct ordo_ctx *ctx)
+{
+	gamesnum_t n, first;
+
+	if (ctx->follow == NULL) return 0;
+
+	first = ctx->pdaba->n_games;
+	n = pgnfollow_read (ctx->follow, ctx->pdaba);
+	if (n > 0 && !filters_apply (ctx, first, FALSE)) 
+		return -1;
+	return n;
+}
+
+bool_t
+ordo_load_games	( struct ordo_ctx *ctx
+				, player_t n_players
+				, const char *const *names
+				, gamesnum_t n_games
+				, const player_t *white
+				, const player_t *black
+				, const int *result)
+{
+	if (!stage_is (ctx, STAGE_NEW)) return FALSE;
+
+	if (NULL == (ctx->pdaba = database_init_fromarrays (n_players, names, n_games, white, black, result)))
+		return fail (ctx, ORDO_ERR_INPUT, "Games could not be loaded: repeated names, wrong indexes or lack of memory\n");
+	ctx->pdaba_owned = TRUE;
+
+	if (ctx->cfg.ignore_draws) database_ignore_draws(ctx->pdaba, 0);
+
+	return load_finish (ctx);
+}
+
+bool_t
+ordo_load_shared (struct ordo_ctx *ctx, const struct ordo_ctx *src)
+{
+	if (!stage_is (ctx, STAGE_NEW)) return FALSE;
+
+	if (src->pdaba == NULL)
+		return fail (ctx, ORDO_ERR_INPUT, "Shared context has no games loaded\n");
+
+	if (src->ext != NULL)
+		return fail (ctx, ORDO_ERR_INPUT, "Games kept in temporary files cannot be shared\n");
+
+	// read only from here on, filters of src (draws, includes, excludes) were already applied
+	ctx->pdaba = src->pdaba;
+	ctx->pdaba_owned = FALSE;
+	ctx->lender = src;
+
+	return load_finish (ctx);
+}
+
+bool_t
+ordo_load_window (struct ordo_ctx *ctx, const struct ordo_ctx *src, const struct ENCOUNTERS *window)
+{
+	struct GAMESTATS *gs = &ctx->game_stats;
+	gamesnum_t e;
+
+	if (!ordo_load_shared (ctx, src)) return FALSE;
+
+	if (0 == window->n)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: no games to process\n");
+
+	encounters_copy (window, &ctx->encounters);
+
+	memset (ctx->players.present_in_games, 0, sizeof(bool_t) * (size_t)ctx->players.n);
+	gs->white_wins = gs->draws = gs->black_wins = gs->noresult = 0;
+	for (e = 0; e < window->n; e++) {
+		ctx->players.present_in_games[window->enc[e].wh] = TRUE;
+		ctx->players.present_in_games[window->enc[e].bl] = TRUE;
+		gs->white_wins	+= window->enc[e].W;
+		gs->draws		+= window->enc[e].D;
+		gs->black_wins	+= window->enc[e].L;
+	}
+	return TRUE;
+}
+
+bool_t
+ordo_add_game (struct ordo_ctx *ctx, const char *white, const char *black, int result)
+{
+	if (ctx->pdaba == NULL || !ctx->pdaba_owned)
+		return fail (ctx, ORDO_ERR_SEQUENCE, "ERROR: games can only be added to a context that loaded them\n");
+
+	if (ctx->ext != NULL)
+		return fail (ctx, ORDO_ERR_SEQUENCE, "ERROR: games cannot be added to the ones in temporary files\n");
+
+	if (ctx->cfg.ignore_draws && result == RESULT_DRAW)
+		result |= IGNORED;
+
+	if (!database_add_game (ctx->pdaba, white, black, result))
+		return fail (ctx, ORDO_ERR_MEMORY, "Not enough memory to add the game\n");
+
+	return TRUE;
+}
+
+// games of ctx->pdaba loaded, filtered and sorted into encounters already,
+// so only the new ones need it
+static bool_t
+can_update (const struct ordo_ctx *ctx)
+{
+	return ctx->stage >= STAGE_LOADED && ctx->pdaba_owned && ctx->games_owned 
+		&& ctx->folded > 0 && ctx->folded <= ctx->pdaba->n_games;
+}
+
+/*
+|	Same result as job_release() and load_finish(), but only the games
+|	added to ctx->pdaba are copied and sorted. Their encounters are merged
+|	into the ones already calculated. The players are set again from the
+|	encounters, not from the games. Games stay in input order after the
+|	ones sorted when loaded, the encounters do not depend on it.
+|	Connectivity, once built, takes only the added encounters too.
+*/
+static bool_t
+load_update (struct ordo_ctx *ctx)
+{
+	const struct DATA *pdaba = ctx->pdaba;
+	gamesnum_t first = ctx->folded;
+	player_t mpp = pdaba->n_players;
+	struct ENCOUNTERS *all = ctx->stage >= STAGE_TRANSFORMED? &ctx->encounters_full: &ctx->encounters;
+	struct ENCOUNTERS added, merged;
+	struct GAMES tail;
+	struct GAMESTATS gs = ctx->game_stats;
+	struct GAMES none = {0, 0, NULL};
+	gamesnum_t e;
+
+	if (!games_grow (pdaba->n_games, &ctx->games))
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Games memory\n");
+	database_append (pdaba, &ctx->games, &gs);
+
+	tail.n		= ctx->games.n - first;
+	tail.size	= tail.n;
+	tail.ga		= ctx->games.ga + first;
+
+	if (!encounters_init (tail.n > 0? tail.n: 1, &added))
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Encounters memory\n");
+	encounters_calculate (ENCOUNTERS_FULL, &tail, NULL, &added);
+
+	if (!encounters_merge (all, &added, &merged)) {
+		encounters_done (&added);
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Encounters memory\n");
+	}
+
+	// each one may walk every component, a pool in many pieces is faster
+	// built again by ordo_transform() in one pass
+	if (ctx->conn_ready && added.n * ctx->conn.n_comp > merged.n + mpp)
+		conn_release (ctx);
+	if (ctx->conn_ready && !incconn_grow (&ctx->conn, mpp))
+		conn_release (ctx);
+	if (ctx->conn_ready)
+		incconn_load (&ctx->conn, &added);
+	encounters_done (&added);
+
+	// everything built from the players, which may be more now
+	summations_done (&ctx->sfe);
+	summations_init (&ctx->sfe);
+	ctx->simulations = 0;
+	ratings_done (&ctx->ra);
+	encounters_done (&ctx->encounters);
+	if (ctx->stage >= STAGE_TRANSFORMED)
+		encounters_done (&ctx->encounters_full);
+	players_done (&ctx->players);
+	supporting_auxmem_done (&ctx->pp, &ctx->pp_store);
+	relpriors_done2 (&ctx->rpset, &ctx->rpset_store);
+	ctx->encounters = merged;
+
+	if (!ratings_init (mpp, &ctx->ra)) {
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		ctx->stage = STAGE_NEW;
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize rating memory\n");
+	} else
+	if (!players_init (mpp, &ctx->players)) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		ctx->stage = STAGE_NEW;
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Players memory\n");
+	} else
+	if (!supporting_auxmem_init (mpp, &ctx->pp, &ctx->pp_store)) {
+		ratings_done (&ctx->ra);
+		games_release (ctx);
+		encounters_done (&ctx->encounters);
+		players_done (&ctx->players);
+		ctx->stage = STAGE_NEW;
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize auxiliary Players memory\n");
+	}
+	ctx->stage = STAGE_LOADED;
+	ctx->folded = ctx->games.n;
+
+	database_players (pdaba, &none, &ctx->players, &ctx->game_stats);
+	ctx->game_stats = gs;
+	for (e = 0; e < ctx->encounters.n; e++) {
+		ctx->players.present_in_games[ctx->encounters.enc[e].wh] = TRUE;
+		ctx->players.present_in_games[ctx->encounters.enc[e].bl] = TRUE;
+	}
+
+	if (!load_check (ctx))
+		return FALSE;
+
+	if (0 == ctx->encounters.n)
+		return fail (ctx, ORDO_ERR_NOGAMES, "ERROR: Input file contains no games to process\n");
+
+	return TRUE;
+}
+
+bool_t
+ordo_rebuild (struct ordo_ctx *ctx)
+{
+	double *warm = NULL;
+	player_t warm_n = 0;
+	double wa = ctx->white_advantage;
+	double dr = ctx->drawrate;
+	bool_t ok;
+	player_t j;
+
+	if (ctx->pdaba == NULL)
+		return fail (ctx, ORDO_ERR_SEQUENCE, "ERROR: no games loaded\n");
+
+	if (ctx->stage >= STAGE_SOLVED) {
+		warm_n = ctx->players.n;
+		if (NULL != (warm = memnew (sizeof(double) * (size_t)warm_n))) {
+			for (j = 0; j < warm_n; j++)
+				warm[j] = ctx->players.flagged[j]? HUGE_VAL: ctx->ra.ratingof[j]; // purged, no solution
+		}
+	}
+
+	if (can_update (ctx)) {
+		ok = load_update (ctx) && ordo_priors (ctx);
+	} else {
+		job_release (ctx);
+		ok = load_finish (ctx) && ordo_priors (ctx);
+	}
+
+	if (ok && warm != NULL)
+		ordo_warm_start (ctx, warm, warm_n, wa, dr);
+
+	if (warm) memrel (warm);
+	return ok;
+}
+
+void
+ordo_warm_start (struct ordo_ctx *ctx, const double *rating, player_t n, double wa, double dr)
+{
+	player_t j;
+
+	if (!stage_is (ctx, STAGE_PRIORS)) return;
+
+	// players keep their index in ctx->pdaba, new ones start from the seed
+	for (j = 0; j < n && j < ctx->players.n; j++) {
+		if (!ctx->players.prefed[j] && rating[j] < HUGE_VAL)
+			ctx->ra.ratingof[j] = rating[j];
+	}
+	if (ctx->cfg.adjust_white_advantage) ctx->white_advantage = wa;
+	if (ctx->cfg.adjust_draw_rate) ctx->drawrate = dr;
+	ctx->warm = TRUE;
+}
+
+// One pass of Elo updates over the games in input order. Each step is
+// the inverse of the information of the games already played by the
+// player, so it is a running estimate, not a fixed K factor.
+static void
+online_seed (struct ordo_ctx *ctx)
+{
+	const struct DATA *pdaba = ctx->pdaba;
+	double *r = ctx->ra.ratingof;
+	double beta = ctx->beta;
+	double wa = ctx->cfg.white_advantage;
+	double excess = 0;
+	gamesnum_t *played;
+	gamesnum_t i;
+	player_t j, n = ctx->players.n, counted = 0;
+
+	if (ctx->ext != NULL)
+		return; // games are not kept, flat start
+	if (NULL == (played = memnew (sizeof(gamesnum_t) * (size_t)n)))
+		return; // flat start
+	for (j = 0; j < n; j++) played[j] = 0;
+
+	for (i = 0; i < pdaba->n_games; i++) {
+		struct gamei g;
+		int32_t date;
+		double s, d;
+		player_t w, b;
+
+		database_getgame (pdaba, i, &g, &date);
+		if (g.score >= DISCARD) continue;
+
+		w = g.whiteplayer;
+		b = g.blackplayer;
+		s = g.score == WHITE_WIN? 1.0: (g.score == RESULT_DRAW? 0.5: 0.0);
+		d = s - xpect (r[w] + wa, r[b], beta);
+
+		r[w] += d * 4.0 / (beta * (double)(played[w] + 2));
+		r[b] -= d * 4.0 / (beta * (double)(played[b] + 2));
+		played[w]++;
+		played[b]++;
+	}
+
+	// same average as the flat start
+	for (j = 0; j < n; j++) {
+		if (played[j] > 0) {excess += r[j] - ctx->cfg.general_average; counted++;}
+	}
+	excess = counted > 0? excess / (double)counted: 0;
+	for (j = 0; j < n; j++) {
+		if (played[j] > 0) r[j] -= excess;
+		ctx->ra.ratingbk[j] = r[j];
+	}
+
+	memrel (played);
+}
+
+bool_t
+ordo_priors (struct ordo_ctx *ctx)
+{
+	bool_t quiet = ctx->cfg.quiet;
+
+	if (!stage_is (ctx, STAGE_LOADED)) return FALSE;
+
+	ratings_starting_point (ctx->players.n, ctx->cfg.general_average, &ctx->ra);
+	if (ctx->cfg.init_online) online_seed (ctx);
+
+	// priors
+	priors_reset (ctx->pp, ctx->players.n);
+	if (ctx->cfg.loose_anchors != NULL
+		&& !priors_load (quiet, ctx->cfg.loose_anchors, &ctx->ra, &ctx->players, ctx->pp)) {
+		return fail (ctx, ORDO_ERR_INPUT, "ERROR: loose anchors could not be loaded\n");
+	}
+
+	// multiple anchors here
+	if (ctx->cfg.multi_anchors != NULL
+		&& !init_manchors (quiet, ctx->cfg.multi_anchors, &ctx->ra, &ctx->players)) {
+		return fail (ctx, ORDO_ERR_INPUT, "ERROR: multiple anchors could not be loaded\n");
+	}
+
+	// relative priors
+	if (ctx->cfg.relations != NULL
+		&& !relpriors_init (quiet, &ctx->players, ctx->cfg.relations, &ctx->rpset, &ctx->rpset_store)) {
+		return fail (ctx, ORDO_ERR_INPUT, "ERROR: relations could not be loaded\n");
+	}
+
+	// show priored information
+	if (!quiet) {
+		priors_show(&ctx->players, ctx->pp, ctx->players.n);
+		relpriors_show(&ctx->players, &ctx->rpset);
+		players_set_priored_info (ctx->pp, &ctx->rpset, &ctx->players);
+	}
+
+	ctx->stage = STAGE_PRIORS;
+	return TRUE;
+}
+
+// connectivity of ctx->encounters, which must hold every valid game
+static bool_t
+conn_build (struct ordo_ctx *ctx)
+{
+	if (!ctx->conn_ready && incconn_init (&ctx->conn, ctx->players.n)) {
+		incconn_load (&ctx->conn, &ctx->encounters);
+		ctx->conn_ready = TRUE;
+	}
+	return ctx->conn_ready;
+}
+
+bool_t
+ordo_groups (struct ordo_ctx *ctx, player_t *groups_n)
+{
+	if (!stage_is (ctx, STAGE_PRIORS)) return FALSE;
+
+	if (!conn_build (ctx))
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Encounters memory\n");
+	*groups_n = incconn_groups (&ctx->conn);
+	return TRUE;
+}
+
+/*
+|
+|	RATINGS
+|
+\*--------------------------------------------------------------*/
+
+bool_t
+ordo_transform (struct ordo_ctx *ctx)
+{
+	bool_t quiet = ctx->cfg.quiet;
+
+	if (!stage_is (ctx, STAGE_PRIORS)) return FALSE;
+
+	// ctx->encounters still has all of them, as calculated when loaded
+	assert(players_have_clear_flags(&ctx->players));
+
+	if (ctx->ext != NULL)
+		ext_encounters (ctx, &ctx->encounters_full); // same list, already on disk
+	else if (!encounters_replicate (&ctx->encounters, &ctx->encounters_full))
+		return fail (ctx, ORDO_ERR_MEMORY, "Could not initialize Encounters memory\n");
+	ctx->stage = STAGE_TRANSFORMED;
+
+	// without it, the encounters are scanned again below
+	conn_build (ctx);
+
+	players_set_priored_info (ctx->pp, &ctx->rpset, &ctx->players);
+	if (0 < (ctx->conn_ready
+			? incconn_set_super (quiet, &ctx->conn, &ctx->players)
+			: players_set_super (quiet, &ctx->encounters, &ctx->players))) {
+		players_purge (quiet, &ctx->players);
+		encounters_select (ENCOUNTERS_NOFLAGGED, &ctx->encounters_full, ctx->players.flagged, &ctx->encounters);
+	}
+
+	// purged players are groups of their own in both
+	if (ctx->cfg.groupcheck && !(ctx->conn_ready
+			? incconn_connected (&ctx->conn)
+			: well_connected (&ctx->encounters, &ctx->players)))
+		return fail (ctx, ORDO_ERR_CONNECTIVITY, "Database is not well connected by games, even after purging players with all-wins/all-losses\n");
+
+	return TRUE;
+}
+
+bool_t
+ordo_solve (struct ordo_ctx *ctx)
+{
+	if (!stage_is (ctx, STAGE_TRANSFORMED)) return FALSE;
+
+	if (!ctx->warm || !ctx->cfg.adjust_white_advantage)
+		ctx->white_advantage = ctx->cfg.white_advantage;
+	if (!ctx->warm || !ctx->cfg.adjust_draw_rate)
+		ctx->drawrate = ctx->cfg.drawrate;
+	ctx->warm = FALSE;
+
+	ctx->encounters.n = calc_rating 
+								( ctx->cfg.quiet
+								, ctx->cfg.force_ml || ctx->prior_mode
+								, ctx->cfg.adjust_white_advantage
+								, ctx->cfg.adjust_draw_rate
+								, ctx->anchor_use
+								, ctx->cfg.anchor_err_rel2avg
+
+								, ctx->cfg.general_average
+								, ctx->anchor
+								, priors_count (ctx->pp, ctx->players.n)
+								, ctx->beta
+
+								, &ctx->encounters
+								, &ctx->rpset
+								, &ctx->players
+								, &ctx->ra
+								, &ctx->encounters_full
+								, &ctx->encmerge
+
+								, ctx->pp
+								, ctx->cfg.wa_prior
+								, ctx->cfg.dr_prior
+
+								, &ctx->cfg.approx
+
+								, &ctx->white_advantage
+								, &ctx->drawrate
+								, &ctx->convergence
+								);
+
+	ratings_results	( ctx->cfg.anchor_err_rel2avg
+					, ctx->anchor_use 
+					, ctx->anchor
+					, ctx->cfg.general_average				
+					, &ctx->players
+					, &ctx->ra);
+
+	ctx->stage = STAGE_SOLVED;
+	return TRUE;
+}
+
+long
+ordo_simulate	( struct ordo_ctx *ctx
+				, thpool_t *pool
+				, long n
+				, const struct SIMCTRL *simctrl
+				, bool_t sim_updates)
+{
+	if (!stage_is (ctx, STAGE_SOLVED)) return 0;
+
+	summations_done (&ctx->sfe);
+	summations_init (&ctx->sfe);
+
+	ctx->simulations = simul_smp
+				( pool
+				, n
+				, simctrl
+				, sim_updates
+				, ctx->cfg.quiet
+				, ctx->cfg.force_ml || ctx->prior_mode
+				, ctx->cfg.adjust_white_advantage
+				, ctx->cfg.adjust_draw_rate
+				, ctx->anchor_use
+				, ctx->cfg.anchor_err_rel2avg
+
+				, ctx->cfg.general_average
+				, ctx->anchor
+				, priors_count (ctx->pp, ctx->players.n)
+				, ctx->beta
+
+				, ctx->drawrate
+				, ctx->white_advantage
+				, &ctx->rpset
+				, ctx->pp
+				, ctx->cfg.wa_prior
+				, ctx->cfg.dr_prior
+
+				, &ctx->encounters_full
+				, &ctx->players
+				, &ctx->ra
+				, &ctx->encmerge
+
+				, &ctx->sfe
+				);
+
+	return ctx->simulations;
+}
+
+/*
+|
+|	RESULTS
+|
+\*--------------------------------------------------------------*/
+
+player_t
+ordo_players_n (const struct ordo_ctx *ctx)
+{
+	return ctx->stage >= STAGE_LOADED? ctx->players.n: 0;
+}
+
+const char *
+ordo_name (const struct ordo_ctx *ctx, player_t j)
+{
+	return ctx->players.name[j];
+}
+
+double
+ordo_rating (const struct ordo_ctx *ctx, player_t j)
+{
+	return ctx->ra.ratingof_results[j];
+}
+
+double
+ordo_error (const struct ordo_ctx *ctx, player_t j)
+{
+	return ctx->simulations > 1 && ctx->sfe.sdev != NULL? ctx->sfe.sdev[j]: 0;
+}
+
+double
+ordo_white_advantage (const struct ordo_ctx *ctx)
+{
+	return ctx->white_advantage;
+}
+
+double
+ordo_drawrate (const struct ordo_ctx *ctx)
+{
+	return ctx->drawrate;
+}
+
+const char *
+ordo_errmsg (const struct ordo_ctx *ctx)
+{
+	return ctx->errmsg;
+}
@@ -0,0 +1,218 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_LIBORDO)
+#define H_LIBORDO
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/*
+|	Rating jobs as objects. Everything a job needs lives in its ordo_ctx,
+|	so several of them may be loaded, solved and simulated in the same
+|	process, from different threads if needed. The games loaded by one
+|	context may be shared, read only, by others (ordo_load_shared).
+|
+|	Typical sequence:
+|		ordo_init
+|		ordo_config_default, ordo_new
+|		ordo_load_pgn (or ordo_load_games, ordo_load_shared)
+|		ordo_priors
+|		ordo_groups (optional)
+|		ordo_transform
+|		ordo_solve
+|		ordo_simulate (optional)
+|		ordo_rating, ordo_error...
+|		ordo_add_game or ordo_follow_read, ordo_configure, ordo_rebuild, ordo_transform... (optional)
+|		ordo_free
+|		ordo_done
+|
+|	Functions return FALSE on failure, with the reason in ordo_errmsg().
+|	A missing or malformed anchor, prior or relation file makes ordo_priors()
+|	fail with ORDO_ERR_INPUT. Running out of memory in the simulations or in
+|	the list of relations is still fatal (exit).
+\*--------------------------------------------------------------*/
+
+#include "boolean.h"
+#include "mytypes.h"
+#include "datatype.h"
+#include "strlist.h"
+#include "pgnget.h"
+#include "incconn.h"
+#include "extenc.h"
+#include "sim.h"
+#include "thpool.h"
+
+struct ordo_config {
+	  bool_t			quiet
+	; bool_t			force_ml				// maximum likelihood even without priors
+	; bool_t			prior_mode				// uncertainties given for white adv. or draw rate
+	; bool_t			adjust_white_advantage
+	; bool_t			adjust_draw_rate
+	; bool_t			anchor_err_rel2avg
+
+	; const char *		anchor_name				// NULL, the reference is the pool average
+	; double			general_average
+	; double			white_advantage
+	; double			drawrate				// for even matches, fraction (not %)
+	; struct prior		wa_prior
+	; struct prior		dr_prior
+	; double			rtng_76					// rating difference for a 76% expectancy
+
+	; bool_t			init_online				// starting ratings from one pass of Elo updates
+	; struct APPROXCTRL	approx					// minibatch solver, 0 epochs for the exact one
+
+	; bool_t			ignore_draws
+	; const char *		synonyms				// files, NULL if not used
+	; const char *		includes
+	; const char *		excludes
+	; bool_t			name_warnings			// for names in includes/excludes not found
+
+	; const char *		loose_anchors			// -y
+	; const char *		multi_anchors			// -m
+	; const char *		relations				// -r
+	; const char *		tmpdir					// ordo_load_pgn keeps the games there, NULL in memory
+	; bool_t			groupcheck				// fail if the database is not well connected
+	;
+};
+
+enum ORDO_ERROR {
+	  ORDO_OK = 0
+	, ORDO_ERR_MEMORY
+	, ORDO_ERR_INPUT
+	, ORDO_ERR_NOGAMES
+	, ORDO_ERR_ANCHOR
+	, ORDO_ERR_DRAWRATE
+	, ORDO_ERR_CONNECTIVITY
+	, ORDO_ERR_SEQUENCE
+};
+
+struct ordo_ctx {
+	  struct ordo_config	cfg
+
+	; struct DATA *			pdaba
+	; bool_t				pdaba_owned				// FALSE if shared with another context
+	; const struct ordo_ctx *lender				// context of ordo_load_shared, or NULL
+	; bool_t				games_owned				// FALSE if the games are the ones sorted by lender
+	; gamesnum_t			folded					// games of pdaba already in games and encounters
+	; pgnfollow_t *			follow					// input file that keeps growing, or NULL
+	; extenc_t *			ext						// encounters in cfg.tmpdir (no games), or NULL
+	; thpool_t *			pool					// threads to sort the games, or NULL
+	; struct GAMES			games
+	; struct PLAYERS		players
+	; struct RATINGS		ra
+	; struct ENCOUNTERS		encounters
+	; struct ENCOUNTERS		encounters_full			// all valid games, never purged
+	; struct INCCONN		conn					// connectivity of all valid games
+	; bool_t				conn_ready
+	; struct ENCMERGE		encmerge				// colors merged by the solver, kept
+	; struct GAMESTATS		game_stats
+	; struct prior *		pp
+	; struct prior *		pp_store
+	; struct rel_prior_set	rpset
+	; struct rel_prior_set	rpset_store
+	; struct summations		sfe						// summations for errors
+
+	; bool_t				prior_mode
+	; bool_t				anchor_use
+	; player_t				anchor
+	; double				beta
+
+	; double				white_advantage			// results
+	; double				drawrate
+	; long					simulations
+	; struct CONVERGENCE	convergence				// of the last ordo_solve
+
+	; bool_t				warm					// ratings start from the previous solution
+	; int					stage
+	; int					error
+	; char					errmsg[1280]
+	;
+};
+
+extern void		ordo_init (void);	// once per process, before any context is created
+extern void		ordo_done (void);
+
+extern void		ordo_config_default (struct ordo_config *cfg);
+
+extern struct ordo_ctx *
+				ordo_new (const struct ordo_config *cfg);
+extern void		ordo_free (struct ordo_ctx *ctx);
+
+// a new configuration or new games take effect after ordo_rebuild
+extern void		ordo_configure (struct ordo_ctx *ctx, const struct ordo_config *cfg);
+
+// threads that loading and ordo_rebuild may use, none if pool is NULL.
+// Not for a context handled inside a task of that same pool.
+extern void		ordo_use_pool (struct ordo_ctx *ctx, thpool_t *pool);
+
+// input, only one of them per context
+extern bool_t	ordo_load_pgn (struct ordo_ctx *ctx, strlist_t *files);
+extern bool_t	ordo_load_games	( struct ordo_ctx *ctx
+								, player_t n_players
+								, const char *const *names	// unique
+								, gamesnum_t n_games
+								, const player_t *white
+								, const player_t *black
+								, const int *result);		// enum RESULTS, pgnget.h
+extern bool_t	ordo_load_follow (struct ordo_ctx *ctx, const char *fname); // see ordo_follow_read
+// src must outlive ctx, no ordo_add_game on it. Once src is loaded, its sorted
+// games and encounters are reused, unless ctx ignores draws and src does not.
+extern bool_t	ordo_load_shared (struct ordo_ctx *ctx, const struct ordo_ctx *src);
+
+// as ordo_load_shared, but rated only with the encounters of window, which
+// must be sorted as those of src and come from its games. No ordo_rebuild.
+extern bool_t	ordo_load_window (struct ordo_ctx *ctx, const struct ordo_ctx *src, const struct ENCOUNTERS *window);
+
+extern bool_t	ordo_add_game (struct ordo_ctx *ctx, const char *white, const char *black, int result);
+
+// games appended to the file of ordo_load_follow since the last read, -1 on error
+extern gamesnum_t ordo_follow_read (struct ordo_ctx *ctx);
+
+// Rebuilds games, players and priors from the loaded database without
+// parsing it again, then continues as ordo_priors. The solver starts from the
+// previous solution, so the work of the next ordo_solve depends on the change.
+extern bool_t	ordo_rebuild (struct ordo_ctx *ctx);
+
+extern bool_t	ordo_priors (struct ordo_ctx *ctx);		// seeds, anchors and relations from cfg
+extern bool_t	ordo_groups (struct ordo_ctx *ctx, player_t *groups_n); // connected by all games, optional
+extern bool_t	ordo_transform (struct ordo_ctx *ctx);	// purges players that cannot be rated
+
+// after ordo_priors, ratings by index of ctx->pdaba (HUGE_VAL if unknown), and
+// white advantage and draw rate if they are adjusted, as a starting point
+extern void		ordo_warm_start (struct ordo_ctx *ctx, const double *rating, player_t n, double wa, double dr);
+extern bool_t	ordo_solve (struct ordo_ctx *ctx);
+
+// returns the number of simulations performed
+extern long		ordo_simulate	( struct ordo_ctx *ctx
+								, thpool_t *pool
+								, long n
+								, const struct SIMCTRL *simctrl
+								, bool_t sim_updates);
+
+// results
+extern player_t		ordo_players_n (const struct ordo_ctx *ctx);
+extern const char *	ordo_name (const struct ordo_ctx *ctx, player_t j);
+extern double		ordo_rating (const struct ordo_ctx *ctx, player_t j);
+extern double		ordo_error (const struct ordo_ctx *ctx, player_t j); // sdev, 0 without simulations
+extern double		ordo_white_advantage (const struct ordo_ctx *ctx);
+extern double		ordo_drawrate (const struct ordo_ctx *ctx);
+extern const char *	ordo_errmsg (const struct ordo_ctx *ctx);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
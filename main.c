@@ -59,8 +59,13 @@
 #include "summations.h"
 #include "myopt.h"
 #include "sysport/sysport.h"
+#include "libordo.h"
+#include "server.h"
+#include "batch.h"
+#include "window.h"
 
 #include "mytimer.h"
+#include "stats.h"
 
 /*
 |
@@ -130,6 +135,13 @@ struct helpline SH[] = {
 {'\0',	"silent",		no_argument,		NULL,		0,	"same as --quiet"},
 {'Q',	"terse",		no_argument,		NULL,		0,	"same as --quiet, but shows simulation counter"},
 {'\0',	"timelog",		no_argument,		NULL,		0,	"outputs elapsed time after each step"},
+{'\0',	"profile",		required_argument,	"FILE",		0,	"saves the wall time of each phase in FILE (JSON if FILE ends with .json, CSV otherwise)"},
+{'\0',	"init",			required_argument,	"MODE",		0,	"starting ratings: flat (default) or online (one pass of Elo updates)"},
+{'\0',	"approx",		required_argument,	"NUM",		0,	"approximate ratings from NUM epochs of minibatch steps, for very large databases"},
+{'\0',	"approx-batch",	required_argument,	"NUM",		0,	"encounters per minibatch of --approx (default=4096)"},
+{'\0',	"approx-exact",	required_argument,	"NUM",		0,	"full-batch iterations that refine the result of --approx (default=0)"},
+{'\0',	"stats",		no_argument,		NULL,		0,	"outputs counters of solver evaluations, simulations and lock waits"},
+{'\0',	"stats-json",	required_argument,	"FILE",		0,	"saves the counters of --stats in FILE (JSON format)"},
 {'a',	"average",		required_argument,	"NUM",		0,	"set rating for the pool average"},
 {'A',	"anchor",		required_argument,	"<player>",	0,	"anchor: rating given by '-a' is fixed for <player>"},
 {'V',	"pool-relative",no_argument,		NULL,		0,	"errors relative to pool average, not to the anchor"},
@@ -154,6 +166,15 @@ struct helpline SH[] = {
 {'g',	"groups",		required_argument,	"FILE",		0,	"outputs group connection info (no rating output)"},
 {'G',	"force",		no_argument,		NULL,		0,	"force program to run ignoring isolated-groups warning"},
 {'s',	"simulations",	required_argument,	"NUM",		0,	"perform NUM simulations to calculate errors"},
+{'\0',	"sim-precision",required_argument,	"NUM",		0,	"stop simulations (up to -s NUM) when errors are estimated with a relative precision of NUM %"},
+{'\0',	"sim-top",		required_argument,	"NUM",		0,	"--sim-precision is only required for the top NUM players"},
+{'\0',	"sim-seed",		required_argument,	"NUM",		0,	"seed for the random numbers used in simulations"},
+{'\0',	"sim-shard",	required_argument,	"<k/n>",	0,	"perform only part k out of n of the simulations (use of --sim-save required)"},
+{'\0',	"sim-save",		required_argument,	"FILE",		0,	"save the simulation accumulators in FILE (binary)"},
+{'\0',	"sim-merge",	required_argument,	"FILE",		0,	"use the accumulators saved in FILE instead of simulating (repeat for each file)"},
+{'\0',	"checkpoint",	required_argument,	"FILE",		0,	"save the progress of the simulations periodically in FILE"},
+{'\0',	"checkpoint-every",required_argument,"NUM",		0,	"seconds between checkpoints (default=60)"},
+{'\0',	"resume",		no_argument,		NULL,		0,	"continue the simulations saved by --checkpoint"},
 {'e',	"error-matrix",	required_argument,	"FILE",		0,	"save an error matrix (use of -s required)"},
 {'C',	"cfs-matrix",	required_argument,	"FILE",		0,	"save a matrix (comma separated value .csv) with confidence for superiority (-s was used)"},
 {'J',	"cfs-show",		no_argument,		NULL,		0,	"output an extra column with confidence for superiority (relative to the player in the next row)"},
@@ -163,6 +184,17 @@ struct helpline SH[] = {
 {'N',	"decimals",		required_argument,	"<a,b>",	0,	"a=rating decimals, b=score decimals (optional)"},
 {'M',	"ML",			no_argument,		NULL,		0,	"force maximum-likelihood estimation to obtain ratings"},
 {'n',	"cpus",			required_argument,	"NUM",		0,	"number of processors used in simulations"},
+{'\0',	"affinity",		no_argument,		NULL,		0,	"bind each thread used by -n to one processor"},
+{'\0',	"numa",			no_argument,		NULL,		0,	"spread simulation threads over NUMA nodes, with a copy of the games on each"},
+{'\0',	"tmpdir",		required_argument,	"DIR",		0,	"games are sorted into encounters in DIR while reading, for databases larger than memory"},
+{'\0',	"follow",		no_argument,		NULL,		0,	"keep reading games appended to the input file, updating the output"},
+{'\0',	"follow-every",	required_argument,	"NUM",		0,	"seconds between updates of --follow (default=10)"},
+{'\0',	"window",		required_argument,	"NUM",		0,	"ratings of every NUM games in input order (or months, see --window-months) to -c"},
+{'\0',	"window-step",	required_argument,	"NUM",		0,	"the next window ends NUM games or months later (default=size of the window)"},
+{'\0',	"window-months",no_argument,		NULL,		0,	"windows measured in months, games ordered by their Date tag"},
+{'\0',	"batch",		required_argument,	"FILE",		0,	"one rating calculation per line of FILE, each with its own switches (see manual)"},
+{'\0',	"server",		no_argument,		NULL,		0,	"keep the games in memory and answer commands from stdin (see manual)"},
+{'\0',	"socket",		required_argument,	"FILE",		0,	"same as --server, but commands come from clients of UNIX socket FILE"},
 {'U',	"columns",		required_argument,	"<a,..,z>",	0,	"info in output (default columns are \"0,1,2,3,4,5\")"},
 {'Y',	"synonyms",		required_argument,	"FILE",		0,	"name synonyms (comma separated value format). Each line: main,syn1,syn2 or \"main\",\"syn1\",\"syn2\""},
 {'\0',	"aliases",		required_argument,	"FILE",		0,	"same as --synonyms FILE"},
@@ -185,7 +217,6 @@ struct helpline SH[] = {
 
 enum 			AnchorSZ	{MAX_ANCHORSIZE=1024};
 static bool_t	Anchor_use = FALSE;
-static player_t	Anchor = 0;
 static char		Anchor_name[MAX_ANCHORSIZE] = "";
 
 static bool_t	Anchor_err_rel2avg = FALSE;
@@ -196,20 +227,24 @@ static double	Confidence = 95;
 static double	General_average = 2300.0;
 
 static long 	Simulate = 0;
-
-#define INVBETA 175.25
+static double	Sim_precision = 0;	// relative, 0 if not used
+static long		Sim_top = 0;
+static long		Sim_seed = 1324561;
+static long		Sim_shard_k = 0;
+static long		Sim_shard_n = 1;
+static long		Checkpoint_every = 60;
+static bool_t	Follow = FALSE;
+static const char *Tmpdir = NULL;
+static long		Follow_every = 10;
 
 static double	White_advantage = 0;
 static double	White_advantage_SD = 0;
 static double	Rtng_76 = 202;
-static double	BETA = 1.0/INVBETA;
 static double	Confidence_factor = 1.0;
 
 static int		OUTDECIMALS = 1; //FIXME Replace by decimals array
 static bool_t	Decimals_set = FALSE;
 
-static struct GAMESTATS	Game_stats;
-
 static double 	Drawrate_evenmatch = STANDARD_DRAWRATE; //default
 static double 	Drawrate_evenmatch_percent = 100*STANDARD_DRAWRATE; //default
 static double 	Drawrate_evenmatch_percent_SD = 0;
@@ -219,20 +254,22 @@ static double 	Drawrate_evenmatch_percent_SD = 0;
 static struct prior Wa_prior = {40.0,20.0,FALSE};
 static struct prior Dr_prior = { 0.5, 0.1,FALSE};
 
-static struct prior *PP;		// to be dynamically assigned
-static struct prior *PP_store; 	// to be dynamically assigned
-
-static struct rel_prior_set		RPset = {0, NULL};
-static struct rel_prior_set		RPset_store = {0, NULL};;
-
 static bool_t 	Hide_old_ver = FALSE;
-static bool_t	Prior_mode;
 
 /*---- static functions --------------------------------------------------*/
 
 static void 		table_output(double Rtng_76);
-
-static int 			compare_GAME (const void * a, const void * b);
+static void			init_online_saved (const struct ordo_ctx *ctx);
+
+static bool_t		reports_atomic	( const char *textstr
+									, const char *csvstr
+									, struct ordo_ctx *ctx
+									, long simulate
+									, int decimals
+									, int decimals_score
+									, struct output_qualifiers outqual
+									, bool_t cfs_column
+									, int *columns);
 
 static char *skipblanks(char *p) {while (isspace(*p)) p++; return p;}
 
@@ -290,14 +327,8 @@ int main (int argc, char *argv[])
 {
 	enum mainlimits {INPUTMAX=1024, COLSMAX=256, DECMAX=2};
 
-	struct summations sfe; // summations for errors
-
-	struct DATA *pdaba;
-
-	struct GAMES 		Games;
-	struct PLAYERS 		Players;
-	struct RATINGS 		RA;
-	struct ENCOUNTERS 	Encounters;
+	struct ordo_config cfg;
+	struct ordo_ctx *ctx;
 
 	double white_advantage_result;
 	double drawrate_evenmatch_result;
@@ -343,6 +374,24 @@ int main (int argc, char *argv[])
 	strlist_t SL;
 	strlist_t *psl = &SL;
 
+	strlist_t SimMergeL;
+	bool_t sim_merge = FALSE;
+	const char *simsavestr = NULL;
+	const char *checkpointstr = NULL;
+	bool_t resume = FALSE;
+	bool_t affinity = FALSE;
+	bool_t numa = FALSE;
+	bool_t server_mode = FALSE;
+	const char *batchstr = NULL;
+	bool_t init_online = FALSE;
+	bool_t stats_on = FALSE;
+	struct WINDOWCTRL window_ctrl = {WINDOW_GAMES, 0, 0, 0, 0, 1};
+	struct APPROXCTRL approx_ctrl = {0, 4096, 0};
+	const char *socketstr = NULL;
+	thpool_t *pool = NULL;
+	struct SIMCTRL simctrl;
+	long sim_max_follow = 0;
+
 	group_var_t *gv = NULL;
 
 	/* defaults */
@@ -385,6 +434,7 @@ int main (int argc, char *argv[])
 	TIMELOG = FALSE;
 
 	strlist_init(psl);
+	strlist_init(&SimMergeL);
 
 
 
@@ -408,6 +458,109 @@ int main (int argc, char *argv[])
 							dowarning = FALSE;
 						} else if (!strcmp(long_options[longoidx].name, "timelog")) {
 							TIMELOG = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "profile")) {
+							profile_output (opt_arg);
+						} else if (!strcmp(long_options[longoidx].name, "init")) {
+							if (!strcmp(opt_arg, "online")) {
+								init_online = TRUE;
+							} else if (!strcmp(opt_arg, "flat")) {
+								init_online = FALSE;
+							} else {
+								fprintf(stderr, "wrong init parameter, it should be flat or online\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "approx")) {
+							if (1 != sscanf(opt_arg,"%ld", &approx_ctrl.epochs) || approx_ctrl.epochs < 1) {
+								fprintf(stderr, "wrong approx parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "approx-batch")) {
+							if (1 != sscanf(opt_arg,"%ld", &approx_ctrl.batch) || approx_ctrl.batch < 1) {
+								fprintf(stderr, "wrong approx batch parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "approx-exact")) {
+							if (1 != sscanf(opt_arg,"%d", &approx_ctrl.exact) || approx_ctrl.exact < 0) {
+								fprintf(stderr, "wrong approx exact parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "stats")) {
+							stats_on = TRUE;
+							stats_output (TRUE, NULL);
+						} else if (!strcmp(long_options[longoidx].name, "stats-json")) {
+							stats_output (FALSE, opt_arg);
+						} else if (!strcmp(long_options[longoidx].name, "sim-precision")) {
+							if (1 != sscanf(opt_arg,"%lf", &Sim_precision) || !(Sim_precision > 0)) {
+								fprintf(stderr, "wrong simulation precision parameter\n");
+								exit(EXIT_FAILURE);
+							}
+							Sim_precision /= 100.0;
+						} else if (!strcmp(long_options[longoidx].name, "sim-top")) {
+							if (1 != sscanf(opt_arg,"%ld", &Sim_top) || Sim_top < 1) {
+								fprintf(stderr, "wrong simulation top parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "sim-seed")) {
+							if (1 != sscanf(opt_arg,"%ld", &Sim_seed)) {
+								fprintf(stderr, "wrong simulation seed parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "sim-shard")) {
+							if (2 != sscanf(opt_arg,"%ld/%ld", &Sim_shard_k, &Sim_shard_n) 
+								|| Sim_shard_n < 1 || Sim_shard_k < 1 || Sim_shard_k > Sim_shard_n) {
+								fprintf(stderr, "wrong simulation shard parameter, it should be <k/n>\n");
+								exit(EXIT_FAILURE);
+							}
+							Sim_shard_k--;
+						} else if (!strcmp(long_options[longoidx].name, "checkpoint")) {
+							checkpointstr = opt_arg;
+						} else if (!strcmp(long_options[longoidx].name, "checkpoint-every")) {
+							if (1 != sscanf(opt_arg,"%ld", &Checkpoint_every) || Checkpoint_every < 0) {
+								fprintf(stderr, "wrong checkpoint interval parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "resume")) {
+							resume = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "affinity")) {
+							affinity = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "numa")) {
+							numa = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "follow")) {
+							Follow = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "follow-every")) {
+							if (1 != sscanf(opt_arg,"%ld", &Follow_every) || Follow_every < 1) {
+								fprintf(stderr, "wrong follow interval parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "window")) {
+							if (1 != sscanf(opt_arg,"%ld", &window_ctrl.size) || window_ctrl.size < 1) {
+								fprintf(stderr, "wrong window parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "window-step")) {
+							if (1 != sscanf(opt_arg,"%ld", &window_ctrl.step) || window_ctrl.step < 1) {
+								fprintf(stderr, "wrong window step parameter\n");
+								exit(EXIT_FAILURE);
+							}
+						} else if (!strcmp(long_options[longoidx].name, "tmpdir")) {
+							Tmpdir = opt_arg;
+						} else if (!strcmp(long_options[longoidx].name, "window-months")) {
+							window_ctrl.unit = WINDOW_MONTHS;
+						} else if (!strcmp(long_options[longoidx].name, "batch")) {
+							batchstr = opt_arg;
+						} else if (!strcmp(long_options[longoidx].name, "server")) {
+							server_mode = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "socket")) {
+							socketstr = opt_arg;
+							server_mode = TRUE;
+						} else if (!strcmp(long_options[longoidx].name, "sim-save")) {
+							simsavestr = opt_arg;
+						} else if (!strcmp(long_options[longoidx].name, "sim-merge")) {
+							if (!strlist_push(&SimMergeL, opt_arg)) {
+								fprintf (stderr, "Lack of memory\n\n");
+								exit(EXIT_FAILURE);		
+							}
+							sim_merge = TRUE;
 						} else {
 							fprintf (stderr, "ERROR: %d\n", op);
 							exit(EXIT_FAILURE);
@@ -671,6 +824,42 @@ int main (int argc, char *argv[])
 		fprintf (stderr, "Setting a general average (-a) or a single anchor (-A) is incompatible with multiple anchors (-m)\n\n");
 		exit(EXIT_FAILURE);
 	}
+	if ((Sim_precision > 0 || Sim_top > 0) && Simulate < 2) {
+		fprintf (stderr, "Switches --sim-precision and --sim-top need -s to set the maximum number of simulations\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (Sim_shard_n > 1 && (NULL == simsavestr || Simulate < 2)) {
+		fprintf (stderr, "Switch --sim-shard needs -s (total number of simulations) and --sim-save\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (Sim_precision > 0 && (Sim_shard_n > 1 || sim_merge)) {
+		fprintf (stderr, "Switch --sim-precision cannot be used with --sim-shard or --sim-merge\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((resume || NULL != checkpointstr) && (Simulate < 2 || (resume && NULL == checkpointstr))) {
+		fprintf (stderr, "Switch --checkpoint needs -s, and --resume needs --checkpoint\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (window_ctrl.size > 0 && (Sim_shard_n > 1 || sim_merge || NULL != checkpointstr || group_is_output || server_mode || Follow || NULL != batchstr)) {
+		fprintf (stderr, "Switch --window cannot be used with -g, --sim-shard, --sim-merge, --checkpoint, --server, --follow or --batch\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (window_ctrl.size == 0 && (window_ctrl.step > 0 || window_ctrl.unit == WINDOW_MONTHS)) {
+		fprintf (stderr, "Switches --window-step and --window-months need --window\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (NULL != batchstr && (Sim_shard_n > 1 || sim_merge || NULL != checkpointstr || group_is_output || server_mode || Follow)) {
+		fprintf (stderr, "Switch --batch cannot be used with -g, --sim-shard, --sim-merge, --checkpoint, --server or --follow\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (Follow && (1 != strlist_count(psl) || Sim_shard_n > 1 || sim_merge || NULL != checkpointstr || group_is_output || server_mode)) {
+		fprintf (stderr, "Switch --follow needs one input file, and cannot be used with -g, --sim-shard, --sim-merge, --checkpoint or --server\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (sim_merge && (Simulate > 0 || Sim_shard_n > 1 || NULL != simsavestr)) {
+		fprintf (stderr, "Switch --sim-merge cannot be used with -s, --sim-shard or --sim-save\n\n");
+		exit(EXIT_FAILURE);
+	}
 	if ((switch_w || switch_u) && switch_W) {
 		fprintf (stderr, "Switches -w/-u and -W are incompatible and will not work simultaneously\n\n");
 		exit(EXIT_FAILURE);
@@ -679,6 +868,18 @@ int main (int argc, char *argv[])
 		fprintf (stderr, "Switches -d/-k and -D are incompatible and will not work simultaneously\n\n");
 		exit(EXIT_FAILURE);
 	}
+	if (NULL != Tmpdir && (NULL != includes_str || NULL != excludes_str || NULL != head2head_str || init_online || Follow || NULL != batchstr || window_ctrl.size > 0 || server_mode)) {
+		fprintf (stderr, "Switch --tmpdir cannot be used with -i, -x, -j, --init online, --follow, --batch, --window or --server\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (approx_ctrl.epochs > 0 && (switch_u || switch_k || Forces_ML || NULL != priorsstr || NULL != relstr)) {
+		fprintf (stderr, "Switch --approx cannot be used with -u, -k, -M, -y or -r\n\n");
+		exit(EXIT_FAILURE);
+	}
+	if (approx_ctrl.epochs == 0 && (approx_ctrl.batch != 4096 || approx_ctrl.exact > 0)) {
+		fprintf (stderr, "Switches --approx-batch and --approx-exact need --approx\n\n");
+		exit(EXIT_FAILURE);
+	}
 	if (NULL != priorsstr && General_average_set) {
 		fprintf (stderr, "Setting a general average (-a) is incompatible with having a file with rating seeds (-y)\n\n");
 		exit(EXIT_FAILURE);
@@ -692,15 +893,65 @@ int main (int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}	
 
-	Prior_mode = switch_k || switch_u || NULL != relstr || NULL != priorsstr;
+	/*==== configuration of the rating job ====*/
+
+	ordo_config_default (&cfg);
+	cfg.quiet					= quiet_mode;
+	cfg.force_ml				= Forces_ML;
+	cfg.prior_mode				= switch_k || switch_u;
+	cfg.anchor_err_rel2avg		= Anchor_err_rel2avg;
+	cfg.anchor_name				= Anchor_use? Anchor_name: NULL;
+	cfg.general_average			= General_average;
+	cfg.white_advantage			= White_advantage;
+	cfg.drawrate				= Drawrate_evenmatch;
+	cfg.rtng_76					= Rtng_76;
+	cfg.init_online				= init_online;
+	cfg.approx					= approx_ctrl;
+	cfg.tmpdir					= Tmpdir;
+	cfg.ignore_draws			= Ignore_draws;
+	cfg.synonyms				= synstr;
+	cfg.includes				= includes_str;
+	cfg.excludes				= excludes_str;
+	cfg.name_warnings			= dowarning;
+	cfg.loose_anchors			= priorsstr;
+	cfg.multi_anchors			= pinsstr;
+	cfg.relations				= relstr;
+	cfg.groupcheck				= groupcheck;
 
-	/*==== mem init ====*/
+	// process draw and white adv. switches
+	if (switch_w && switch_u) {
+		if (White_advantage_SD > PRIOR_SMALLEST_SIGMA) {
+			Wa_prior.isset = TRUE; 
+			Wa_prior.value = White_advantage; 
+			Wa_prior.sigma = White_advantage_SD; 
+			adjust_white_advantage = TRUE;	
+		} else {
+			Wa_prior.isset = FALSE; 
+			Wa_prior.value = White_advantage; 
+			Wa_prior.sigma = White_advantage_SD; 
+			adjust_white_advantage = FALSE;	
+		}
+	}
 
-	if (!name_storage_init()) {
-		fprintf (stderr, "Problem initializing buffers for reading names, probably lack of memory.\n");	
-		exit(EXIT_FAILURE);
+	if (switch_d && switch_k) {
+		if (Drawrate_evenmatch_percent_SD > PRIOR_SMALLEST_SIGMA) {
+			Dr_prior.isset = TRUE; 
+			Dr_prior.value = Drawrate_evenmatch_percent/100.0; 
+			Dr_prior.sigma = Drawrate_evenmatch_percent_SD/100.0;  
+			adjust_draw_rate = TRUE;	
+		} else {
+			Dr_prior.isset = FALSE; 
+			Dr_prior.value = Drawrate_evenmatch_percent/100.0;  
+			Dr_prior.sigma = Drawrate_evenmatch_percent_SD/100.0;  
+			adjust_draw_rate = FALSE;	
+		}
 	}
 
+	cfg.wa_prior				= Wa_prior;
+	cfg.dr_prior				= Dr_prior;
+	cfg.adjust_white_advantage	= adjust_white_advantage;
+	cfg.adjust_draw_rate		= adjust_draw_rate;
+
 	/*==== report init ====*/
 
 	if (!report_columns_init()) {
@@ -715,150 +966,46 @@ int main (int argc, char *argv[])
 
 	timer_reset();
 	timelog("start");
-	timelog("input...");
+	phase_begin("input");
 
-	if (NULL != (pdaba = database_init_frompgn (psl, synstr, quiet_mode))) {
-		if (0 == pdaba->n_players || 0 == pdaba->n_games) {
-			fprintf (stderr, "ERROR: Input file contains no games\n");
-			return EXIT_FAILURE; 			
-		}
-		if (Ignore_draws) database_ignore_draws(pdaba);
+	ordo_init();
 
-		if (NULL != includes_str) {
-			bitarray_t ba;
-			if (ba_init (&ba,pdaba->n_players)) {
-				namelist_to_bitarray (quiet_mode, dowarning, includes_str, pdaba, &ba);
-				database_include_only(pdaba, &ba);
-			} else {
-				fprintf (stderr, "ERROR\n");
-				exit(EXIT_FAILURE);
-			}
-		}
-		if (NULL != excludes_str) {
-			bitarray_t ba;
-			if (ba_init (&ba,pdaba->n_players)) {
-				namelist_to_bitarray (quiet_mode, dowarning, excludes_str, pdaba, &ba);
-				ba_setnot(&ba);
-				database_include_only(pdaba, &ba);
-			} else {
-				fprintf (stderr, "ERROR\n");
-				exit(EXIT_FAILURE);
-			}
-		}
-
-	} else {
-		fprintf (stderr, "Problems reading results\n");
-		return EXIT_FAILURE; 
-	}
-
-	strlist_done(psl); // string list not used anymore from this point on
-
-	/*==== memory initialization ====*/
-	{
-		player_t mpr 	= pdaba->n_players; 
-		player_t mpp 	= pdaba->n_players; 
-		gamesnum_t mg  	= pdaba->n_games;
-		gamesnum_t me  	= pdaba->n_games;
-
-		if (!ratings_init (mpr, &RA)) {
-			fprintf (stderr, "Could not initialize rating memory\n"); exit(EXIT_FAILURE);	
-		} else 
-		if (!games_init (mg, &Games)) {
-			ratings_done (&RA);
-			fprintf (stderr, "Could not initialize Games memory\n"); exit(EXIT_FAILURE);
-		} else 
-		if (!encounters_init (me, &Encounters)) {
-			ratings_done (&RA);
-			games_done (&Games);
-			fprintf (stderr, "Could not initialize Encounters memory\n"); exit(EXIT_FAILURE);
-		} else 
-		if (!players_init (mpp, &Players)) {
-			ratings_done (&RA);
-			games_done (&Games);
-			encounters_done (&Encounters);
-			fprintf (stderr, "Could not initialize Players memory\n"); exit(EXIT_FAILURE);
-		} 
-	}
-	assert(players_have_clear_flags(&Players));
-
-	/*==== data translation ====*/
-
-	database_transform (pdaba, &Games, &Players, &Game_stats); /* convert database to global variables */
-	if (0 == Games.n) {
-		fprintf (stderr, "ERROR: Input file contains no games\n");
-		return EXIT_FAILURE; 			
-	}
-	qsort (Games.ga, (size_t)Games.n, sizeof(struct gamei), compare_GAME);
-
-	/*==== more memory initialization ====*/
-
-	if (!supporting_auxmem_init (Players.n, &PP, &PP_store)) {
-		ratings_done (&RA);
-		games_done (&Games);
-		encounters_done (&Encounters);
-		players_done(&Players);
-		fprintf (stderr, "Could not initialize auxiliary Players memory\n"); exit(EXIT_FAILURE);
-	}
-
-	/*==== process anchor ====*/
-
-	if (Anchor_use) {
-		player_t anch_idx;
-		if (players_name2idx(&Players, Anchor_name, &anch_idx)) {
-			Anchor = anch_idx;
-			anchor_j (anch_idx, General_average, &RA, &Players);
-		} else {
-			fprintf (stderr, "ERROR: No games of anchor player, mispelled, wrong capital letters, or extra spaces = \"%s\"\n", Anchor_name);
-			fprintf (stderr, "Surround the name with \"quotes\" if it contains spaces\n\n");
-			return EXIT_FAILURE; 			
-		} 
-	}
-
-	/*==== more wrong input ====*/
-
-	if (Drawrate_evenmatch < 0.0 || Drawrate_evenmatch > 1.0) {
-		fprintf (stderr, "ERROR: Invalide draw rate set\n");
-		return EXIT_FAILURE; 		
+	if (NULL == (ctx = ordo_new (&cfg))) {
+		fprintf (stderr, "Lack of memory\n");
+		exit(EXIT_FAILURE);
 	}
 
-	if (!(Drawrate_evenmatch > 0.0) && Game_stats.draws > 0 && Prior_mode) {
-		fprintf (stderr, "ERROR: Draws present in the database but -d switch specified an invalid number\n");
-		return EXIT_FAILURE; 
+	// worker threads, the main thread is one more. Games are sorted with them too
+	if (cpus > 1) {
+		if (NULL == (pool = thpool_new (cpus - 1, affinity))) {
+			fprintf (stderr, "Threads for the simulations could not be started\n");
+			exit(EXIT_FAILURE);
+		}
+		ordo_use_pool (ctx, pool);
 	}
 
-	if (Drawrate_evenmatch > 0.999) {
-		fprintf (stderr, "ERROR: Draw rate set with -d switch is too high, > 99.9%s\n", "%");
+	strlist_rwnd(psl);
+	if (Follow? !ordo_load_follow (ctx, strlist_next(psl)): !ordo_load_pgn (ctx, psl)) {
+		fprintf (stderr, "%s", ordo_errmsg(ctx));
 		return EXIT_FAILURE; 
 	}
 
-	#if 0
-	// to ignore a given player --> test_player
-	// here, set:
-	// Players.flagged[test_player] = TRUE;
-	// Players.present_in_games[test_player] = FALSE;
-	#endif
-
-	assert(players_have_clear_flags(&Players));
-	encounters_calculate(ENCOUNTERS_FULL, &Games, Players.flagged, &Encounters);
-
-	if (0 == Encounters.n) {
-		fprintf (stderr, "ERROR: Input file contains no games to process\n");
-		return EXIT_FAILURE; 			
-	}
+	strlist_done(psl); // string list not used anymore from this point on
 
 	/*==== report, input checked ====*/
 
 	if (!quiet_mode) {
+		const struct GAMESTATS *gs = &ctx->game_stats;
 		printf ("Total games            %8ld\n",(long)
-											 (Game_stats.white_wins
-											 +Game_stats.draws
-											 +Game_stats.black_wins
-											 +Game_stats.noresult));
-		printf (" - White wins          %8ld\n", (long) Game_stats.white_wins);
-		printf (" - Draws               %8ld\n", (long) Game_stats.draws);
-		printf (" - Black wins          %8ld\n", (long) Game_stats.black_wins);
-		printf (" - Truncated/Discarded %8ld\n", (long) Game_stats.noresult);
-		printf ("Unique head to head    %8.2f%s\n", 100.0*(double)Encounters.n/(double)Games.n, "%");
+											 (gs->white_wins
+											 +gs->draws
+											 +gs->black_wins
+											 +gs->noresult));
+		printf (" - White wins          %8ld\n", (long) gs->white_wins);
+		printf (" - Draws               %8ld\n", (long) gs->draws);
+		printf (" - Black wins          %8ld\n", (long) gs->black_wins);
+		printf (" - Truncated/Discarded %8ld\n", (long) gs->noresult);
+		printf ("Unique head to head    %8.2f%s\n", 100.0*(double)ctx->encounters.n/(double)ctx->pdaba->n_games, "%");
 		if (Anchor_use) {
 			printf ("Reference rating    %8.1lf",General_average);
 			printf (" (set to \"%s\")\n", Anchor_name);
@@ -876,58 +1023,121 @@ int main (int argc, char *argv[])
 
 	Confidence_factor = confidence2x(Confidence/100.0);
 
-	ratings_starting_point (Players.n, General_average, &RA);
-
-	// priors
-	priors_reset (PP, Players.n);
-	if (priorsstr != NULL) {
-		priors_load (quiet_mode, priorsstr, &RA, &Players, PP);
+	if (!ordo_priors (ctx)) {
+		fprintf (stderr, "%s", ordo_errmsg(ctx));
+		exit(EXIT_FAILURE);
 	}
 
-	// multiple anchors here
-	if (pinsstr != NULL) {
-		init_manchors (quiet_mode, pinsstr, &RA, &Players); 
-	}
+	simctrl.target_relerr	= Sim_precision;
+	simctrl.target_topk		= (player_t)Sim_top;
+	simctrl.seed			= (uint32_t)Sim_seed;
+	simctrl.shard_k			= Sim_shard_k;
+	simctrl.shard_n			= Sim_shard_n;
+	simctrl.save_file		= simsavestr;
+	simctrl.merge			= sim_merge? &SimMergeL: NULL;
+	simctrl.checkpoint_file	= checkpointstr;
+	simctrl.checkpoint_every= Checkpoint_every;
+	simctrl.resume			= resume;
+	simctrl.numa			= numa;
 
-	// relative priors
-	if (relstr != NULL) {
-		relpriors_init (quiet_mode, &Players, relstr, &RPset, &RPset_store); 
-	}
+	if (server_mode) {
 
-	// show priored information
-	if (!quiet_mode) {
-		priors_show(&Players, PP, Players.n);
-		relpriors_show(&Players, &RPset);
-		players_set_priored_info (PP, &RPset, &Players);
+		phase_end(); // input
+
+		if (pool == NULL && NULL == (pool = thpool_new (cpus - 1, affinity))) {
+			fprintf (stderr, "Threads for the simulations could not be started\n");
+			exit(EXIT_FAILURE);
+		}
+		if (socketstr == NULL) {
+			server_stdio (ctx, pool, (uint32_t)Sim_seed);
+		} else if (!server_socket (ctx, pool, (uint32_t)Sim_seed, socketstr)) {
+			fprintf (stderr, "Socket \"%s\" could not be opened\n", socketstr);
+			exit(EXIT_FAILURE);
+		}
+
+		thpool_kill (pool);
+		ordo_free (ctx);
+		ordo_done ();
+		report_columns_done();
+		return EXIT_SUCCESS;
 	}
 
-	// process draw and white adv. switches
-	if (switch_w && switch_u) {
-		if (White_advantage_SD > PRIOR_SMALLEST_SIGMA) {
-			Wa_prior.isset = TRUE; 
-			Wa_prior.value = White_advantage; 
-			Wa_prior.sigma = White_advantage_SD; 
-			adjust_white_advantage = TRUE;	
-		} else {
-			Wa_prior.isset = FALSE; 
-			Wa_prior.value = White_advantage; 
-			Wa_prior.sigma = White_advantage_SD; 
-			adjust_white_advantage = FALSE;	
+	if (batchstr != NULL) {
+		struct BATCH batch;
+		bool_t ok;
+		size_t i;
+
+		phase_end(); // input
+
+		batch_load (batchstr, &cfg, Simulate, &batch);
+
+		if (pool == NULL && NULL == (pool = thpool_new (cpus - 1, affinity))) {
+			fprintf (stderr, "Threads for the simulations could not be started\n");
+			exit(EXIT_FAILURE);
 		}
+
+		phase_begin("batch");
+		ok = batch_solve (&batch, ctx, pool, &simctrl);
+		phase_end();
+
+		phase_begin("reports");
+		for (i = 0; i < batch.n; i++) {
+			struct BATCHJOB *job = &batch.job[i];
+			if (!job->ok) {
+				fprintf (stderr, "Batch file \"%s\", line %ld:\n%s", batchstr, job->line_n, ordo_errmsg(job->ctx));
+				continue;
+			}
+			if (!reports_atomic	( job->textstr, job->csvstr, job->ctx, job->simulate
+								, decimals_array_n > 0? decimals_array[0]: 1
+								, decimals_array_n > 1? decimals_array[1]: 1
+								, outqual, cfs_column, columns)) {
+				fprintf (stderr, "Errors writing the output of line %ld\n", job->line_n);
+				ok = FALSE;
+			}
+		}
+		phase_end();
+
+		if (!quiet_mode)
+			printf ("\nBatch configurations: %lu\n", (unsigned long)batch.n);
+
+		batch_done (&batch);
+		thpool_kill (pool);
+		ordo_free (ctx);
+		ordo_done ();
+		report_columns_done();
+		return ok? EXIT_SUCCESS: EXIT_FAILURE;
 	}
 
-	if (switch_d && switch_k) {
-		if (Drawrate_evenmatch_percent_SD > PRIOR_SMALLEST_SIGMA) {
-			Dr_prior.isset = TRUE; 
-			Dr_prior.value = Drawrate_evenmatch_percent/100.0; 
-			Dr_prior.sigma = Drawrate_evenmatch_percent_SD/100.0;  
-			adjust_draw_rate = TRUE;	
-		} else {
-			Dr_prior.isset = FALSE; 
-			Dr_prior.value = Drawrate_evenmatch_percent/100.0;  
-			Dr_prior.sigma = Drawrate_evenmatch_percent_SD/100.0;  
-			adjust_draw_rate = FALSE;	
+	if (window_ctrl.size > 0) {
+		bool_t ok;
+
+		phase_end(); // input
+
+		if (window_ctrl.step == 0) window_ctrl.step = window_ctrl.size;
+		window_ctrl.simulate = Simulate;
+		window_ctrl.seed = (uint32_t)Sim_seed;
+		window_ctrl.decimals = decimals_array_n > 0? decimals_array[0]: 1;
+
+		csvf = stdout;
+		if (csvstr != NULL && NULL == (csvf = fopen (csvstr, "w"))) {
+			fprintf(stderr, "Errors with file: %s\n",csvstr);
+			exit(EXIT_FAILURE);
+		}
+		if (pool == NULL && NULL == (pool = thpool_new (cpus - 1, affinity))) {
+			fprintf (stderr, "Threads for the simulations could not be started\n");
+			exit(EXIT_FAILURE);
 		}
+
+		phase_begin("windows");
+		ok = window_run (ctx, pool, &window_ctrl, csvf);
+		phase_end();
+
+		if (csvf != stdout) fclose (csvf);
+		thpool_kill (pool);
+		ordo_free (ctx);
+		ordo_done ();
+		report_columns_done();
+		return ok? EXIT_SUCCESS: EXIT_FAILURE;
 	}
 
 	// open files
@@ -969,50 +1179,37 @@ int main (int argc, char *argv[])
 		}
 	}
 
-	/*
-	|  BEGIN...
-	\*----------------------------------*/
-
-	mythread_mutex_init		(&Smpcount);
-	mythread_mutex_init		(&Groupmtx);
-	mythread_mutex_init		(&Summamtx);
-	mythread_mutex_init		(&Printmtx);
-
-	randfast_init (1324561);
-
-	BETA = (-log(1.0/0.76-1.0)) / Rtng_76;
-
-	summations_init(&sfe);
-
-	timelog("done with input");
-	timelog("process groups if needed...");
+	phase_end(); // input
 
 	/*===== groups ========*/
 
-	gv = NULL;
+	phase_begin("groups");
 
-	assert(players_have_clear_flags (&Players));
-	encounters_calculate (ENCOUNTERS_FULL, &Games, Players.flagged, &Encounters);
+	gv = NULL;
 
-	if (group_is_output || groupcheck) {
-		timelog("processing groups...");
-		if (NULL == (gv = GV_make (&Encounters, &Players))) {
+	if (group_is_output) {
+		phase_begin("build");
+		assert(players_have_clear_flags (&ctx->players));
+		// ctx->encounters has all the games, as loaded (with --tmpdir, there are no games to count again)
+		if (NULL == (gv = GV_make (&ctx->encounters, &ctx->players))) {
 			fprintf (stderr, "not enough memory for encounters allocation\n");
 			exit(EXIT_FAILURE);
 		}
+		phase_end();
 	}
 
 	if (group_is_output) {
 		gamesnum_t intra, inter;
 
-		timelog("sieve groups...");
-		GV_sieve (gv, &Encounters, &intra, &inter);
+		phase_begin("sieve");
+		GV_sieve (gv, &ctx->encounters, &intra, &inter);
+		phase_end();
 
 		GV_out (gv, groupf);
 		if (!quiet_mode) {
 			printf ("\nGroups=%ld\n", (long)GV_counter(gv));
 			printf ("Encounters: Total=%ld, within groups=%ld, @ interface between groups=%ld\n"
-					, (long)Encounters.n, (long)intra, (long)inter);
+					, (long)ctx->encounters.n, (long)intra, (long)inter);
 		}
 
 		if (textstr == NULL && csvstr == NULL)	{
@@ -1022,7 +1219,15 @@ int main (int argc, char *argv[])
 		}
  	} else if (groupcheck) {
 
-		player_t groups_n = GV_counter (gv);
+		player_t groups_n = 0;
+
+		phase_begin("connectivity");
+		if (!ordo_groups (ctx, &groups_n)) {
+			fprintf (stderr, "%s", ordo_errmsg(ctx));
+			exit(EXIT_FAILURE);
+		}
+		phase_end();
+
 		if (groups_n > 1) {
 			fprintf (stderr, "\n\n");
 			fprintf (stderr, "********************[ WARNING ]**********************\n");
@@ -1039,136 +1244,90 @@ int main (int argc, char *argv[])
 		gv = NULL;
 	}
 
-	/*==== ratings calc ===*/
+	phase_end(); // groups
 
-	assert(players_have_clear_flags(&Players));
-	encounters_calculate(ENCOUNTERS_FULL, &Games, Players.flagged, &Encounters);
+	/*==== ratings calc ===*/
 
-	players_set_priored_info (PP, &RPset, &Players);
-	if (0 < players_set_super (quiet_mode, &Encounters, &Players)) {
-		players_purge (quiet_mode, &Players);
-		encounters_calculate(ENCOUNTERS_NOFLAGGED, &Games, Players.flagged, &Encounters);
-	}
+	phase_begin("transform");
 
-	if (groupcheck && !well_connected (&Encounters, &Players)) {
-			fprintf (stderr, "\n\n");
-			fprintf (stderr, "*************************[ WARNING ]*************************\n");
-			fprintf (stderr, "*       Database is not well connected by games...          *\n");
-			fprintf (stderr, "* ...even after purging players with all-wins/all-losses    *\n");
-			fprintf (stderr, "*                                                           *\n");
-			fprintf (stderr, "*    Run switch -g to find what groups need more games      *\n");
-			fprintf (stderr, "*   Run switch -G to ignore warnings and force calculation  *\n");
-			fprintf (stderr, "*   (Attempting it may be very slow and may not converge)   *\n");
-			fprintf (stderr, "*************************************************************\n");
+	if (!ordo_transform (ctx)) {
+		if (ctx->error != ORDO_ERR_CONNECTIVITY) {
+			fprintf (stderr, "%s", ordo_errmsg(ctx));
 			exit(EXIT_FAILURE);
+		}
+		fprintf (stderr, "\n\n");
+		fprintf (stderr, "*************************[ WARNING ]*************************\n");
+		fprintf (stderr, "*       Database is not well connected by games...          *\n");
+		fprintf (stderr, "* ...even after purging players with all-wins/all-losses    *\n");
+		fprintf (stderr, "*                                                           *\n");
+		fprintf (stderr, "*    Run switch -g to find what groups need more games      *\n");
+		fprintf (stderr, "*   Run switch -G to ignore warnings and force calculation  *\n");
+		fprintf (stderr, "*   (Attempting it may be very slow and may not converge)   *\n");
+		fprintf (stderr, "*************************************************************\n");
+		exit(EXIT_FAILURE);
 	}
 
-	timelog("calculate rating...");
-
-	Encounters.n = calc_rating 	( quiet_mode
-								, Forces_ML || Prior_mode
-								, adjust_white_advantage
-								, adjust_draw_rate
-								, Anchor_use
-								, Anchor_err_rel2avg
+	phase_end(); // transform
 
-								, General_average
-								, Anchor
-								, Priored_n
-								, BETA
+	phase_begin("solve");
 
-								, &Encounters
-								, &RPset
-								, &Players
-								, &RA
-								, &Games
+	ordo_solve (ctx);
 
-								, PP
-								, Wa_prior
-								, Dr_prior
+	white_advantage_result = ordo_white_advantage (ctx);
+	drawrate_evenmatch_result = ordo_drawrate (ctx);
 
-								, &White_advantage
-								, &Drawrate_evenmatch
+	phase_end(); // solve
 
-								);
-
-	ratings_results	( Anchor_err_rel2avg
-					, Anchor_use 
-					, Anchor
-					, General_average				
-					, &Players
-					, &RA);
-
-	white_advantage_result = White_advantage;
-	drawrate_evenmatch_result = Drawrate_evenmatch;
+	if (init_online && !quiet_mode) {
+		printf ("Starting from the online ratings: %d phases, %ld iterations\n"
+				, ctx->convergence.phases, ctx->convergence.iterations);
+		if (stats_on) 
+			init_online_saved (ctx);
+	}
 
 	/*== simulation ========*/
 
 	/* Simulation block, begin */
-	if (Simulate > 1) {
-		timelog("simulation block...");
-		simul_smp
-				( cpus
-				, Simulate
-				, sim_updates
-				, quiet_mode
-				, Forces_ML || Prior_mode
-				, adjust_white_advantage
-				, adjust_draw_rate
-				, Anchor_use
-				, Anchor_err_rel2avg
-
-				, General_average
-				, Anchor
-				, Priored_n
-				, BETA
-
-				, drawrate_evenmatch_result
-				, white_advantage_result
-				, &RPset
-				, PP
-				, Wa_prior
-				, Dr_prior
+	if (Simulate > 1 || sim_merge) {
+		long sim_max = Simulate;
 
-				, &Encounters
-				, &Players
-				, &RA
-				, &Games
+		sim_max_follow = Simulate;
 
-				, RPset_store
-				, PP_store
-
-				, &sfe
-				);
-
-	}
-	/* Simulation block, end */
+		// worker threads, the main thread is one more
+		if (pool == NULL && NULL == (pool = thpool_new (cpus - 1, affinity))) {
+			fprintf (stderr, "Threads for the simulations could not be started\n");
+			exit(EXIT_FAILURE);
+		}
 
-	if (Simulate > 1) {
-		/* retransform database, to restore original data */
-		database_transform(pdaba, &Games, &Players, &Game_stats); 
-		qsort (Games.ga, (size_t)Games.n, sizeof(struct gamei), compare_GAME);
-	
-		/* recalculate encounters */
-		encounters_calculate(ENCOUNTERS_FULL, &Games, Players.flagged, &Encounters);
+		phase_begin("simulations");
+		Simulate = ordo_simulate (ctx, pool, Simulate, &simctrl, sim_updates);
+		phase_end();
 
-		players_set_priored_info (PP, &RPset, &Players);
-		if (0 < players_set_super (quiet_mode, &Encounters, &Players)) {
-			players_purge (quiet_mode, &Players);
-			encounters_calculate(ENCOUNTERS_NOFLAGGED, &Games, Players.flagged, &Encounters);
+		if (Sim_precision > 0 && !quiet_mode) {
+			printf ("\nSimulations performed: %ld (%s)\n", Simulate
+					, Simulate < sim_max? "precision target reached": "maximum reached");
+		}
+		if (sim_merge && !quiet_mode) {
+			printf ("\nSimulations merged: %ld\n", Simulate);
+		}
+		if (Sim_shard_n > 1) {
+			if (!quiet_mode) 
+				printf ("\nSimulations %ld/%ld saved in \"%s\"\n", Sim_shard_k+1, Sim_shard_n, simsavestr);
+			exit(EXIT_SUCCESS);
 		}
 	}
+	/* Simulation block, end */
 
 	/*==== reports ====*/
 
-	timelog("output reports...");
+	phase_begin("reports");
 
-	all_report 	( &Games
-				, &Players
-				, &RA
-				, &RPset
-				, &Encounters
-				, sfe.sdev
+	all_report 	( &ctx->games
+				, &ctx->players
+				, &ctx->ra
+				, &ctx->rpset
+				, &ctx->encounters
+				, ctx->sfe.sdev
 				, Simulate
 				, Hide_old_ver
 				, Confidence_factor
@@ -1179,71 +1338,119 @@ int main (int argc, char *argv[])
 				, decimals_array_n > 0? decimals_array[0]: 1 //OUTDECIMALS
 				, decimals_array_n > 1? decimals_array[1]: 1 //OUTDECIMALS
 				, outqual
-				, sfe.wa_sdev
-				, sfe.dr_sdev
-				, sfe.relative
+				, ctx->sfe.wa_sdev
+				, ctx->sfe.dr_sdev
+				, ctx->sfe.relative
 				, cfs_column
 				, columns
 				);
 
 	#if 0
 	look_at_predictions 
-				( Encounters.n
-				, Encounters.enc
-				, RA.ratingof
-				, BETA
+				( ctx->encounters.n
+				, ctx->encounters.enc
+				, ctx->ra.ratingof
+				, ctx->beta
 				, white_advantage_result
 				, drawrate_evenmatch_result);
 	#endif
 	#if 0
 	look_at_individual_deviation 
-				( Players.n
-				, Players.flagged
-				, &RA
-				, Encounters.enc
-				, Encounters.n
+				( ctx->players.n
+				, ctx->players.flagged
+				, &ctx->ra
+				, ctx->encounters.enc
+				, ctx->encounters.n
 				, white_advantage_result
-				, BETA);
+				, ctx->beta);
 	#endif
 
 	if (Simulate > 1 && NULL != ematstr) {
-		errorsout(&Players, &RA, sfe.relative, ematstr, Confidence_factor);
+		errorsout(&ctx->players, &ctx->ra, ctx->sfe.relative, ematstr, Confidence_factor);
 	}
 	if (Simulate > 1 && NULL != ctsmatstr) {
-		ctsout (&Players, &RA, sfe.relative, ctsmatstr);
+		ctsout (&ctx->players, &ctx->ra, ctx->sfe.relative, ctsmatstr);
 	}
 
 	if (head2head_str != NULL) {
-		timelog("head to head output...");
+		phase_begin("head to head");
 		head2head_output
-					( &Games
-					, &Players
-					, &RA
-					, &Encounters
-					, sfe.sdev
+					( &ctx->games
+					, &ctx->players
+					, &ctx->ra
+					, &ctx->encounters
+					, ctx->sfe.sdev
 					, Simulate
 					, Confidence_factor
-					, &Game_stats
-					, sfe.relative
+					, &ctx->game_stats
+					, ctx->sfe.relative
 					, head2head_str
 					, OUTDECIMALS
 					);
+		phase_end();
 	}
 
 	if (Elostat_output) {
-		timelog("output in elostat format...");
+		phase_begin("elostat");
 		cegt_output	( quiet_mode
-					, &Games
-					, &Players
-					, &RA
-					, &Encounters
-					, sfe.sdev
+					, &ctx->games
+					, &ctx->players
+					, &ctx->ra
+					, &ctx->encounters
+					, ctx->sfe.sdev
 					, Simulate
 					, Confidence_factor
-					, &Game_stats
-					, sfe.relative
+					, &ctx->game_stats
+					, ctx->sfe.relative
 					, outqual
 					, Decimals_set? OUTDECIMALS: 0);
+		phase_end();
+	}
+
+	phase_end(); // reports
+
+	/*==== follow the input file ====*/
+
+	if (Follow) {
+		long sim_max = sim_max_follow;
+
+		// from now on, every update rewrites the output files
+		if (textf_opened) {fclose (textf); textf_opened = FALSE;}
+		if (csvf_opened)  {fclose (csvf);  csvf_opened  = FALSE;}
+
+		cfg.quiet = TRUE;
+		ordo_configure (ctx, &cfg);
+		if (!quiet_mode) printf ("\nFollowing the input file, updates every %ld seconds\n", Follow_every);
+
+		for (;;) {
+			gamesnum_t added;
+
+			mysleep (Follow_every * 1000);
+
+			if (0 > (added = ordo_follow_read (ctx))) {
+				fprintf (stderr, "%s", ordo_errmsg(ctx));
+				exit(EXIT_FAILURE);
+			}
+			if (added == 0) continue;
+
+			if (!ordo_rebuild (ctx) || !ordo_transform (ctx) || !ordo_solve (ctx)) {
+				fprintf (stderr, "%s", ordo_errmsg(ctx)); // may be fixed by the next games
+				continue;
+			}
+			if (sim_max > 1)
+				Simulate = ordo_simulate (ctx, pool, sim_max, &simctrl, FALSE);
+
+			if (!reports_atomic	( textstr, csvstr, ctx, Simulate
+								, decimals_array_n > 0? decimals_array[0]: 1
+								, decimals_array_n > 1? decimals_array[1]: 1
+								, outqual, cfs_column, columns)) {
+				fprintf (stderr, "Errors writing the output files\n");
+			}
+			if (!quiet_mode) {
+				printf ("Games added: %ld, total: %ld\n", (long)added, (long)ctx->pdaba->n_games);
+				fflush (stdout);
+			}
+		}
 	}
 
 	timelog("release memory...");
@@ -1254,27 +1461,14 @@ int main (int argc, char *argv[])
 	if (csvf_opened)  	fclose (csvf); 
 	if (groupf_opened) 	fclose(groupf);
 
-	summations_done(&sfe); 
-
-	if (pdaba != NULL)
-		database_done (pdaba);
-
-	ratings_done (&RA);
-	games_done (&Games);
-	encounters_done (&Encounters);
-	players_done (&Players);
-	supporting_auxmem_done (&PP, &PP_store);
+	strlist_done(&SimMergeL);
 
-	if (relstr != NULL)
-		relpriors_done2 (&RPset, &RPset_store);
-
-	name_storage_done();
 	report_columns_done();
 
-	mythread_mutex_destroy (&Smpcount);
-	mythread_mutex_destroy (&Groupmtx);
-	mythread_mutex_destroy (&Summamtx);
-	mythread_mutex_destroy (&Printmtx);
+	if (pool) thpool_kill (pool);
+
+	ordo_free (ctx);
+	ordo_done ();
 
 	timelog("DONE!!");
 	if (!quiet_mode) printf ("\ndone!\n");
@@ -1354,19 +1548,110 @@ table_output(double rtng_76)
 	printf("\n");
 }
 
-//*==================================================================*/
+/*------------------------------------------------------------------*/
+
+// writes "name.tmp" and renames it, so a reader never sees half a report
+static FILE *
+atomic_open (const char *name, char *tmpname, size_t tmpsize)
+{
+	if (name == NULL) return NULL;
+	if (strlen(name) + 5 > tmpsize) return NULL;
+	sprintf (tmpname, "%s.tmp", name);
+	return fopen (tmpname, "w");
+}
 
-static int compare_GAME (const void * a, const void * b)
+static bool_t
+atomic_close (FILE *f, const char *name, const char *tmpname)
 {
-	const struct gamei *ap = a;
-	const struct gamei *bp = b;
-	if (ap->whiteplayer == bp->whiteplayer && ap->blackplayer == bp->blackplayer) return 0;
-	if (ap->whiteplayer == bp->whiteplayer) {
-		if (ap->blackplayer > bp->blackplayer) return 1; else return -1;
-	} else {	 
-		if (ap->whiteplayer > bp->whiteplayer) return 1; else return -1;
+	bool_t ok = 0 == fclose (f);
+	if (ok) {
+		#if defined(MVSC)
+		remove (name); // rename() does not replace an existing file there
+		#endif
+		ok = 0 == rename (tmpname, name);
 	}
-	return 0;	
+	return ok;
+}
+
+static bool_t
+reports_atomic	( const char *textstr
+				, const char *csvstr
+				, struct ordo_ctx *ctx
+				, long simulate
+				, int decimals
+				, int decimals_score
+				, struct output_qualifiers outqual
+				, bool_t cfs_column
+				, int *columns)
+{
+	char texttmp[FILENAME_MAX];
+	char csvtmp [FILENAME_MAX];
+	FILE *textf = stdout;
+	FILE *csvf  = NULL;
+	bool_t ok = TRUE;
+	struct GAMES none = {0, 0, NULL}; // ctx->encounters are those of the solution
+
+	if (textstr != NULL && NULL == (textf = atomic_open (textstr, texttmp, sizeof(texttmp))))
+		return FALSE;
+	if (csvstr != NULL && NULL == (csvf = atomic_open (csvstr, csvtmp, sizeof(csvtmp)))) {
+		if (textstr != NULL) {fclose (textf); remove (texttmp);}
+		return FALSE;
+	}
+
+	all_report 	( &none
+				, &ctx->players
+				, &ctx->ra
+				, &ctx->rpset
+				, &ctx->encounters
+				, ctx->sfe.sdev
+				, simulate
+				, Hide_old_ver
+				, Confidence_factor
+				, csvf
+				, textf
+				, ordo_white_advantage (ctx)
+				, ordo_drawrate (ctx)
+				, decimals
+				, decimals_score
+				, outqual
+				, ctx->sfe.wa_sdev
+				, ctx->sfe.dr_sdev
+				, ctx->sfe.relative
+				, cfs_column
+				, columns
+				);
+
+	if (textstr != NULL)
+		ok = atomic_close (textf, textstr, texttmp) && ok;
+	else
+		fflush (stdout);
+	if (csvstr != NULL)
+		ok = atomic_close (csvf, csvstr, csvtmp) && ok;
+
+	return ok;
 }
 
+/*------------------------------------------------------------------*/
 
+// solves again from the flat start, only to tell what the online seed saved
+static void
+init_online_saved (const struct ordo_ctx *ctx)
+{
+	struct ordo_config cfg = ctx->cfg;
+	struct ordo_ctx *flat;
+
+	cfg.init_online = FALSE;
+	cfg.quiet = TRUE;
+
+	if (NULL != (flat = ordo_new (&cfg))
+		&& ordo_load_shared (flat, ctx)
+		&& ordo_priors (flat)
+		&& ordo_transform (flat)
+		&& ordo_solve (flat)) {
+		printf ("Flat start: %d phases, %ld iterations (saved: %d phases, %ld iterations)\n"
+				, flat->convergence.phases, flat->convergence.iterations
+				, flat->convergence.phases - ctx->convergence.phases
+				, flat->convergence.iterations - ctx->convergence.iterations);
+	}
+	ordo_free (flat);
+}
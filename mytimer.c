@@ -18,23 +18,48 @@
     along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+	#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#endif
+
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "mytimer.h"
 #include "boolean.h"
+#include "sysport.h"
 
 bool_t TIMELOG = TRUE;
 
-static clock_t Standard_clock = 0;
+#if defined(_WIN32)
+	#include <windows.h>
+	double wallclock (void)
+	{
+		LARGE_INTEGER f, c;
+		QueryPerformanceFrequency (&f);
+		QueryPerformanceCounter (&c);
+		return (double)c.QuadPart / (double)f.QuadPart;
+	}
+#else
+	double wallclock (void)
+	{
+		struct timespec t;
+		clock_gettime (CLOCK_MONOTONIC, &t);
+		return (double)t.tv_sec + (double)t.tv_nsec * 1E-9;
+	}
+#endif
+
+static double Standard_clock = 0;
 
 void timer_reset(void)
 {
-	Standard_clock = clock();
+	Standard_clock = wallclock();
 }
 
 double timer_get(void)
 {
-	return ( (double)clock()-(double)Standard_clock)/(double)CLOCKS_PER_SEC;
+	return wallclock() - Standard_clock;
 }
 
 void timelog (const char *s)
@@ -49,5 +74,195 @@ void timelog_ld (const char *s, long ld)
 	}
 }
 
+//-------------------------------------------------------------------
+
+#define PHASE_MAX 256
+#define PHASE_DEPTH 16
+
+struct PHASE {
+	const char *	name;
+	int				parent;		// -1 at the top
+	int				depth;
+	double			start;		// relative to timer_reset()
+	double			elapsed;
+	int64_t			iter_start;
+	int64_t			iterations;
+	int				threads_start;	// entries of Threads
+	int				threads_n;
+};
+
+struct THREADTIME {
+	int		thread;
+	double	busy;
+	double	idle;
+};
+
+static struct PHASE 		Phase[PHASE_MAX];
+static int					Phase_n = 0;
+static int					Open[PHASE_DEPTH];
+static int					Open_n = 0;
+static struct THREADTIME *	Threads = NULL;
+static int					Threads_n = 0;
+static int					Threads_max = 0;
+static myatomic_t			Iterations = 0;
+static const char *			Profile_file = NULL;
+
+void
+profile_iterations (long n)
+{
+	myatomic_add (&Iterations, (int64_t)n);
+}
+
+void
+phase_begin (const char *name)
+{
+	struct PHASE *p;
+
+	if (Open_n == PHASE_DEPTH || Phase_n == PHASE_MAX) return; // not recorded
+
+	p = &Phase[Phase_n];
+	p->name 	  	= name;
+	p->parent 	  	= Open_n > 0? Open[Open_n-1]: -1;
+	p->depth	  	= Open_n;
+	p->start 	  	= timer_get();
+	p->elapsed	  	= 0;
+	p->iter_start 	= myatomic_get (&Iterations);
+	p->iterations 	= 0;
+	p->threads_start= Threads_n;
+	p->threads_n	= 0;
+	Open[Open_n++]	= Phase_n++;
+
+	if (TIMELOG) printf ("%8.2lf | %*s> %s\n", p->start, 2 * p->depth, "", name);
+}
+
+void
+phase_end (void)
+{
+	struct PHASE *p;
+
+	if (Open_n == 0) return;
+
+	p = &Phase[Open[--Open_n]];
+	p->elapsed 	  = timer_get() - p->start;
+	p->iterations = myatomic_get (&Iterations) - p->iter_start;
+
+	if (TIMELOG) {
+		printf ("%8.2lf | %*s< %s (%.3lf s", p->start + p->elapsed, 2 * p->depth, "", p->name, p->elapsed);
+		if (p->iterations > 0) printf (", %ld iterations", (long)p->iterations);
+		printf (")\n");
+	}
+}
+
+void
+phase_thread (int thread, double busy, double idle)
+{
+	struct PHASE *p;
+
+	if (Open_n == 0) return;
+	p = &Phase[Open[Open_n-1]];
+
+	if (Threads_n == Threads_max) {
+		int max = Threads_max < 64? 64: 2 * Threads_max;
+		struct THREADTIME *t = malloc (sizeof(struct THREADTIME) * (size_t)max);
+		if (t == NULL) return;
+		if (Threads) {
+			memcpy (t, Threads, sizeof(struct THREADTIME) * (size_t)Threads_n);
+			free (Threads);
+		}
+		Threads = t;
+		Threads_max = max;
+	}
+	Threads[Threads_n].thread = thread;
+	Threads[Threads_n].busy   = busy;
+	Threads[Threads_n].idle   = idle;
+	Threads_n++;
+	p->threads_n++;
+
+	if (TIMELOG) printf ("%8.2lf | %*s  thread %d: busy %.3lf s, idle %.3lf s\n", timer_get(), 2 * p->depth, "", thread, busy, idle);
+}
+
+static void
+json_string (FILE *f, const char *s)
+{
+	fputc ('"', f);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\') fputc ('\\', f);
+		fputc (*s, f);
+	}
+	fputc ('"', f);
+}
+
+static void
+profile_json (FILE *f)
+{
+	int i, k;
+	fprintf (f, "{\n\"phases\": [\n");
+	for (i = 0; i < Phase_n; i++) {
+		const struct PHASE *p = &Phase[i];
+		fprintf (f, "  {\"id\": %d, \"parent\": %d, \"depth\": %d, \"name\": ", i, p->parent, p->depth);
+		json_string (f, p->name);
+		fprintf (f, ", \"start\": %.6f, \"elapsed\": %.6f, \"iterations\": %ld, \"threads\": ["
+				, p->start, p->elapsed, (long)p->iterations);
+		for (k = p->threads_start; k < p->threads_start + p->threads_n; k++) {
+			fprintf (f, "%s{\"thread\": %d, \"busy\": %.6f, \"idle\": %.6f}"
+					, k > p->threads_start? ", ": "", Threads[k].thread, Threads[k].busy, Threads[k].idle);
+		}
+		fprintf (f, "]}%s\n", i + 1 < Phase_n? ",": "");
+	}
+	fprintf (f, "]\n}\n");
+}
+
+static void
+profile_csv (FILE *f)
+{
+	int i, k;
+	fprintf (f, "\"id\",\"parent\",\"depth\",\"phase\",\"start\",\"elapsed\",\"iterations\",\"thread\",\"busy\",\"idle\"\n");
+	for (i = 0; i < Phase_n; i++) {
+		const struct PHASE *p = &Phase[i];
+		fprintf (f, "%d,%d,%d,\"%s\",%.6f,%.6f,%ld,,,\n"
+				, i, p->parent, p->depth, p->name, p->start, p->elapsed, (long)p->iterations);
+		for (k = p->threads_start; k < p->threads_start + p->threads_n; k++) {
+			fprintf (f, "%d,%d,%d,\"%s\",%.6f,%.6f,%ld,%d,%.6f,%.6f\n"
+					, i, p->parent, p->depth, p->name, p->start, p->elapsed, (long)p->iterations
+					, Threads[k].thread, Threads[k].busy, Threads[k].idle);
+		}
+	}
+}
+
+static bool_t
+ends_with (const char *s, const char *x)
+{
+	size_t a = strlen(s), b = strlen(x);
+	return a >= b && 0 == strcmp (s + a - b, x);
+}
+
+// at exit, so the trace is written whatever path the program takes to finish
+static void
+profile_flush (void)
+{
+	FILE *f;
+
+	while (Open_n > 0) phase_end();
+
+	if (NULL == (f = fopen (Profile_file, "w"))) {
+		fprintf (stderr, "Profile \"%s\" could not be written\n", Profile_file);
+		return;
+	}
+	if (ends_with (Profile_file, ".json"))
+		profile_json (f);
+	else
+		profile_csv (f);
+	fclose (f);
 
+	free (Threads);
+	Threads = NULL;
+}
+
+void
+profile_output (const char *fname)
+{
+	if (Profile_file == NULL && fname != NULL) 
+		atexit (profile_flush);
+	Profile_file = fname;
+}
 
@@ -32,5 +32,19 @@ extern double 	timer_get(void);
 extern void 	timelog (const char *s);
 extern void 	timelog_ld (const char *s, long ld);
 
+/*
+|	Wall clock profiler. Phases nest and are opened and closed by the
+|	main thread only. Iterations may be added from any thread and count
+|	for every open phase. Threads that worked in a phase report their
+|	busy and idle time through the main thread once they are done.
+*/
+
+extern double	wallclock (void); // seconds, monotonic
+extern void		phase_begin (const char *name);
+extern void		phase_end (void);
+extern void		phase_thread (int thread, double busy, double idle);
+extern void		profile_iterations (long n);
+extern void		profile_output (const char *fname); // JSON if it ends with .json, CSV otherwise
+
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 #endif
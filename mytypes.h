@@ -109,6 +109,26 @@ struct ENC {
 	gamesnum_t	L;
 };
 
+// encounters of the same pair with either color as one, see encmerge_apply()
+struct ENCMERGE {
+	gamesnum_t		n;			// encounters it was built for
+	gamesnum_t		merged;		// pairs
+	gamesnum_t *	slot;		// pair of each encounter
+	struct ENC *	enc;		// of each pair, the lower player as white
+};
+
+struct CONVERGENCE {
+	int			phases;			// of the solver, all cycles
+	long		iterations;
+	double		deviation;		// reached, 0 if not measured
+};
+
+struct APPROXCTRL {
+	long		epochs;			// passes over the encounters, 0 for the exact solver
+	long		batch;			// encounters per minibatch
+	int			exact;			// full-batch iterations at the end
+};
+
 struct GAMESTATS {
 	gamesnum_t
 		white_wins,
@@ -141,6 +161,9 @@ struct summations {
 	struct DEVIATION_ACC *relative; // to be dynamically assigned
 	double	*sum1; // to be dynamically assigned
 	double	*sum2; // to be dynamically assigned
+	double	*sum3; // to be dynamically assigned, of (rating - shift)^3
+	double	*sum4; // to be dynamically assigned, of (rating - shift)^4
+	double	*shift; // to be dynamically assigned, close to the mean rating
 	double	*sdev; // to be dynamically assigned 
 	double wa_sum1;
 	double wa_sum2;				
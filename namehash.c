@@ -46,25 +46,58 @@ struct NAMEPEA {
 	uint32_t hash; 		// name hash
 };
 
-static bool_t name_tree_init(void);
-static void   name_tree_done(void);
+struct NAMEPOD {
+	struct NAMEPEA pea[PEAXPOD];
+	int n;
+};
+
+struct NODETREE {
+	struct NODETREE *hi;
+	struct NODETREE *lo;
+	struct NAMEPEA p;
+};
+
+struct BUFFERBLOCK;
+
+// One per database, so that several of them can live in the same process
+struct NAMESTORE {
+	struct NAMEPOD hashtab[PODMAX];
+
+	// overflow tree
+	struct BUFFERBLOCK *buffer_head;
+	struct BUFFERBLOCK *buffer_curr;
+	player_t treemembers;
+	struct NODETREE *troot;
+	struct NODETREE *t_end;
+	struct NODETREE *tstop;
+};
+
+static bool_t name_tree_init(struct NAMESTORE *ns);
+static void   name_tree_done(struct NAMESTORE *ns);
 static bool_t name_ispresent_hashtable (const struct DATA *d, const char *s, uint32_t hash, /*out*/ player_t *out_index);
-static bool_t name_register_hashtable (uint32_t hash, player_t i, player_t i_out);
+static bool_t name_register_hashtable (struct NAMESTORE *ns, uint32_t hash, player_t i, player_t i_out);
 static bool_t name_ispresent_tree (const struct DATA *d, const char *s, uint32_t hash, /*out*/ player_t *out_index);
-static bool_t name_register_tree (uint32_t hash, player_t i, player_t i_out);
+static bool_t name_register_tree (struct NAMESTORE *ns, uint32_t hash, player_t i, player_t i_out);
 
 //*************************** GENERAL **************************************
 
 bool_t
-name_storage_init(void)
+name_storage_init(struct DATA *d)
 {
+	struct NAMESTORE *ns = memnew (sizeof(struct NAMESTORE));
+	if (ns == NULL) return FALSE;
+	memset (ns, 0, sizeof(struct NAMESTORE));
+	d->names = ns;
 	return TRUE;
 }
 
 void
-name_storage_done(void)
+name_storage_done(struct DATA *d)
 {
-	name_tree_done();
+	if (d->names == NULL) return;
+	name_tree_done(d->names);
+	memrel(d->names);
+	d->names = NULL;
 	return;
 }
 
@@ -77,29 +110,20 @@ name_ispresent (const struct DATA *d, const char *s, uint32_t hash, /*out*/ play
 
 
 bool_t
-name_register (uint32_t hash, player_t i, player_t i_out)
+name_register (struct DATA *d, uint32_t hash, player_t i, player_t i_out)
 {
-	return	name_register_hashtable (hash, i, i_out)
-		||	name_register_tree (hash, i, i_out);
+	return	name_register_hashtable (d->names, hash, i, i_out)
+		||	name_register_tree (d->names, hash, i, i_out);
 }
 
 //************************* HASHED STORAGE *********************************
 
-struct NAMEPOD {
-	struct NAMEPEA pea[PEAXPOD];
-	int n;
-};
-
-// ----------------- PRIVATE DATA---------------
-static struct NAMEPOD Namehashtab[PODMAX];
-//----------------------------------------------
-
 
 static bool_t
 name_ispresent_hashtable (const struct DATA *d, const char *s, uint32_t hash, /*out*/ player_t *out_index)
 {
-	struct NAMEPOD *ppod = &Namehashtab[hash & PODMASK];
-	struct NAMEPEA *ppea;
+	const struct NAMEPOD *ppod = &d->names->hashtab[hash & PODMASK];
+	const struct NAMEPEA *ppea;
 	int 			n;
 	bool_t 			found= FALSE;
 	int i;
@@ -120,10 +144,10 @@ name_ispresent_hashtable (const struct DATA *d, const char *s, uint32_t hash, /*
 	return found;
 }
 
-bool_t
-name_register_hashtable (uint32_t hash, player_t i, player_t i_out)
+static bool_t
+name_register_hashtable (struct NAMESTORE *ns, uint32_t hash, player_t i, player_t i_out)
 {
-	struct NAMEPOD *ppod = &Namehashtab[hash & PODMASK];
+	struct NAMEPOD *ppod = &ns->hashtab[hash & PODMASK];
 	struct NAMEPEA *ppea;
 	int 			n;
 
@@ -145,49 +169,34 @@ name_register_hashtable (uint32_t hash, player_t i, player_t i_out)
 //**************************************************************************
 #define MAX_NODESxBUFFER PEA_REM_MAX
 
-struct NODETREE {
-	struct NODETREE *hi;
-	struct NODETREE *lo;
-	struct NAMEPEA p;
-};
-
 struct BUFFERBLOCK {
 	struct NODETREE buffer[MAX_NODESxBUFFER];
 	struct BUFFERBLOCK *next;
 };
 
-// ----------------- PRIVATE DATA---------------
-static struct BUFFERBLOCK *Buffer_head = NULL;
-static struct BUFFERBLOCK *Buffer_curr = NULL;
-static player_t Treemembers = 0;
-static struct NODETREE *Troot = NULL;
-static struct NODETREE *T_end = NULL;
-static struct NODETREE *Tstop = NULL;
-//----------------------------------------------
-
 static void nodetree_connect (struct NODETREE *root, struct NODETREE *pnew);
 static int	nodetree_cmp (struct NODETREE *a, struct NODETREE *b);
 static bool_t nodetree_is_hit (const struct DATA *d, const char *s, uint32_t hash, const struct NODETREE *pnode);
 
 static bool_t
-name_tree_init (void)
+name_tree_init (struct NAMESTORE *ns)
 {
 	struct BUFFERBLOCK *q = memnew (sizeof (struct BUFFERBLOCK));
 	if (q == NULL) return FALSE;
 	q->next = NULL;
-	Buffer_head = q;
-	Buffer_curr = q;
-	Troot = &q->buffer[0];
-	T_end = Troot;
-	Tstop = T_end + MAX_NODESxBUFFER;
-	Treemembers = 0;
+	ns->buffer_head = q;
+	ns->buffer_curr = q;
+	ns->troot = &q->buffer[0];
+	ns->t_end = ns->troot;
+	ns->tstop = ns->t_end + MAX_NODESxBUFFER;
+	ns->treemembers = 0;
 	return TRUE;
 }
 
 static void
-name_tree_done (void)
+name_tree_done (struct NAMESTORE *ns)
 {
-	struct BUFFERBLOCK *p = Buffer_head;
+	struct BUFFERBLOCK *p = ns->buffer_head;
 	struct BUFFERBLOCK *n = NULL;
 	while (p) {
 		n = p->next;
@@ -195,43 +204,51 @@ name_tree_done (void)
 		memrel(p);
 		p = n;
 	}
+	ns->buffer_head = NULL;
+	ns->buffer_curr = NULL;
+	ns->troot = NULL;
+	ns->t_end = NULL;
+	ns->tstop = NULL;
+	ns->treemembers = 0;
 	return;
 }
 
 static bool_t
-name_tree_addmem (void)
+name_tree_addmem (struct NAMESTORE *ns)
 {
 	struct BUFFERBLOCK *q = memnew (sizeof (struct BUFFERBLOCK));
 	if (q == NULL) return FALSE;
 	q->next = NULL;
-	Buffer_curr->next = q;
-	Buffer_curr = q;
-	T_end = &q->buffer[0];
-	Tstop = T_end + MAX_NODESxBUFFER;
+	ns->buffer_curr->next = q;
+	ns->buffer_curr = q;
+	ns->t_end = &q->buffer[0];
+	ns->tstop = ns->t_end + MAX_NODESxBUFFER;
 	return TRUE;	
 }
 
 static bool_t
-name_register_tree (uint32_t hash, player_t i, player_t i_out)
+name_register_tree (struct NAMESTORE *ns, uint32_t hash, player_t i, player_t i_out)
 {
-	if (Treemembers == 0)
-		name_tree_init();
+	if (ns->treemembers == 0 && ns->buffer_head == NULL) {
+		if (!name_tree_init(ns))
+			return FALSE;
+	}
 
-	if (T_end == Tstop) {
-		if (!name_tree_addmem())
+	if (ns->t_end == ns->tstop) {
+		if (!name_tree_addmem(ns))
 			return FALSE;
 	}
 
-	T_end->hi = NULL;
-	T_end->lo = NULL;		
-	T_end->p.pidx = i;
-	T_end->p.pidx_out = i_out;
-	T_end->p.hash = hash;
+	ns->t_end->hi = NULL;
+	ns->t_end->lo = NULL;		
+	ns->t_end->p.pidx = i;
+	ns->t_end->p.pidx_out = i_out;
+	ns->t_end->p.hash = hash;
 
-	if (Treemembers > 0)
-		nodetree_connect (Troot, T_end);
-	Treemembers++;
-	T_end++;
+	if (ns->treemembers > 0)
+		nodetree_connect (ns->troot, ns->t_end);
+	ns->treemembers++;
+	ns->t_end++;
 	return TRUE;
 }
 
@@ -241,7 +258,7 @@ name_ispresent_tree (const struct DATA *d, const char *s, uint32_t hash, /*out*/
 {
 	bool_t hit = FALSE;
 	struct NODETREE *pnode;
-	for (pnode = Troot; !hit && pnode != NULL;) {
+	for (pnode = d->names->troot; !hit && pnode != NULL;) {
 		hit = nodetree_is_hit (d, s, hash, pnode);
 		if (hit) {
 			*out_index = pnode->p.pidx_out;
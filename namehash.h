@@ -26,10 +26,11 @@
 #include "boolean.h"
 #include "datatype.h"
 
-extern bool_t	name_storage_init(void);
-extern void 	name_storage_done(void);
+// the storage lives in d->names
+extern bool_t	name_storage_init(struct DATA *d);
+extern void 	name_storage_done(struct DATA *d);
 extern bool_t 	name_ispresent (const struct DATA *d, const char *s, uint32_t hash, /*out*/ player_t *out_index);
-extern bool_t 	name_register (uint32_t hash, player_t i, player_t i_out);
+extern bool_t 	name_register (struct DATA *d, uint32_t hash, player_t i, player_t i_out);
 extern uint32_t namehash(const char *str);
 
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
@@ -0,0 +1,381 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+|	ordogen: synthetic tournaments for testing and benchmarking ordo.
+|	True ratings are drawn from a normal distribution, and the games
+|	are played with the same model ordo uses (get_pWDL).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "myopt.h"
+#include "boolean.h"
+#include "mytypes.h"
+#include "mymem.h"
+#include "randfast.h"
+#include "xpect.h"
+#include "pgnget.h"
+#include "pgnout.h"
+
+enum TOURNAMENT {ROUND_ROBIN, GAUNTLET, SWISS, SPARSE, CHAIN, TOURNAMENT_N};
+
+static const char *Tournament_name[TOURNAMENT_N] = {"rr", "gauntlet", "swiss", "sparse", "chain"};
+
+struct GEN {
+	  player_t				n
+	; long					games		// per pairing, per player for sparse
+	; long					rounds		// swiss
+	; double				drawrate	// between equal opponents
+	; double				wadv
+	; double				beta
+	; const double *		rating
+	; struct ranctx			rng
+	; FILE *				f
+	;
+};
+
+static const char *Usage =
+	"usage: ordogen [-t type] [-p players] [-g games] [-r rounds] [-d drawrate]\n"
+	"               [-w wadv] [-z scale] [-s spread] [-S seed] [-o file]\n"
+	"\n"
+	" -t <type>   rr, gauntlet, swiss, sparse or chain (default rr)\n"
+	" -p <num>    players (default 20)\n"
+	" -g <num>    games per pairing, or per player for sparse (default 2)\n"
+	" -r <num>    rounds, for swiss (default 9)\n"
+	" -d <num>    draw rate between equal opponents, 0 to 1 (default 0.5)\n"
+	" -w <num>    white advantage (default 0)\n"
+	" -z <num>    rating difference that scores 76% (default 202)\n"
+	" -s <num>    standard deviation of the true ratings (default 200)\n"
+	" -S <num>    seed (default 1)\n"
+	" -o <file>   output pgn (default stdout)\n"
+	" -R <file>   true ratings, in csv\n"
+	" -h          this help\n"
+	;
+
+static void
+player_name (char *s, player_t i)
+{
+	sprintf (s, "P%06ld", (long)i);
+}
+
+// g games between i and j, with i playing white in the first half
+static void
+play (struct GEN *g, player_t i, player_t j, long games, long whites_i)
+{
+	char wname[32], bname[32];
+	gamesnum_t res[2][3] = {{0,0,0},{0,0,0}};
+	double pw, pd, pl;
+	long k;
+
+	for (k = 0; k < games; k++) {
+		int side = k < whites_i? 0: 1;
+		player_t w = side == 0? i: j;
+		player_t b = side == 0? j: i;
+		get_pWDL (g->rating[w] + g->wadv - g->rating[b], &pw, &pd, &pl, g->drawrate, g->beta);
+		res[side][rand_threeway_wscore (pw, pd, &g->rng)]++;
+	}
+
+	player_name (wname, i);
+	player_name (bname, j);
+	pgnout_results (g->f, wname, bname, res[0][WHITE_WIN], res[0][RESULT_DRAW], res[0][BLACK_WIN]);
+	pgnout_results (g->f, bname, wname, res[1][WHITE_WIN], res[1][RESULT_DRAW], res[1][BLACK_WIN]);
+}
+
+static player_t
+random_player (struct GEN *g)
+{
+	uint64_t x = ((uint64_t)ranctx_val(&g->rng) << 32) | ranctx_val(&g->rng);
+	return (player_t)(x % (uint64_t)g->n);
+}
+
+static void
+gen_round_robin (struct GEN *g)
+{
+	player_t i, j;
+	for (i = 0; i < g->n; i++)
+		for (j = i + 1; j < g->n; j++)
+			play (g, i, j, g->games, (g->games + 1) / 2);
+}
+
+static void
+gen_gauntlet (struct GEN *g)
+{
+	player_t j;
+	for (j = 1; j < g->n; j++)
+		play (g, 0, j, g->games, (g->games + 1) / 2);
+}
+
+static void
+gen_chain (struct GEN *g)
+{
+	player_t i;
+	for (i = 0; i + 1 < g->n; i++)
+		play (g, i, i + 1, g->games, (g->games + 1) / 2);
+}
+
+// random pairs, the graph of games may not be connected
+static void
+gen_sparse (struct GEN *g)
+{
+	gamesnum_t k, total = (gamesnum_t)g->n * g->games / 2;
+	for (k = 0; k < total; k++) {
+		player_t i = random_player (g);
+		player_t j = random_player (g);
+		if (i == j) {k--; continue;}
+		play (g, i, j, 1, 1);
+	}
+}
+
+/*
+|	Swiss system, simplified. Each round, players are ordered by score
+|	and paired with the next player not met before. Whoever had white
+|	less often gets white. With an odd number of players, the last one
+|	rests.
+*/
+
+struct SWISSPLAYER {
+	player_t	id;
+	double		score;
+	long		whites;
+};
+
+static int
+compare_swiss (const void *a, const void *b)
+{
+	const struct SWISSPLAYER *x = a;
+	const struct SWISSPLAYER *y = b;
+	if (x->score != y->score) return x->score < y->score? 1: -1;
+	return x->id < y->id? -1: x->id > y->id;
+}
+
+static bool_t
+have_met (const player_t *met, long rounds, player_t i, player_t j)
+{
+	long r;
+	for (r = 0; r < rounds; r++)
+		if (met[i * rounds + r] == j) return TRUE;
+	return FALSE;
+}
+
+static bool_t
+gen_swiss (struct GEN *g)
+{
+	struct SWISSPLAYER *sp = memnew (sizeof(struct SWISSPLAYER) * (size_t)g->n);
+	struct SWISSPLAYER **byid = memnew (sizeof(struct SWISSPLAYER *) * (size_t)g->n);
+	player_t *met = memnew (sizeof(player_t) * (size_t)g->n * (size_t)g->rounds);
+	bool_t *paired = memnew (sizeof(bool_t) * (size_t)g->n);
+	player_t a, b, i;
+	long r;
+
+	if (!sp || !byid || !met || !paired) {
+		if (sp) memrel (sp);
+		if (byid) memrel (byid);
+		if (met) memrel (met);
+		if (paired) memrel (paired);
+		return FALSE;
+	}
+
+	for (i = 0; i < g->n; i++) {
+		sp[i].id = i;
+		sp[i].score = 0;
+		sp[i].whites = 0;
+	}
+	for (i = 0; i < g->n * g->rounds; i++)
+		met[i] = -1;
+
+	for (r = 0; r < g->rounds; r++) {
+
+		qsort (sp, (size_t)g->n, sizeof(struct SWISSPLAYER), compare_swiss);
+		for (i = 0; i < g->n; i++) {
+			byid[sp[i].id] = &sp[i];
+			paired[i] = FALSE;
+		}
+
+		for (a = 0; a < g->n; a++) {
+			player_t pick = -1;
+			if (paired[a]) continue;
+			for (b = a + 1; b < g->n; b++) {
+				if (paired[b]) continue;
+				if (pick < 0) pick = b; // a rematch, if nothing else is left
+				if (!have_met (met, g->rounds, sp[a].id, sp[b].id)) {pick = b; break;}
+			}
+			if (pick < 0) break; // rests
+
+			paired[a] = paired[pick] = TRUE;
+			met[sp[a].id * g->rounds + r] = sp[pick].id;
+			met[sp[pick].id * g->rounds + r] = sp[a].id;
+		}
+
+		// play the round
+		for (i = 0; i < g->n; i++) {
+			player_t x = i;
+			player_t y = met[sp[i].id * g->rounds + r];
+			struct SWISSPLAYER *px, *py;
+			char wname[32], bname[32];
+			double pw, pd, pl;
+			long k;
+			gamesnum_t W = 0, D = 0, L = 0;
+
+			if (y < sp[x].id) continue; // rests, or played already
+			px = &sp[x];
+			py = byid[y];
+			if (py->whites < px->whites) {struct SWISSPLAYER *t = px; px = py; py = t;}
+
+			for (k = 0; k < g->games; k++) {
+				get_pWDL (g->rating[px->id] + g->wadv - g->rating[py->id], &pw, &pd, &pl, g->drawrate, g->beta);
+				switch (rand_threeway_wscore (pw, pd, &g->rng)) {
+					case WHITE_WIN: 	W++; break;
+					case RESULT_DRAW:	D++; break;
+					default:			L++; break;
+				}
+			}
+			px->score += (double)W + 0.5 * (double)D;
+			py->score += (double)L + 0.5 * (double)D;
+			px->whites++;
+
+			player_name (wname, px->id);
+			player_name (bname, py->id);
+			pgnout_results (g->f, wname, bname, W, D, L);
+		}
+	}
+
+	memrel (paired);
+	memrel (met);
+	memrel (byid);
+	memrel (sp);
+	return TRUE;
+}
+
+static bool_t
+ratings_save (const char *fname, const double *rating, player_t n)
+{
+	FILE *f = fopen (fname, "w");
+	player_t i;
+	char name[32];
+
+	if (f == NULL) return FALSE;
+	for (i = 0; i < n; i++) {
+		player_name (name, i);
+		fprintf (f, "\"%s\",%.1f\n", name, rating[i]);
+	}
+	fclose (f);
+	return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+	struct GEN g;
+	enum TOURNAMENT type = ROUND_ROBIN;
+	long players = 20;
+	long seed = 1;
+	double spread = 200;
+	double rtng_76 = 202;
+	const char *outstr = NULL;
+	const char *ratstr = NULL;
+	double *rating;
+	bool_t ok = TRUE;
+	player_t i;
+	int op, t;
+
+	g.games 	= 2;
+	g.rounds 	= 9;
+	g.drawrate 	= 0.5;
+	g.wadv 		= 0;
+
+	while (END_OF_OPTIONS != (op = options (argc, argv, "t:p:g:r:d:w:z:s:S:o:R:h"))) {
+		switch (op) {
+			case 't':	for (t = 0; t < TOURNAMENT_N && strcmp (opt_arg, Tournament_name[t]); t++) {}
+						if (t == TOURNAMENT_N) {
+							fprintf (stderr, "unknown tournament type \"%s\"\n", opt_arg);
+							exit(EXIT_FAILURE);
+						}
+						type = (enum TOURNAMENT)t;
+						break;
+			case 'p':	ok = 1 == sscanf (opt_arg, "%ld", &players) && players > 1; break;
+			case 'g':	ok = 1 == sscanf (opt_arg, "%ld", &g.games) && g.games > 0; break;
+			case 'r':	ok = 1 == sscanf (opt_arg, "%ld", &g.rounds) && g.rounds > 0; break;
+			case 'd':	ok = 1 == sscanf (opt_arg, "%lf", &g.drawrate) && g.drawrate >= 0 && g.drawrate < 1; break;
+			case 'w':	ok = 1 == sscanf (opt_arg, "%lf", &g.wadv); break;
+			case 'z':	ok = 1 == sscanf (opt_arg, "%lf", &rtng_76) && rtng_76 > 0; break;
+			case 's':	ok = 1 == sscanf (opt_arg, "%lf", &spread) && spread >= 0; break;
+			case 'S':	ok = 1 == sscanf (opt_arg, "%ld", &seed); break;
+			case 'o':	outstr = opt_arg; break;
+			case 'R':	ratstr = opt_arg; break;
+			case 'h':	printf ("%s", Usage); exit(EXIT_SUCCESS);
+			default:	fprintf (stderr, "%s", Usage); exit(EXIT_FAILURE);
+		}
+		if (!ok) {
+			fprintf (stderr, "wrong parameter for -%c\n", op);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (opt_index < argc) {
+		fprintf (stderr, "%s", Usage); 
+		exit(EXIT_FAILURE);
+	}
+
+	g.n = (player_t)players;
+	g.beta = (-log(1.0/0.76-1.0)) / rtng_76;
+
+	randfast_init ((uint32_t)seed);
+	ranctx_init (&g.rng, (uint32_t)seed, 0);
+
+	if (NULL == (rating = memnew (sizeof(double) * (size_t)g.n))) {
+		fprintf (stderr, "not enough memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < g.n; i++)
+		rating[i] = rand_gauss_r (&g.rng, 0, spread);
+	g.rating = rating;
+
+	if (ratstr != NULL && !ratings_save (ratstr, rating, g.n)) {
+		fprintf (stderr, "file \"%s\" could not be written\n", ratstr);
+		exit(EXIT_FAILURE);
+	}
+
+	if (outstr == NULL) {
+		g.f = stdout;
+	} else if (NULL == (g.f = fopen (outstr, "w"))) {
+		fprintf (stderr, "file \"%s\" could not be written\n", outstr);
+		exit(EXIT_FAILURE);
+	}
+
+	switch (type) {
+		case ROUND_ROBIN:	gen_round_robin (&g); break;
+		case GAUNTLET:		gen_gauntlet (&g); break;
+		case SPARSE:		gen_sparse (&g); break;
+		case CHAIN:			gen_chain (&g); break;
+		default:			ok = gen_swiss (&g); break;
+	}
+
+	if (g.f != stdout) fclose (g.f);
+	memrel (rating);
+
+	if (!ok) {
+		fprintf (stderr, "not enough memory\n");
+		exit(EXIT_FAILURE);
+	}
+	return EXIT_SUCCESS;
+}
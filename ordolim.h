@@ -31,12 +31,14 @@
 	#define MAXGAMESxBLOCK ((size_t)1024*(size_t)1024)
 	#define MAXNAMESxBLOCK ((size_t)1024*(size_t)64)
 	#define MAX_RPBLOCK 1024
+	#define EXT_RUN_GAMES ((size_t)4*1024*1024)
 #else
 	#define LABELBUFFERSIZE 100
 	#define MAXBLOCKS ((size_t)2048*(size_t)1024)
 	#define MAXGAMESxBLOCK ((size_t)16)
 	#define MAXNAMESxBLOCK ((size_t)16)
 	#define MAX_RPBLOCK 100
+	#define EXT_RUN_GAMES ((size_t)1000)
 #endif
 
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
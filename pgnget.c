@@ -34,6 +34,7 @@
 #include "mymem.h"
 
 #include "namehash.h"
+#include "stats.h"
 
 #if 0
 static void	hashstat(void);
@@ -53,6 +54,7 @@ struct pgn_result {
 	int 	btag_present;
 	int 	result_present;	
 	int 	result;
+	int32_t	date;			// yyyymmdd, unknown parts are 0
 	char 	wtag[PGNSTRSIZE];
 	char 	btag[PGNSTRSIZE];
 };
@@ -64,6 +66,7 @@ static void	structdata_done (struct DATA *d);
 
 
 static bool_t	addplayer (struct DATA *d, const char *s, player_t *i);
+static bool_t	addgame (struct DATA *d, player_t i, player_t j, int result, int32_t date);
 static void		report_error 	(long int n);
 static int		res2int 		(const char *s);
 static bool_t 	fpgnscan (FILE *fpgn, bool_t quiet, struct DATA *d);
@@ -112,6 +115,12 @@ structdata_init (void)
 		if (ok)	d->nm_allocated++;
 		d->nm[0] = t;
 
+		d->sink = NULL;
+		d->sink_arg = NULL;
+
+		d->names = NULL;
+		ok = ok && name_storage_init(d);
+
 		if (!ok) structdata_done(d);
 	}
 	return ok? d: NULL;
@@ -164,6 +173,9 @@ structdata_done (struct DATA *d)
 	p = &d->labels_head;
 		if (p->buf) {memrel(p->buf); p->buf = NULL; p->idx = 0;}
 
+//
+	name_storage_done(d);
+
 }
 
 
@@ -174,8 +186,8 @@ structdata_done (struct DATA *d)
 
 #include "strlist.h"
 
-struct DATA *
-database_init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet)
+static struct DATA *
+init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet, gamesink_t sink, void *arg)
 {
 
 	struct DATA *pDAB = NULL;
@@ -184,6 +196,10 @@ database_init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet)
 	const char *pgn;
 
 	ok = NULL != (pDAB = structdata_init ());
+	if (!ok) return NULL;
+
+	pDAB->sink = sink;
+	pDAB->sink_arg = arg;
 
 	if (NULL != synfile_name) // not provided
 		syn_preload (quiet, synfile_name, pDAB); 
@@ -208,10 +224,91 @@ database_init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet)
 	#endif
 }
 
+struct DATA *
+database_init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet)
+{
+	return init_frompgn (sl, synfile_name, quiet, NULL, NULL);
+}
+
+struct DATA *
+database_init_spilled (strlist_t *sl, const char *synfile_name, bool_t quiet, gamesink_t sink, void *arg)
+{
+	return init_frompgn (sl, synfile_name, quiet, sink, arg);
+}
+
+struct DATA *
+database_init_empty (const char *synfile_name, bool_t quiet)
+{
+	struct DATA *pDAB = structdata_init ();
+
+	if (pDAB != NULL && NULL != synfile_name)
+		syn_preload (quiet, synfile_name, pDAB); 
+
+	return pDAB;
+}
+
+struct DATA *
+database_init_fromarrays
+		( player_t n_players
+		, const char *const *names
+		, gamesnum_t n_games
+		, const player_t *white
+		, const player_t *black
+		, const int *result
+)
+{
+	struct DATA *d = NULL;
+	player_t i, p;
+	gamesnum_t g;
+	bool_t ok;
+
+	ok = NULL != (d = structdata_init ());
+
+	for (i = 0; ok && i < n_players; i++) {
+		uint32_t hsh = namehash(names[i]);
+		ok = !name_ispresent (d, names[i], hsh, &p) // repeated names are not allowed
+			&& addplayer (d, names[i], &p) && name_register(d,hsh,p,p);
+	}
+
+	for (g = 0; ok && g < n_games; g++) {
+		ok = white[g] >= 0 && white[g] < n_players
+		  && black[g] >= 0 && black[g] < n_players
+		  && result[g] >= WHITE_WIN && result[g] <= DISCARD
+		  && addgame (d, white[g], black[g], result[g], 0);
+	}
+
+	if (!ok && d != NULL) {
+		database_done (d);
+		d = NULL;
+	}
+	return d;
+}
+
+bool_t
+database_add_game (struct DATA *d, const char *white, const char *black, int result)
+{
+	player_t i = 0, j = 0;
+	uint32_t hsh;
+	bool_t ok = TRUE;
+
+	hsh = namehash(white);
+	if (!name_ispresent (d, white, hsh, &i)) {
+		ok = addplayer (d, white, &i) && name_register(d,hsh,i,i);
+	}
+
+	hsh = namehash(black);
+	if (ok && !name_ispresent (d, black, hsh, &j)) {
+		ok = addplayer (d, black, &j) && name_register(d,hsh,j,j);
+	}
+
+	return ok && addgame (d, i, j, result, 0);
+}
+
 void 
 database_done (struct DATA *p)
 {
 	structdata_done (p);
+	memrel (p);
 	return;
 }
 
@@ -223,36 +320,29 @@ database_getname(const struct DATA *d, player_t i)
 	return d->nm[j]->p[k];
 }
 
+// game i in input order, date is yyyymmdd (0 if unknown)
+void
+database_getgame (const struct DATA *d, gamesnum_t i, struct gamei *g, int32_t *date)
+{
+	size_t blk = (size_t)i / MAXGAMESxBLOCK;
+	size_t idx = (size_t)i % MAXGAMESxBLOCK;
+	g->whiteplayer	= d->gb[blk]->white[idx];
+	g->blackplayer	= d->gb[blk]->black[idx];
+	g->score		= d->gb[blk]->score[idx];
+	*date			= d->gb[blk]->date [idx];
+}
+
 
 #include "mytypes.h"
 
 void 
 database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, struct GAMESTATS *gs)
 {
-	enum maxresults {MAXRESTYPE = 8};
-	player_t j;
-	player_t topn;
-	gamesnum_t gamestat[MAXRESTYPE] = {0,0,0,0,0,0,0,0};
-
 	assert(db && p && g && gs);
-	assert(p->name && p->flagged && p->present_in_games && p->prefed && p->priored && p->performance_type);
 
-	p->n = db->n_players; 
 	g->n = db->n_games; 
 
-	topn = db->n_players; 
-	for (j = 0; j < topn; j++) {
-		p->name[j] = database_getname(db,j);
-		p->flagged[j] = FALSE;
-		p->present_in_games[j] = FALSE;
-		p->prefed [j] = FALSE;
-		p->priored[j] = FALSE;
-		p->performance_type[j] = PERF_NORMAL;
-	}
-
 {
-	player_t wp, bp;
-
 	size_t blk_filled  = db->gb_filled;
 	size_t blk;
 	size_t idx_last = db->gb_idx;
@@ -263,16 +353,9 @@ database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, st
 
 		for (idx = 0; idx < MAXGAMESxBLOCK; idx++) {
 
-			g->ga[i].whiteplayer = wp = db->gb[blk]->white[idx];
-			g->ga[i].blackplayer = bp = db->gb[blk]->black[idx]; 
-			g->ga[i].score       =      db->gb[blk]->score[idx];
-			if (g->ga[i].score < MAXRESTYPE) gamestat[g->ga[i].score]++;
-
-			if (g->ga[i].score < DISCARD) {
-				p->present_in_games[wp] = TRUE;
-				p->present_in_games[bp] = TRUE;
-			}
-			
+			g->ga[i].whiteplayer = db->gb[blk]->white[idx];
+			g->ga[i].blackplayer = db->gb[blk]->black[idx]; 
+			g->ga[i].score       = db->gb[blk]->score[idx];
 			i++;
 		}
 	
@@ -282,16 +365,9 @@ database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, st
 
 		for (idx = 0; idx < idx_last; idx++) {
 
-			g->ga[i].whiteplayer = wp = db->gb[blk]->white[idx];
-			g->ga[i].blackplayer = bp = db->gb[blk]->black[idx]; 
-			g->ga[i].score       =      db->gb[blk]->score[idx];
-			if (g->ga[i].score < MAXRESTYPE) gamestat[g->ga[i].score]++;
-
-			if (g->ga[i].score < DISCARD) {
-				p->present_in_games[wp] = TRUE;
-				p->present_in_games[bp] = TRUE;
-			}
-
+			g->ga[i].whiteplayer = db->gb[blk]->white[idx];
+			g->ga[i].blackplayer = db->gb[blk]->black[idx]; 
+			g->ga[i].score       = db->gb[blk]->score[idx];
 			i++;
 		}
 
@@ -301,6 +377,70 @@ database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, st
 	}
 }
 
+	database_players (db, g, p, gs);
+	return;
+}
+
+// games of db that g does not have yet (from g->n on), counted in gs.
+// g must have room for all of them.
+void
+database_append (const struct DATA *db, struct GAMES *g, struct GAMESTATS *gs)
+{
+	gamesnum_t i;
+
+	assert (g->size >= db->n_games);
+
+	for (i = g->n; i < db->n_games; i++) {
+		size_t blk = (size_t)i / MAXGAMESxBLOCK;
+		size_t idx = (size_t)i % MAXGAMESxBLOCK;
+		struct gamei *x = &g->ga[i];
+		x->whiteplayer	= db->gb[blk]->white[idx];
+		x->blackplayer	= db->gb[blk]->black[idx];
+		x->score		= db->gb[blk]->score[idx];
+		switch (x->score) {
+			case WHITE_WIN:		gs->white_wins++; break;
+			case RESULT_DRAW:	gs->draws++; break;
+			case BLACK_WIN:		gs->black_wins++; break;
+			default:			gs->noresult++; break;
+		}
+	}
+	g->n = db->n_games;
+}
+
+// players and statistics of games already transformed, possibly by another context
+void 
+database_players(const struct DATA *db, const struct GAMES *g, struct PLAYERS *p, struct GAMESTATS *gs)
+{
+	enum maxresults {MAXRESTYPE = 8};
+	player_t j;
+	player_t topn;
+	gamesnum_t i;
+	gamesnum_t gamestat[MAXRESTYPE] = {0,0,0,0,0,0,0,0};
+
+	assert(db && p && g && gs);
+	assert(p->name && p->flagged && p->present_in_games && p->prefed && p->priored && p->performance_type);
+
+	p->n = db->n_players; 
+
+	topn = db->n_players; 
+	for (j = 0; j < topn; j++) {
+		p->name[j] = database_getname(db,j);
+		p->flagged[j] = FALSE;
+		p->present_in_games[j] = FALSE;
+		p->prefed [j] = FALSE;
+		p->priored[j] = FALSE;
+		p->performance_type[j] = PERF_NORMAL;
+	}
+
+	for (i = 0; i < g->n; i++) {
+		int score = g->ga[i].score;
+		if (score < MAXRESTYPE) gamestat[score]++;
+		if (score < DISCARD) {
+			p->present_in_games[g->ga[i].whiteplayer] = TRUE;
+			p->present_in_games[g->ga[i].blackplayer] = TRUE;
+		}
+	}
+
 	gs->white_wins	= gamestat[WHITE_WIN];
 	gs->draws		= gamestat[RESULT_DRAW];
 	gs->black_wins	= gamestat[BLACK_WIN];
@@ -316,63 +456,38 @@ database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, st
 }
 
 
+// games from first on, the ones before were already filtered
 void 
-database_ignore_draws (struct DATA *db)
+database_ignore_draws (struct DATA *db, gamesnum_t first)
 {
-	size_t blk_filled = db->gb_filled;
-	size_t idx_last   = db->gb_idx;
-	size_t blk;
-	size_t idx;
-
-	blk_filled = db->gb_filled;
-	idx_last   = db->gb_idx;
+	gamesnum_t i;
 
-	for (blk = 0; blk < blk_filled; blk++) {
-		for (idx = 0; idx < MAXGAMESxBLOCK; idx++) {
-			if (db->gb[blk]->score[idx] == RESULT_DRAW)
-				db->gb[blk]->score[idx] |= IGNORED;
-		}
+	for (i = first; i < db->n_games; i++) {
+		size_t blk = (size_t)i / MAXGAMESxBLOCK;
+		size_t idx = (size_t)i % MAXGAMESxBLOCK;
+		if (db->gb[blk]->score[idx] == RESULT_DRAW)
+			db->gb[blk]->score[idx] |= IGNORED;
 	}
-
-	blk = blk_filled;
-
-		for (idx = 0; idx < idx_last; idx++) {
-			if (db->gb[blk]->score[idx] == RESULT_DRAW)
-				db->gb[blk]->score[idx] |= IGNORED;
-		}
-
 	return;
 }
 
 #include "bitarray.h"
 
+// games from first on, the ones before were already filtered
 void 
-database_include_only (struct DATA *db, bitarray_t *pba)
+database_include_only (struct DATA *db, bitarray_t *pba, gamesnum_t first)
 {
 	player_t wp, bp;
-	size_t blk;
-	size_t idx;
-	size_t blk_filled = db->gb_filled;
-	size_t idx_last   = db->gb_idx;
-
-	for (blk = 0; blk < blk_filled; blk++) {
-		for (idx = 0; idx < MAXGAMESxBLOCK; idx++) {
-			wp = db->gb[blk]->white[idx];
-			bp = db->gb[blk]->black[idx];
-			if (!ba_ison(pba, wp) || !ba_ison(pba, bp))
-				db->gb[blk]->score[idx] |= IGNORED;
-		}
+	gamesnum_t i;
+
+	for (i = first; i < db->n_games; i++) {
+		size_t blk = (size_t)i / MAXGAMESxBLOCK;
+		size_t idx = (size_t)i % MAXGAMESxBLOCK;
+		wp = db->gb[blk]->white[idx];
+		bp = db->gb[blk]->black[idx];
+		if (!ba_ison(pba, wp) || !ba_ison(pba, bp))
+			db->gb[blk]->score[idx] |= IGNORED;
 	}
-
-	blk = blk_filled;
-
-		for (idx = 0; idx < idx_last; idx++) {
-			wp = db->gb[blk]->white[idx];
-			bp = db->gb[blk]->black[idx];
-			if (!ba_ison(pba, wp) || !ba_ison(pba, bp))
-				db->gb[blk]->score[idx] |= IGNORED;
-		}
-
 	return;
 }
 
@@ -500,14 +615,14 @@ syn_apply_pair (struct DATA *d, const char *m, const char *s)
 	taghsh = namehash(tagstr);
 
 	if (ok && !name_ispresent (d, tagstr, taghsh, &plyr_0)) {
-		ok = addplayer (d, tagstr, &plyr_0) && name_register(taghsh,plyr_0,plyr_0);
+		ok = addplayer (d, tagstr, &plyr_0) && name_register(d,taghsh,plyr_0,plyr_0);
 	}
 
 	tagstr = s;
 	taghsh = namehash(tagstr);
 
 	if (ok && !name_ispresent (d, tagstr, taghsh, &plyr_i)) {
-		ok = addplayer (d, tagstr, &plyr_i) && name_register(taghsh,plyr_i,plyr_0);
+		ok = addplayer (d, tagstr, &plyr_i) && name_register(d,taghsh,plyr_i,plyr_0);
 	}
 
 	return ok;
@@ -693,6 +808,7 @@ pgn_result_reset (struct pgn_result *p)
 	p->wtag[0] = '\0';
 	p->btag[0] = '\0';
 	p->result = 0;
+	p->date = 0;
 }
 
 static bool_t
@@ -710,7 +826,7 @@ pgn_result_collect (struct pgn_result *p, struct DATA *d)
 	taghsh = namehash(tagstr);
 
 	if (ok && !name_ispresent (d, tagstr, taghsh, &plyr)) {
-		ok = addplayer (d, tagstr, &plyr) && name_register(taghsh,plyr,plyr);
+		ok = addplayer (d, tagstr, &plyr) && name_register(d,taghsh,plyr,plyr);
 	}
 	i = plyr;
 
@@ -718,13 +834,25 @@ pgn_result_collect (struct pgn_result *p, struct DATA *d)
 	taghsh = namehash(tagstr);
 
 	if (ok && !name_ispresent (d, tagstr, taghsh, &plyr)) {
-		ok = addplayer (d, tagstr, &plyr) && name_register(taghsh,plyr,plyr);
+		ok = addplayer (d, tagstr, &plyr) && name_register(d,taghsh,plyr,plyr);
 	}
 	j = plyr;
 
-	ok = ok && (uint64_t)d->n_games < ((uint64_t)MAXGAMESxBLOCK*(uint64_t)MAXBLOCKS);
+	assert (!ok || (i != NOPLAYER && j != NOPLAYER));
 
-	assert (i != NOPLAYER && j != NOPLAYER);
+	return ok && addgame (d, i, j, p->result, p->date);
+}
+
+static bool_t
+addgame (struct DATA *d, player_t i, player_t j, int result, int32_t date)
+{
+	bool_t ok = (uint64_t)d->n_games < ((uint64_t)MAXGAMESxBLOCK*(uint64_t)MAXBLOCKS);
+
+	if (d->sink != NULL) {
+		d->n_games++;
+		STAT_INC (STAT_GAMES);
+		return d->sink (d->sink_arg, i, j, result);
+	}
 
 	if (ok) {
 
@@ -735,9 +863,11 @@ pgn_result_collect (struct pgn_result *p, struct DATA *d)
 
 		d->gb[blk]->white [idx] = i;
 		d->gb[blk]->black [idx] = j;
-		d->gb[blk]->score [idx] = p->result;
+		d->gb[blk]->score [idx] = result;
+		d->gb[blk]->date  [idx] = date;
 		d->n_games++;
 		d->gb_idx++;
+		STAT_INC (STAT_GAMES);
 
 		if (d->gb_idx == MAXGAMESxBLOCK) { // hit new block
 
@@ -776,23 +906,103 @@ parsing_error(long line_counter)
 }
 
 
-static bool_t
-fpgnscan (FILE *fpgn, bool_t quiet, struct DATA *d)
-{
 #define MAX_MYLINE 40000
 
-	char myline[MAX_MYLINE];
+// "yyyy.mm.dd", with '?' for unknown digits
+static int32_t
+date2int (const char *s)
+{
+	int32_t part[3] = {0, 0, 0};
+	int digits[3] = {4, 2, 2};
+	int i, k;
+
+	for (i = 0; i < 3; i++) {
+		for (k = 0; k < digits[i]; k++, s++) {
+			if (*s >= '0' && *s <= '9') {
+				part[i] = part[i] * 10 + (*s - '0');
+			} else if (*s == '?') {
+				part[i] = -1;
+			} else {
+				return part[0] > 0? part[0] * 10000: 0;
+			}
+		}
+		if (part[i] < 0) part[i] = 0;
+		if (i < 2 && *s++ != '.') break;
+	}
+	if (part[0] == 0) return 0;
+	if (part[1] > 12) part[1] = 0;
+	if (part[1] == 0 || part[2] > 31) part[2] = 0;
+	return part[0] * 10000 + part[1] * 100 + part[2];
+}
 
+// returns TRUE when the line completed a game, which was collected in d
+static bool_t
+pgnline_scan (char *myline, long int line_counter, struct pgn_result *result, struct DATA *d)
+{
 	const char *whitesep = "[White \"";
 	const char *whiteend = "\"]";
 	const char *blacksep = "[Black \"";
 	const char *blackend = "\"]";
 	const char *resulsep = "[Result \"";
 	const char *resulend = "\"]";
+	const char *datesep  = "[Date \"";
 
-	size_t whitesep_len, blacksep_len, resulsep_len;
 	char *x, *y;
 
+	if (NULL != (x = strstr (myline, whitesep))) {
+		x += strlen(whitesep);
+		if (NULL != (y = strstr (myline, whiteend))) {
+			*y = '\0';
+					strcpy (result->wtag, x);
+					result->wtag_present = TRUE;
+		} else {
+			parsing_error(line_counter);
+		}
+	}
+
+	if (NULL != (x = strstr (myline, blacksep))) {
+		x += strlen(blacksep);
+		if (NULL != (y = strstr (myline, blackend))) {
+			*y = '\0';
+					strcpy (result->btag, x);
+					result->btag_present = TRUE;
+		} else {
+			parsing_error(line_counter);
+		}
+	}
+
+	if (NULL != (x = strstr (myline, resulsep))) {
+		x += strlen(resulsep);
+		if (NULL != (y = strstr (myline, resulend))) {
+			*y = '\0';
+					result->result = res2int (x);
+					result->result_present = TRUE;
+		} else {
+			parsing_error(line_counter);
+		}
+	}
+
+	if (NULL != (x = strstr (myline, datesep))) {
+		x += strlen(datesep);
+		result->date = date2int (x);
+	}
+
+	if (is_complete (result)) {
+		if (!pgn_result_collect (result, d)) {
+			fprintf (stderr, "\nCould not collect more games: Limits reached\n");
+			exit(EXIT_FAILURE);
+		}
+		pgn_result_reset  (result);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static bool_t
+fpgnscan (FILE *fpgn, bool_t quiet, struct DATA *d)
+{
+	char myline[MAX_MYLINE];
+
 	struct pgn_result 	result;
 	long int			line_counter = 0;
 	long int			game_counter = 0;
@@ -806,53 +1016,11 @@ fpgnscan (FILE *fpgn, bool_t quiet, struct DATA *d)
 
 	pgn_result_reset  (&result);
 
-	whitesep_len = strlen(whitesep); 
-	blacksep_len = strlen(blacksep); 
-	resulsep_len = strlen(resulsep); 
-
 	while (NULL != fgets(myline, MAX_MYLINE, fpgn)) {
 
 		line_counter++;
 
-		if (NULL != (x = strstr (myline, whitesep))) {
-			x += whitesep_len;
-			if (NULL != (y = strstr (myline, whiteend))) {
-				*y = '\0';
-						strcpy (result.wtag, x);
-						result.wtag_present = TRUE;
-			} else {
-				parsing_error(line_counter);
-			}
-		}
-
-		if (NULL != (x = strstr (myline, blacksep))) {
-			x += blacksep_len;
-			if (NULL != (y = strstr (myline, blackend))) {
-				*y = '\0';
-						strcpy (result.btag, x);
-						result.btag_present = TRUE;
-			} else {
-				parsing_error(line_counter);
-			}
-		}
-
-		if (NULL != (x = strstr (myline, resulsep))) {
-			x += resulsep_len;
-			if (NULL != (y = strstr (myline, resulend))) {
-				*y = '\0';
-						result.result = res2int (x);
-						result.result_present = TRUE;
-			} else {
-				parsing_error(line_counter);
-			}
-		}
-
-		if (is_complete (&result)) {
-			if (!pgn_result_collect (&result, d)) {
-				fprintf (stderr, "\nCould not collect more games: Limits reached\n");
-				exit(EXIT_FAILURE);
-			}
-			pgn_result_reset  (&result);
+		if (pgnline_scan (myline, line_counter, &result, d)) {
 			game_counter++;
 
 			if (!quiet) {
@@ -872,6 +1040,65 @@ fpgnscan (FILE *fpgn, bool_t quiet, struct DATA *d)
 	return TRUE;
 }
 
+/*--------------------------------------------------------------*\
+|	PGN files that keep growing
+\*--------------------------------------------------------------*/
+
+struct PGNFOLLOW {
+	FILE *				f;
+	struct pgn_result	result;			// game in progress, tags seen so far
+	long int			line_counter;
+	long				offset;			// beginning of the first line not read
+};
+
+pgnfollow_t *
+pgnfollow_open (const char *fname)
+{
+	pgnfollow_t *pf = memnew (sizeof(pgnfollow_t));
+	if (pf == NULL) return NULL;
+	if (NULL == (pf->f = fopen (fname, "r"))) {
+		memrel (pf);
+		return NULL;
+	}
+	pgn_result_reset (&pf->result);
+	pf->line_counter = 0;
+	pf->offset = 0;
+	return pf;
+}
+
+void
+pgnfollow_close (pgnfollow_t *pf)
+{
+	if (pf == NULL) return;
+	fclose (pf->f);
+	memrel (pf);
+}
+
+// Only lines that were written completely (up to '\n') are scanned. A line
+// that is still being written is read again in the next call.
+gamesnum_t
+pgnfollow_read (pgnfollow_t *pf, struct DATA *d)
+{
+	char myline[MAX_MYLINE];
+	gamesnum_t games = 0;
+	size_t len;
+
+	clearerr (pf->f);
+	if (0 != fseek (pf->f, pf->offset, SEEK_SET))
+		return 0;
+
+	while (NULL != fgets(myline, MAX_MYLINE, pf->f)) {
+		len = strlen (myline);
+		if (len == 0 || (myline[len-1] != '\n' && len < MAX_MYLINE-1))
+			break; // incomplete
+		pf->offset = ftell (pf->f);
+		pf->line_counter++;
+		if (pgnline_scan (myline, pf->line_counter, &pf->result, d))
+			games++;
+	}
+	return games;
+}
+
 static int
 res2int (const char *s)
 {
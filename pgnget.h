@@ -38,14 +38,42 @@ enum RESULTS {
 };
 
 extern struct DATA *database_init_frompgn (strlist_t *sl, const char *synfile_name, bool_t quiet);
+
+// only names are kept, every game goes to sink
+extern struct DATA *database_init_spilled (strlist_t *sl, const char *synfile_name, bool_t quiet, gamesink_t sink, void *arg);
 extern void 		database_done (struct DATA *p);
 
 #include "mytypes.h"
 
+// names[0..n_players-1] must be unique, result[] takes values from enum RESULTS
+extern struct DATA *database_init_fromarrays
+						( player_t n_players
+						, const char *const *names
+						, gamesnum_t n_games
+						, const player_t *white
+						, const player_t *black
+						, const int *result);
+
+// appends one game, players not present are added
+extern bool_t		database_add_game (struct DATA *d, const char *white, const char *black, int result);
+
+// no games, names of synfile_name (if not NULL) preloaded
+extern struct DATA *database_init_empty (const char *synfile_name, bool_t quiet);
+
+// PGN file that keeps growing, each read adds to d the games appended since the last one
+typedef struct PGNFOLLOW pgnfollow_t;
+
+extern pgnfollow_t *pgnfollow_open (const char *fname);
+extern gamesnum_t	pgnfollow_read (pgnfollow_t *pf, struct DATA *d);
+extern void			pgnfollow_close (pgnfollow_t *pf);
+
 extern void 		database_transform(const struct DATA *db, struct GAMES *g, struct PLAYERS *p, struct GAMESTATS *gs);
-extern void 		database_ignore_draws (struct DATA *db);
+extern void 		database_players(const struct DATA *db, const struct GAMES *g, struct PLAYERS *p, struct GAMESTATS *gs);
+extern void 		database_append (const struct DATA *db, struct GAMES *g, struct GAMESTATS *gs);
+extern void 		database_ignore_draws (struct DATA *db, gamesnum_t first);
 extern const char *	database_getname (const struct DATA *db, player_t i);
-extern void 		database_include_only (struct DATA *db, bitarray_t *pba);
+extern void 		database_getgame (const struct DATA *db, gamesnum_t i, struct gamei *g, int32_t *date);
+extern void 		database_include_only (struct DATA *db, bitarray_t *pba, gamesnum_t first);
 
 extern void 		namelist_to_bitarray (bool_t quietmode, bool_t do_warning, const char *finp_name, const struct DATA *d, bitarray_t *pba);
 
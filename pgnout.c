@@ -0,0 +1,45 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include "pgnout.h"
+#include "pgnget.h"
+
+static const char *Result_string[4] = {"1-0","1/2-1/2","0-1","*"};
+
+static void
+save_result (FILE *fout, const char *name_w, const char *name_b, const char *result, gamesnum_t n)
+{
+	gamesnum_t i;
+	for (i = 0; i < n; i++) {
+		fprintf(fout,"[White \"%s\"]\n",name_w);
+		fprintf(fout,"[Black \"%s\"]\n",name_b);
+		fprintf(fout,"[Result \"%s\"]\n",result);
+		fprintf(fout,"%s\n\n",result);
+	}
+}
+
+void
+pgnout_results (FILE *f, const char *white, const char *black, gamesnum_t W, gamesnum_t D, gamesnum_t L)
+{
+	save_result (f, white, black, Result_string[WHITE_WIN],   W);
+	save_result (f, white, black, Result_string[RESULT_DRAW], D);
+	save_result (f, white, black, Result_string[BLACK_WIN],   L);
+}
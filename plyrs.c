@@ -111,53 +111,18 @@ players_flags_reset (struct PLAYERS *pl)
 }
 
 
+// classifies players from their score (obt) and games played (pla)
 player_t	
-players_set_super (bool_t quiet, const struct ENCOUNTERS *ee, struct PLAYERS *pl)
+players_set_perf (bool_t quiet, const double *obt, const gamesnum_t *pla, struct PLAYERS *pl)
 {
-	// encounters
-	gamesnum_t N_enc = ee->n;
-	const struct ENC *enc = ee->enc;
-
-	// players
 	player_t n_players = pl->n;
 	int *perftype  = pl->performance_type;
 	bool_t *ispriored = pl->priored; 
-//	const char **name    = pl->name;
-
-	double 		*obt;
-	gamesnum_t	*pla;
-	gamesnum_t	e;
 	player_t 	j;
-	player_t 	w, b;
 	player_t 	super = 0;
 
 	player_t counter_nogames, counter_all_W, counter_all_L;
 
-	obt = memnew (sizeof(double) * (size_t)n_players);
-	pla = memnew (sizeof(gamesnum_t) * (size_t)n_players);
-	if (NULL==obt || NULL==pla) {
-		fprintf(stderr, "Not enough memory\n");
-		exit(EXIT_FAILURE);
-	}
-	for (j = 0; j < n_players; j++) {
-		obt[j] = 0.0;	
-		pla[j] = 0;
-	}	
-	for (e = 0; e < N_enc; e++) {
-		w = enc[e].wh;
-		b = enc[e].bl;
-
-		assert(( w >= 0 && w < n_players) || !fprintf(stderr,"w=%ld np=%ld\n",(long)w,(long)n_players));
-		assert(( b >= 0 && b < n_players) || !fprintf(stderr,"b=%ld np=%ld\n",(long)b,(long)n_players));
-
-		obt[w] += enc[e].wscore;
-		obt[b] += (double)enc[e].played - enc[e].wscore;
-
-		pla[w] += enc[e].played;
-		pla[b] += enc[e].played;
-
-	}
-
 	counter_nogames = 0;
 	counter_all_W = 0;
 	counter_all_L = 0;
@@ -184,10 +149,6 @@ players_set_super (bool_t quiet, const struct ENCOUNTERS *ee, struct PLAYERS *pl
 		}
 		if (perftype[j] != PERF_NORMAL || pl->flagged[j]) super++;
 	}
-	for (j = 0; j < n_players; j++) {
-		obt[j] = 0.0;	
-		pla[j] = 0;
-	}	
 	pl->perf_set = TRUE;
 
 	if (!quiet) {
@@ -197,6 +158,53 @@ players_set_super (bool_t quiet, const struct ENCOUNTERS *ee, struct PLAYERS *pl
 		printf ("players w/ all losses = %ld\n", counter_all_L);
 	}
 
+	return super;
+}
+
+player_t	
+players_set_super (bool_t quiet, const struct ENCOUNTERS *ee, struct PLAYERS *pl)
+{
+	// encounters
+	gamesnum_t N_enc = ee->n;
+	const struct ENC *enc = ee->enc;
+
+	// players
+	player_t n_players = pl->n;
+
+	double 		*obt;
+	gamesnum_t	*pla;
+	gamesnum_t	e;
+	player_t 	j;
+	player_t 	w, b;
+	player_t 	super;
+
+	obt = memnew (sizeof(double) * (size_t)n_players);
+	pla = memnew (sizeof(gamesnum_t) * (size_t)n_players);
+	if (NULL==obt || NULL==pla) {
+		fprintf(stderr, "Not enough memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (j = 0; j < n_players; j++) {
+		obt[j] = 0.0;	
+		pla[j] = 0;
+	}	
+	for (e = 0; e < N_enc; e++) {
+		w = enc[e].wh;
+		b = enc[e].bl;
+
+		assert(( w >= 0 && w < n_players) || !fprintf(stderr,"w=%ld np=%ld\n",(long)w,(long)n_players));
+		assert(( b >= 0 && b < n_players) || !fprintf(stderr,"b=%ld np=%ld\n",(long)b,(long)n_players));
+
+		obt[w] += enc[e].wscore;
+		obt[b] += (double)enc[e].played - enc[e].wscore;
+
+		pla[w] += enc[e].played;
+		pla[b] += enc[e].played;
+
+	}
+
+	super = players_set_perf (quiet, obt, pla, pl);
+
 	memrel(obt);
 	memrel(pla);
 	return super;
@@ -0,0 +1,253 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "radix.h"
+#include "mymem.h"
+
+#define RADIX_BITS 8
+#define RADIX_N (1 << RADIX_BITS)
+#define RADIX_PIECE_MIN 65536	// records, smaller pieces are not worth a thread
+
+struct RADIXPIECE {
+	size_t		count[RADIX_N];	// records of each digit, then where they go
+	uint64_t	max;			// of both fields
+	bool_t		sorted;
+};
+
+struct RADIXJOB {
+	unsigned char *		src;
+	unsigned char *		dst;
+	size_t				n;
+	size_t				size;
+	size_t				a_off;
+	size_t				b_off;
+	size_t				field;
+	unsigned			b_bits;		// the key is a << b_bits | b
+	unsigned			shift;		// of the digit of this pass
+	size_t				per_piece;
+	struct RADIXPIECE *	piece;
+};
+
+static uint64_t
+field_get (const unsigned char *p, size_t field)
+{
+	if (field == sizeof(uint32_t)) {
+		uint32_t x;
+		memcpy (&x, p, sizeof(x));
+		return x;
+	} else {
+		uint64_t x;
+		memcpy (&x, p, sizeof(x));
+		return x;
+	}
+}
+
+static uint64_t
+key_of (const struct RADIXJOB *j, const unsigned char *r)
+{
+	return field_get (r + j->a_off, j->field) << j->b_bits | field_get (r + j->b_off, j->field);
+}
+
+static void
+piece_limits (const struct RADIXJOB *j, long k, size_t *first, size_t *last)
+{
+	*first = (size_t)k * j->per_piece;
+	*last  = *first + j->per_piece < j->n? *first + j->per_piece: j->n;
+}
+
+// max of the fields and whether the piece is in order, including
+// its first record against the last one of the previous piece
+static void
+scan_range (void *arg, long first, long last, int worker)
+{
+	const struct RADIXJOB *j = arg;
+	long k;
+	(void)worker;
+
+	for (k = first; k < last; k++) {
+		struct RADIXPIECE *p = &j->piece[k];
+		uint64_t prev_a = 0, prev_b = 0;
+		size_t i, lo, hi;
+
+		piece_limits (j, k, &lo, &hi);
+		p->max = 0;
+		p->sorted = TRUE;
+		if (lo > 0) {
+			prev_a = field_get (j->src + (lo - 1) * j->size + j->a_off, j->field);
+			prev_b = field_get (j->src + (lo - 1) * j->size + j->b_off, j->field);
+		}
+		for (i = lo; i < hi; i++) {
+			const unsigned char *r = j->src + i * j->size;
+			uint64_t a = field_get (r + j->a_off, j->field);
+			uint64_t b = field_get (r + j->b_off, j->field);
+			if (a < prev_a || (a == prev_a && b < prev_b)) p->sorted = FALSE;
+			if (a > p->max) p->max = a;
+			if (b > p->max) p->max = b;
+			prev_a = a;
+			prev_b = b;
+		}
+	}
+}
+
+static void
+count_range (void *arg, long first, long last, int worker)
+{
+	const struct RADIXJOB *j = arg;
+	long k;
+	(void)worker;
+
+	for (k = first; k < last; k++) {
+		size_t *count = j->piece[k].count;
+		size_t i, lo, hi;
+
+		piece_limits (j, k, &lo, &hi);
+		memset (count, 0, sizeof(j->piece[k].count));
+		for (i = lo; i < hi; i++) {
+			count[(key_of (j, j->src + i * j->size) >> j->shift) & (RADIX_N - 1)]++;
+		}
+	}
+}
+
+static void
+scatter_range (void *arg, long first, long last, int worker)
+{
+	const struct RADIXJOB *j = arg;
+	long k;
+	(void)worker;
+
+	for (k = first; k < last; k++) {
+		size_t *where = j->piece[k].count;
+		size_t i, lo, hi;
+
+		piece_limits (j, k, &lo, &hi);
+		for (i = lo; i < hi; i++) {
+			const unsigned char *r = j->src + i * j->size;
+			size_t d = (size_t)((key_of (j, r) >> j->shift) & (RADIX_N - 1));
+			memcpy (j->dst + where[d]++ * j->size, r, j->size);
+		}
+	}
+}
+
+static void
+run_pieces (thpool_t *pool, long pieces, thpool_range_fn fn, struct RADIXJOB *j)
+{
+	if (pool != NULL && pieces > 1)
+		thpool_parallel_for (pool, 0, pieces, 1, fn, j);
+	else
+		fn (j, 0, pieces, 0);
+}
+
+static unsigned
+bits_of (uint64_t x)
+{
+	unsigned b = 0;
+	while (x > 0) {b++; x >>= 1;}
+	return b;
+}
+
+bool_t
+radix_sort_pairs	( void *base
+					, size_t n
+					, size_t size
+					, size_t a_off
+					, size_t b_off
+					, size_t field
+					, thpool_t *pool)
+{
+	struct RADIXJOB j;
+	unsigned char *tmp;
+	uint64_t max;
+	unsigned key_bits;
+	bool_t sorted;
+	long pieces, k;
+	size_t d;
+
+	assert (field == sizeof(uint32_t) || field == sizeof(uint64_t));
+	assert (a_off + field <= size && b_off + field <= size);
+
+	if (n < 2) return TRUE;
+
+	pieces = pool != NULL? thpool_workers (pool) + 1: 1;
+	if ((size_t)pieces > n / RADIX_PIECE_MIN)
+		pieces = n / RADIX_PIECE_MIN > 1? (long)(n / RADIX_PIECE_MIN): 1;
+
+	j.src		= base;
+	j.dst		= NULL;
+	j.n			= n;
+	j.size		= size;
+	j.a_off		= a_off;
+	j.b_off		= b_off;
+	j.field		= field;
+	j.b_bits	= 0;
+	j.shift		= 0;
+	j.per_piece	= (n + (size_t)pieces - 1) / (size_t)pieces;
+	j.piece		= memnew (sizeof(struct RADIXPIECE) * (size_t)pieces);
+	if (j.piece == NULL) return FALSE;
+
+	run_pieces (pool, pieces, scan_range, &j);
+	for (max = 0, sorted = TRUE, k = 0; k < pieces; k++) {
+		if (j.piece[k].max > max) max = j.piece[k].max;
+		sorted = sorted && j.piece[k].sorted;
+	}
+	j.b_bits = bits_of (max);
+	key_bits = 2 * j.b_bits;
+
+	if (sorted || key_bits > 64 || NULL == (tmp = memnew (n * size))) {
+		memrel (j.piece);
+		return sorted;
+	}
+	j.dst = tmp;
+
+	for (j.shift = 0; j.shift < key_bits; j.shift += RADIX_BITS) {
+		size_t pos = 0;
+		bool_t one_digit = FALSE;
+
+		run_pieces (pool, pieces, count_range, &j);
+
+		for (d = 0; d < RADIX_N && !one_digit; d++) {
+			size_t total = 0;
+			for (k = 0; k < pieces; k++) total += j.piece[k].count[d];
+			one_digit = total == n;
+		}
+		if (one_digit) continue; // this pass would not move anything
+
+		for (d = 0; d < RADIX_N; d++) {
+			for (k = 0; k < pieces; k++) {
+				size_t c = j.piece[k].count[d];
+				j.piece[k].count[d] = pos;
+				pos += c;
+			}
+		}
+
+		run_pieces (pool, pieces, scatter_range, &j);
+
+		{unsigned char *t = j.src; j.src = j.dst; j.dst = t;}
+	}
+
+	if (j.src != base) memcpy (base, j.src, n * size);
+
+	memrel (tmp);
+	memrel (j.piece);
+	return TRUE;
+}
@@ -0,0 +1,52 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_RADIX)
+#define H_RADIX
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include <stddef.h>
+#include "boolean.h"
+#include "thpool.h"
+
+/*
+|	Stable sort of n records of size bytes by a pair of player indexes
+|	they contain, first by the one at offset a_off, then by the one at
+|	b_off, as compare_GAME and compare_ENC do. Both fields are unsigned
+|	(or non negative) integers of field bytes, 4 or 8. The pair is packed
+|	in one 64 bit key and sorted in passes of 8 bits (least significant
+|	first), skipping the passes whose digit is the same for all records.
+|	An array already in order is detected and left untouched.
+|	Each pass runs in pieces over pool, unless it is NULL.
+|	FALSE if it could not be sorted (no memory, indexes too big), with
+|	the records left as they were, so the caller may use qsort instead.
+\*--------------------------------------------------------------*/
+
+extern bool_t
+radix_sort_pairs	( void *base
+					, size_t n
+					, size_t size
+					, size_t a_off
+					, size_t b_off
+					, size_t field
+					, thpool_t *pool);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
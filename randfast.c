@@ -21,6 +21,7 @@
 
 #include "randfast.h"
 #include "datatype.h"
+#include "pgnget.h"
 
 /*
 |
@@ -29,12 +30,7 @@
 |
 */
 
-typedef struct ranctx { 
-	uint32_t a; 
-	uint32_t b; 
-	uint32_t c; 
-	uint32_t d; 
-} ranctx;
+typedef struct ranctx ranctx;
 
 static ranctx Rndseries;
 
@@ -60,9 +56,13 @@ static void raninit ( ranctx *x, uint32_t seed )
     }
 }
 
+static void zig_init (void);
+
+// Must be called once before any thread uses the generators
 void randfast_init (uint32_t seed)
 {
 	raninit (&Rndseries, seed); 
+	zig_init ();
 }
 
 uint32_t randfast32 (void)
@@ -70,48 +70,155 @@ uint32_t randfast32 (void)
 	return ranval (&Rndseries); 
 }
 
+/*
+|	Reentrant versions. Each caller keeps its own state, so threads
+|	do not need to share (and lock) a single series. A given (seed, stream)
+|	pair always produces the same series.
+*/
+
+static uint32_t
+mix32 (uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+void ranctx_init (struct ranctx *x, uint32_t seed, uint32_t stream)
+{
+	raninit (x, mix32 (seed ^ mix32 (stream + 0x9e3779b9u))); 
+}
+
+uint32_t ranctx_val (struct ranctx *x)
+{
+	return ranval (x); 
+}
+
+// result of a game (WHITE_WIN, RESULT_DRAW or BLACK_WIN) with the given probabilities
+int
+rand_threeway_wscore(double pwin, double pdraw, struct ranctx *rng)
+{	
+	long z,x,y;
+	z = (long)((unsigned)(pwin * (0xffff+1)));
+	x = (long)((unsigned)((pwin+pdraw) * (0xffff+1)));
+	y = ranctx_val(rng) & 0xffff;
+
+	if (y < z) {
+		return WHITE_WIN;
+	} else if (y < x) {
+		return RESULT_DRAW;
+	} else {
+		return BLACK_WIN;		
+	}
+}
+
 
 //==========================================
-#include "gauss.h"
+/*
+|	Normal deviates, ziggurat method of Marsaglia & Tsang (2000)
+|	with 128 layers. Layer and abscissa come from independent
+|	32-bit draws. Only ~1.2% of the samples need exp() or log().
+*/
 
-static double
-rand_area (void)
+#include <math.h>
+#include <assert.h>
+
+#define ZIG_N 128
+#define ZIG_R 3.442619855899
+#define ZIG_V 9.91256303526217e-3
+#define ZIG_M 2147483648.0
+
+static uint32_t Zig_k[ZIG_N];
+static double 	Zig_w[ZIG_N];
+static double 	Zig_f[ZIG_N];
+static int		Zig_ready = 0;
+
+static void
+zig_init (void)
 {
-	uint32_t r;
-	double rr;
-	do {
-		r = randfast32();
-	} while (r == 0);
-	r &= 8191;
-	rr = (double) r;
-	rr = rr/8192;
-	return rr;
+	double dn = ZIG_R, tn = ZIG_R;
+	double q = ZIG_V / exp(-0.5*dn*dn);
+	int i;
+
+	Zig_k[0] = (uint32_t)((dn/q)*ZIG_M);
+	Zig_k[1] = 0;
+	Zig_w[0] = q/ZIG_M;
+	Zig_w[ZIG_N-1] = dn/ZIG_M;
+	Zig_f[0] = 1.0;
+	Zig_f[ZIG_N-1] = exp(-0.5*dn*dn);
+
+	for (i = ZIG_N-2; i >= 1; i--) {
+		dn = sqrt(-2.0*log(ZIG_V/dn + exp(-0.5*dn*dn)));
+		Zig_k[i+1] = (uint32_t)((dn/tn)*ZIG_M);
+		tn = dn;
+		Zig_f[i] = exp(-0.5*dn*dn);
+		Zig_w[i] = dn/ZIG_M;
+	}
+	Zig_ready = 1;
 }
 
+// uniform in (0,1)
+static double
+uni (ranctx *x)
+{
+	return ((double)ranval(x) + 0.5) / 4294967296.0;
+}
 
 static double
-rand_gauss_normalized(void)
+rand_gauss_normalized (ranctx *x)
 {
-	double xi, yi, area, slope;
-	double limit = 0.00001;
-	int n;
-
-	area = rand_area();
-	n = 0;
-	xi = 0;
-	do {
-		yi = gauss_integral (xi) - area;
-		slope = gauss_density (xi);
-		xi = xi - yi / slope;
-		n++;
-	} while (n < 100 && (yi > limit || yi < -limit));
-
-	return xi;
+	int32_t hz;
+	uint32_t az;
+	int iz;
+	double z, y;
+
+	assert (Zig_ready);
+
+	for (;;) {
+		hz = (int32_t)ranval(x);
+		iz = (int)(ranval(x) & (ZIG_N-1));
+		az = hz < 0? (uint32_t)(-(int64_t)hz): (uint32_t)hz;
+		z = (double)hz * Zig_w[iz];
+
+		if (az < Zig_k[iz]) 
+			return z; // inside the rectangle, most of the cases
+
+		if (iz == 0) {
+			// tail
+			do {
+				z = -log(uni(x)) / ZIG_R;
+				y = -log(uni(x));
+			} while (y+y < z*z);
+			return hz > 0? ZIG_R + z: -ZIG_R - z;
+		}
+
+		if (Zig_f[iz] + uni(x) * (Zig_f[iz-1] - Zig_f[iz]) < exp(-0.5*z*z))
+			return z;
+	}
 }
 
 double
 rand_gauss(double x, double s)
 {
-	double z = rand_gauss_normalized();
+	double z = rand_gauss_normalized (&Rndseries);
 	return x + z * s;
 }
+
+double
+rand_gauss_r (struct ranctx *r, double x, double s)
+{
+	double z = rand_gauss_normalized (r);
+	return x + z * s;
+}
+
+// fills z[] with n standard normal deviates
+void
+rand_gauss_fill_r (struct ranctx *r, double *z, size_t n)
+{
+	size_t i;
+	for (i = 0; i < n; i++) 
+		z[i] = rand_gauss_normalized (r);
+}
@@ -26,10 +26,24 @@
 #include "datatype.h"
 #include "mytypes.h"
 
+struct ranctx { 
+	uint32_t a; 
+	uint32_t b; 
+	uint32_t c; 
+	uint32_t d; 
+};
+
 extern void 		randfast_init (uint32_t seed);
 extern uint32_t 	randfast32 (void);
 
 extern double		rand_gauss(double x, double s);
 
+// reentrant, state provided by the caller
+extern void 		ranctx_init (struct ranctx *x, uint32_t seed, uint32_t stream);
+extern uint32_t 	ranctx_val (struct ranctx *x);
+extern int			rand_threeway_wscore (double pwin, double pdraw, struct ranctx *rng);
+extern double		rand_gauss_r (struct ranctx *r, double x, double s);
+extern void			rand_gauss_fill_r (struct ranctx *r, double *z, size_t n);
+
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 #endif
@@ -32,6 +32,7 @@
 #include "fit1d.h"
 
 #include "mytimer.h"
+#include "stats.h"
 
 #define START_DELTA           100
 #define MIN_DEVIA             0.0000001
@@ -89,6 +90,7 @@ unfitness		( const struct ENC *enc
 )
 {
 		double dev;
+		STAT_INC (STAT_UNFITNESS);
 		calc_expected (enc, n_enc, white_adv, n_players, ratingof, expected, beta);
 		dev = deviation (n_players, flagged, expected, obtained, playedby);
 		assert(!is_nan(dev));
@@ -553,6 +555,33 @@ get_outputdev (double curdev, gamesnum_t n_games)
 	return 1000*sqrt(curdev/(double)n_games);
 }
 
+// players with all wins or all losses are rated from the others, then the
+// encounters they played are left out again
+static gamesnum_t
+post_convergence	( bool_t quiet
+					, struct ENCOUNTERS *encount
+					, struct PLAYERS *plyrs
+					, const struct ENCOUNTERS *encount_full
+					, struct RATINGS *rat
+					, double white_adv
+					, double draw_rate
+					, double BETA)
+{
+	encounters_select (ENCOUNTERS_FULL, encount_full, plyrs->flagged, encount);
+
+	calc_obtained_playedby(encount->enc, encount->n, plyrs->n, rat->obtained, rat->playedby);
+
+	if (!quiet) timelog("rate_super_players...");
+
+	rate_super_players(quiet, encount->enc, encount->n, plyrs->performance_type, plyrs->n, rat->ratingof, white_adv, plyrs->flagged, plyrs->name, draw_rate, BETA); 
+
+	encounters_select (ENCOUNTERS_NOFLAGGED, encount_full, plyrs->flagged, encount);
+
+	calc_obtained_playedby(encount->enc, encount->n, plyrs->n, rat->obtained, rat->playedby);
+
+	return encount->n;
+}
+
 gamesnum_t
 calc_rating_ordo 	
 				( bool_t 			quiet
@@ -568,14 +597,16 @@ calc_rating_ordo
 
 				, struct ENCOUNTERS *encount
 				, struct PLAYERS 	*plyrs
-				, struct GAMES 		*g
+				, const struct ENCOUNTERS *encount_full
 				, struct RATINGS 	*rat
+				, struct ENCMERGE	*merge
 
 				, double			*pWhite_advantage
 				, double			*pDraw_date
+				, struct CONVERGENCE *conv
 )
 {
-	gamesnum_t	n_games = g->n;
+	gamesnum_t	n_games = encounters_played (encount_full);
 	double 	*	ratingtmp = ratingtmp_buffer;
 	double 		olddev, curdev;
 	int 		i;
@@ -590,6 +621,8 @@ calc_rating_ordo
 	double 		resol;
 	int 		max_cycle;
 	int 		cycle;
+	long		iterations = 0;
+	int			phases = 0;
 
 	double 		white_adv = *pWhite_advantage;
 	double 		wa_previous = *pWhite_advantage;
@@ -599,17 +632,16 @@ calc_rating_ordo
 	double *	expected = NULL;
 
 	// translation variables for refactoring ------------------
-	struct ENC *	enc   			= encount->enc;
+	const struct ENC *enc  			= encount->enc;
 	gamesnum_t		n_enc 			= encount->n;
 	player_t		n_players 		= plyrs->n;
-	int *			Performance_type= plyrs->performance_type;
 	bool_t *		flagged 		= plyrs->flagged;
 	bool_t *		prefed  		= plyrs->prefed;
-	const char **	name 			= plyrs->name;
 	double *		obtained 		= rat->obtained;	
 	gamesnum_t *	playedby 		= rat->playedby;
 	double *		ratingof 		= rat->ratingof;
 	double *		ratingbk 		= rat->ratingbk;
+	const struct ENC *merged;
 	player_t		anchored_n 		= plyrs->anchored_n;
 	//----------------------------------------------------------
 
@@ -621,6 +653,13 @@ calc_rating_ordo
 		exit(EXIT_FAILURE);
 	}
 
+	// without white advantage the colors do not matter, fewer encounters.
+	// Sums are in another order, tied players may come out the other way
+	if (merge != NULL && white_adv == 0 && !adjust_white_advantage
+		&& NULL != (merged = encmerge_apply (merge, encount, &n_enc))) {
+		enc = merged;
+	}
+
 	max_cycle = adjust_white_advantage? 4: 1;
 
 	for (resol = START_RESOL, cycle = 0; 
@@ -690,6 +729,7 @@ calc_rating_ordo
 				failed = curdev >= olddev;
 
 				if (failed) {
+					STAT_INC (STAT_ROLLBACKS);
 					ratings_copyto (n_players, ratingbk, ratingof); // restore
 					curdev = unfitness ( enc, n_enc, n_players, ratingof, flagged, white_adv, BETA, obtained, playedby, expected);
 					assert (i == 0 || absol(curdev-olddev) < PRECISIONERROR || 
@@ -728,6 +768,7 @@ calc_rating_ordo
 
 			} // end rounds
 
+			iterations += i;
 			delta /= damp_delta;
 			kappa *= damp_kappa;
 
@@ -738,6 +779,7 @@ calc_rating_ordo
 				printf ("\n");
 			}
 			phase++;
+			phases++;
 
 		} // end n-->0
 
@@ -766,30 +808,263 @@ calc_rating_ordo
 		correct_excess (n_players, flagged, excess, ratingof);
 	}
 
-	timelog("Post-Convergence rating estimation...");
+	if (!quiet) timelog("Post-Convergence rating estimation...");
 
-	encounters_calculate(ENCOUNTERS_FULL, g, flagged, encount);
-	enc   = encount->enc;
-	n_enc = encount->n;
+	n_enc = post_convergence (quiet, encount, plyrs, encount_full, rat, white_adv, draw_rate, BETA);
 
-	calc_obtained_playedby(enc, n_enc, n_players, obtained, playedby);
+	if (!quiet) timelog("done with rating calculation.");
 
-	timelog("rate_super_players...");
+	*pWhite_advantage = white_adv;
+	*pDraw_date = draw_rate;
+
+	if (conv) {
+		conv->phases = phases;
+		conv->iterations = iterations;
+		conv->deviation = get_outputdev (curdev, n_games);
+	}
+	profile_iterations (iterations);
+	STAT_ADD (STAT_ITERATIONS, iterations);
+
+	memrel(expected);
+	return n_enc;
+}
 
-	rate_super_players(quiet, enc, n_enc, Performance_type, n_players, ratingof, white_adv, flagged, name, draw_rate, BETA); 
 
-	encounters_calculate(ENCOUNTERS_NOFLAGGED, g, flagged, encount);
-	enc   = encount->enc;
-	n_enc = encount->n;
+/*
+|
+|	APPROXIMATE RATINGS
+|
+\*--------------------------------------------------------------*/
+
+#define ADAM_BETA1	0.9
+#define ADAM_BETA2	0.999
+#define ADAM_EPS	1E-8
+#define ADAM_RATE	50.0	// rating points per step at the start
+
+struct ADAM {
+	  double *	m
+	; double *	v
+	; long		t
+	;
+};
+
+static void
+adam_step (struct ADAM *a, player_t j, double grad, double rate, double *x)
+{
+	double mh, vh;
+	a->m[j] = ADAM_BETA1 * a->m[j] + (1.0 - ADAM_BETA1) * grad;
+	a->v[j] = ADAM_BETA2 * a->v[j] + (1.0 - ADAM_BETA2) * grad * grad;
+	mh = a->m[j] / (1.0 - pow (ADAM_BETA1, (double)a->t));
+	vh = a->v[j] / (1.0 - pow (ADAM_BETA2, (double)a->t));
+	*x += rate * mh / (sqrt(vh) + ADAM_EPS);
+}
+
+static bool_t
+is_mobile (player_t j, player_t anchored_n, const bool_t *flagged, const bool_t *prefed)
+{
+	return !flagged[j] && !(anchored_n > 1 && prefed[j]);
+}
+
+// smallest step that visits every batch once per epoch, far from its neighbour
+static gamesnum_t
+batch_stride (gamesnum_t nb)
+{
+	gamesnum_t p = nb / 2 + 1;
+	gamesnum_t a, b, t;
+	for (;; p++) {
+		for (a = p, b = nb; b != 0; t = a % b, a = b, b = t) {}
+		if (a == 1) return p;
+	}
+}
+
+// one Newton step for each player, on all the encounters
+static void
+exact_step	( const struct ENC *enc
+			, gamesnum_t n_enc
+			, player_t n_players
+			, player_t anchored_n
+			, const bool_t *flagged
+			, const bool_t *prefed
+			, double white_adv
+			, double beta
+			, double *info
+			, double *ratingof
+			, double *expected
+			, const double *obtained)
+{
+	gamesnum_t e;
+	player_t j;
+
+	calc_expected (enc, n_enc, white_adv, n_players, ratingof, expected, beta);
+
+	for (j = 0; j < n_players; j++) info[j] = 0;
+	for (e = 0; e < n_enc; e++) {
+		double p = xpect (ratingof[enc[e].wh] + white_adv, ratingof[enc[e].bl], beta);
+		double x = (double)enc[e].played * p * (1.0 - p);
+		info[enc[e].wh] += x;
+		info[enc[e].bl] += x;
+	}
+	for (j = 0; j < n_players; j++) {
+		if (is_mobile (j, anchored_n, flagged, prefed) && info[j] > 0)
+			ratingof[j] += (obtained[j] - expected[j]) / (beta * info[j]);
+	}
+}
+
+gamesnum_t
+calc_rating_approx
+				( bool_t 			quiet
+				, bool_t 			adjust_white_advantage
+				, bool_t			adjust_draw_rate
+				, bool_t			anchor_use
+				, const struct APPROXCTRL *ac
+
+				, double			BETA
+				, double			general_average
+				, player_t			anchor
+
+				, struct ENCOUNTERS *encount
+				, struct PLAYERS 	*plyrs
+				, const struct ENCOUNTERS *encount_full
+				, struct RATINGS 	*rat
+
+				, double			*pWhite_advantage
+				, double			*pDraw_date
+				, struct CONVERGENCE *conv
+)
+{
+	gamesnum_t	n_games 		= encounters_played (encount_full);
+	struct ENC *enc   			= encount->enc;
+	gamesnum_t	n_enc 			= encount->n;
+	const struct ENC *full		= encount_full->enc;	// mapped from disk with --tmpdir
+	gamesnum_t	n_full			= encount_full->n;
+	player_t	n_players 		= plyrs->n;
+	bool_t *	flagged 		= plyrs->flagged;
+	bool_t *	prefed  		= plyrs->prefed;
+	player_t	anchored_n 		= plyrs->anchored_n;
+	double *	obtained 		= rat->obtained;	
+	gamesnum_t *playedby 		= rat->playedby;
+	double *	ratingof 		= rat->ratingof;
+
+	double		white_adv		= *pWhite_advantage;
+	double		draw_rate		= *pDraw_date;
+	double		wa_m = 0, wa_v = 0;
+	gamesnum_t	batch 			= ac->batch > 0? (gamesnum_t)ac->batch: 1;
+	gamesnum_t	nb 				= (n_full + batch - 1) / batch;
+	gamesnum_t	stride, k, b, e;
+	long		epoch, iterations = 0;
+	double		curdev, deviation;
+	int			x;
+	player_t	j;
+
+	struct ADAM adam;
+	double *	grad;
+	double *	expected;
+	double *	info;
+
+	adam.m		= memnew (sizeof(double) * (size_t)n_players);
+	adam.v		= memnew (sizeof(double) * (size_t)n_players);
+	adam.t		= 0;
+	grad		= memnew (sizeof(double) * (size_t)n_players);
+	expected	= memnew (sizeof(double) * (size_t)(n_players+1));
+	info		= memnew (sizeof(double) * (size_t)n_players);
+	if (!adam.m || !adam.v || !grad || !expected || !info) {
+		fprintf(stderr, "Not enough memory to allocate all players\n");
+		exit(EXIT_FAILURE);
+	}
+	for (j = 0; j < n_players; j++) {
+		adam.m[j] = adam.v[j] = grad[j] = 0;
+	}
+
+	// minibatch b has the encounters b, b+nb, b+2nb... of the full list, so
+	// it mixes players. Those of purged players are skipped, not copied out
+	stride = nb > 2? batch_stride (nb): 1;
+
+	if (!quiet) printf ("\nApproximate rating calculation (%ld epochs, %ld encounters per batch)\n\n", ac->epochs, (long)batch);
+
+	for (epoch = 0; epoch < ac->epochs; epoch++) {
+		double rate = ADAM_RATE / sqrt ((double)(epoch + 1));
+
+		for (k = 0, b = 0; k < nb; k++, b = (b + stride) % nb) {
+			double wa_grad = 0;
+
+			for (e = b; e < n_full; e += nb) {
+				double g;
+				if (flagged[full[e].wh] || flagged[full[e].bl]) continue;
+				g = BETA * (full[e].wscore - (double)full[e].played * xpect (ratingof[full[e].wh] + white_adv, ratingof[full[e].bl], BETA));
+				grad[full[e].wh] += g;
+				grad[full[e].bl] -= g;
+				wa_grad += g;
+			}
+
+			adam.t++;
+			for (e = b; e < n_full; e += nb) {
+				player_t p[2];
+				p[0] = full[e].wh;
+				p[1] = full[e].bl;
+				for (x = 0; x < 2; x++) {
+					if (grad[p[x]] == 0) continue; // already stepped in this batch, or purged
+					if (is_mobile (p[x], anchored_n, flagged, prefed))
+						adam_step (&adam, p[x], grad[p[x]], rate, &ratingof[p[x]]);
+					grad[p[x]] = 0;
+				}
+			}
+			if (adjust_white_advantage) {
+				wa_m = ADAM_BETA1 * wa_m + (1.0 - ADAM_BETA1) * wa_grad;
+				wa_v = ADAM_BETA2 * wa_v + (1.0 - ADAM_BETA2) * wa_grad * wa_grad;
+				white_adv += rate * (wa_m / (1.0 - pow (ADAM_BETA1, (double)adam.t))) 
+							/ (sqrt (wa_v / (1.0 - pow (ADAM_BETA2, (double)adam.t))) + ADAM_EPS);
+			}
+		}
+		iterations++;
+	}
 
 	calc_obtained_playedby(enc, n_enc, n_players, obtained, playedby);
 
-	timelog("done with rating calculation.");
+	for (x = 0; x < ac->exact; x++) {
+		exact_step (enc, n_enc, n_players, anchored_n, flagged, prefed, white_adv, BETA, info, ratingof, expected, obtained);
+		if (adjust_white_advantage)
+			white_adv = adjust_wadv (white_adv, ratingof, n_enc, enc, BETA, MIN_RESOL);
+		iterations++;
+	}
+
+	if (adjust_draw_rate) {
+		draw_rate = adjust_drawrate (white_adv, ratingof, n_enc, enc, BETA);
+	}
+
+	if (anchored_n == 1 && anchor_use)
+		adjust_rating_byanchor (anchor, general_average, n_players, ratingof);
+
+	if (anchored_n == 0) {
+		double excess = calc_excess (n_players, flagged, general_average, ratingof);
+		correct_excess (n_players, flagged, excess, ratingof);
+	}
+
+	curdev = unfitness (enc, n_enc, n_players, ratingof, flagged, white_adv, BETA, obtained, playedby, expected);
+	deviation = get_outputdev (curdev, n_games);
+
+	if (!quiet) {
+		printf ("Deviation reached = %.9f\n", deviation);
+		printf ("\nWhite Advantage = %.1f", white_adv);
+		printf ("\nDraw Rate (eq.) = %.1f %s\n\n", 100*draw_rate, "%");
+	}
+
+	n_enc = post_convergence (quiet, encount, plyrs, encount_full, rat, white_adv, draw_rate, BETA);
 
 	*pWhite_advantage = white_adv;
 	*pDraw_date = draw_rate;
 
-	memrel(expected);
+	if (conv) {
+		conv->phases = 1 + (ac->exact > 0);
+		conv->iterations = iterations;
+		conv->deviation = deviation;
+	}
+	profile_iterations (iterations);
+	STAT_ADD (STAT_ITERATIONS, iterations);
+
+	memrel (info);
+	memrel (expected);
+	memrel (grad);
+	memrel (adam.v);
+	memrel (adam.m);
 	return n_enc;
 }
-
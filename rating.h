@@ -40,11 +40,42 @@ calc_rating_ordo
 
 				, struct ENCOUNTERS *encount
 				, struct PLAYERS 	*plyrs
-				, struct GAMES 		*g
+				, const struct ENCOUNTERS *encount_full
 				, struct RATINGS 	*rat
+				, struct ENCMERGE	*merge			// kept between calls, may be NULL
 
 				, double			*pWhite_advantage
 				, double			*pDraw_date
+				, struct CONVERGENCE *conv			// out, may be NULL
+)
+;
+
+/*
+|	Approximate ratings of the same likelihood, without priors. Adam steps
+|	over minibatches of encounters, then ac->exact full-batch Newton
+|	steps. The deviation reached is returned in conv, in the same units
+|	printed by calc_rating_ordo.
+*/
+gamesnum_t
+calc_rating_approx
+				( bool_t 			quiet
+				, bool_t 			adjust_white_advantage
+				, bool_t			adjust_draw_rate
+				, bool_t			anchor_use
+				, const struct APPROXCTRL *ac
+
+				, double			BETA
+				, double			general_average
+				, player_t			anchor
+
+				, struct ENCOUNTERS *encount
+				, struct PLAYERS 	*plyrs
+				, const struct ENCOUNTERS *encount_full
+				, struct RATINGS 	*rat
+
+				, double			*pWhite_advantage
+				, double			*pDraw_date
+				, struct CONVERGENCE *conv			// out, may be NULL
 )
 ;
 
@@ -29,6 +29,8 @@
 #include "indiv.h"
 #include "xpect.h"
 #include "mymem.h"
+#include "mytimer.h"
+#include "stats.h"
 
 #define MIN_RESOLUTION           0.000001
 #define MIN_DRAW_RATE_RESOLUTION 0.00001
@@ -245,7 +247,7 @@ calc_rating_bayes
 
 			, struct ENCOUNTERS *	encount
 			, struct PLAYERS *		plyrs
-			, struct GAMES *		g
+			, const struct ENCOUNTERS *encount_full
 			, struct RATINGS *		rat
 
 			, struct prior *		pp
@@ -255,9 +257,10 @@ calc_rating_bayes
 
 			, double *				pwadv
 			, double *				pDraw_date
+			, struct CONVERGENCE *	conv
 )
 {
-	gamesnum_t  n_games = g->n;
+	gamesnum_t  n_games = encounters_played (encount_full);
 	double 		olddev, curdev, outputdev;
 	int 		i;
 	int			rounds = 10000;
@@ -265,6 +268,7 @@ calc_rating_bayes
 	double 		delta = rtng_76; //should be proportional to the scale
 	double 		denom = 3;
 	int 		phase = 0;
+	long		iterations = 0;
 	int 		n = 40;
 	double 		resol = delta;
 	double  	resol_dr = 0.1;
@@ -380,12 +384,14 @@ calc_rating_bayes
 				ratings_backup  (n_players, ratingof, ratingbk);
 				olddev = curdev;
 			} else {
+				STAT_INC (STAT_ROLLBACKS);
 				ratings_restore (n_players, ratingbk, ratingof);
 				curdev = olddev;
 				break;
 			}
 		}
 
+		iterations += i;
 		delta /=  denom;
 		outputdev = curdev/(double)n_games;
 
@@ -447,7 +453,7 @@ calc_rating_bayes
 
 //	n_enc = calc_encounters(ENCOUNTERS_FULL, g, flagged, enc);
 
-	encounters_calculate(ENCOUNTERS_FULL, g, flagged, encount);
+	encounters_select (ENCOUNTERS_FULL, encount_full, flagged, encount);
 	enc   = encount->enc;
 	n_enc = encount->n;
 
@@ -455,7 +461,7 @@ calc_rating_bayes
 	rate_super_players(quiet, enc, n_enc, performance_type, n_players, ratingof, white_advantage, flagged, name, deq, beta); 
 //	n_enc = calc_encounters(ENCOUNTERS_NOFLAGGED, g, flagged, enc);
 
-	encounters_calculate(ENCOUNTERS_NOFLAGGED, g, flagged, encount);
+	encounters_select (ENCOUNTERS_NOFLAGGED, encount_full, flagged, encount);
 	enc   = encount->enc;
 	n_enc = encount->n;
 
@@ -467,6 +473,14 @@ calc_rating_bayes
 	*pDraw_date = deq;
 	*pwadv = white_advantage;
 
+	if (conv) {
+		conv->phases = phase;
+		conv->iterations = iterations;
+		conv->deviation = 0;
+	}
+	profile_iterations (iterations);
+	STAT_ADD (STAT_ITERATIONS, iterations);
+
 	memrel(probarr);
 
 	return n_enc;
@@ -545,6 +559,8 @@ calc_bayes_unfitness_full
 
 	assert(deq <= 1 && deq >= 0);
 
+	STAT_INC (STAT_UNFITNESS_BAYES);
+
 	for (accum = 0, e = 0; e < n_enc; e++) {
 	
 		w = enc[e].wh;
@@ -614,7 +630,7 @@ probarray_reset(player_t n_players, double *probarray)
 }
 
 // no globals
-static void
+void
 probarray_build	( gamesnum_t n_enc
 				, const struct ENC *enc
 				, double inputdelta
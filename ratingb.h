@@ -42,7 +42,7 @@ calc_rating_bayes
 
 			, struct ENCOUNTERS *	encount
 			, struct PLAYERS *		plyrs
-			, struct GAMES *		g
+			, const struct ENCOUNTERS *encount_full
 			, struct RATINGS *		rat
 
 			, struct prior *		pp
@@ -52,9 +52,24 @@ calc_rating_bayes
 
 			, double *				pwadv
 			, double *				pDraw_date
+			, struct CONVERGENCE *	conv				// out, may be NULL
 )
 ;
 
+/*
+|	Accumulates, with negative sign, the log likelihood of the games of
+|	each player j when its rating is moved by -delta, 0 and +delta, in
+|	probarray[4*j+0], [4*j+1] and [4*j+2]. The array is not reset.
+*/
+extern void
+probarray_build	( gamesnum_t n_enc
+				, const struct ENC *enc
+				, double inputdelta
+				, double deq
+				, double beta
+				, double *ratingof
+				, double white_advantage
+				, double *probarray);
 
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 #endif
@@ -47,20 +47,23 @@ static bool_t getnum(char *p, double *px)
 //====================== RELATIVE PRIORS ====================================================================
 
 void
-relpriors_shuffle (struct rel_prior_set *rps /*@out@*/)
+relpriors_shuffle (struct rel_prior_set *rps /*@out@*/, struct ranctx *rng)
 {
-	player_t i;
-	double value, sigma;
+	enum {CHUNK = 64};
+	double z[CHUNK];
+	player_t i, j, m;
 	struct relprior *rp;
 	player_t n;
 
 	n  = rps->n;
 	rp = rps->x;
 
-	for (i = 0; i < n; i++) {
-		value = rp[i].delta;
-		sigma =	rp[i].sigma;	
-		rp[i].delta = rand_gauss (value, sigma);
+	for (i = 0; i < n; i += m) {
+		m = n - i < CHUNK? n - i: CHUNK;
+		rand_gauss_fill_r (rng, z, (size_t)m);
+		for (j = 0; j < m; j++) {
+			rp[i+j].delta += rp[i+j].sigma * z[j];
+		}
 	}
 }
 
@@ -145,7 +148,7 @@ rman_assign_relative_prior__ (const struct PLAYERS *plyrs, char *s, char *z, dou
 	} else {
 		if (y < PRIOR_SMALLEST_SIGMA) {
 			fprintf (stderr,"sigma too small\n");
-			exit(EXIT_FAILURE);
+			suc = FALSE;
 		} else {
 			suc = rman_set_relprior__ (plyrs, s, z, x, y, rm);
 			if (suc) {
@@ -160,7 +163,7 @@ rman_assign_relative_prior__ (const struct PLAYERS *plyrs, char *s, char *z, dou
 	return prior_success;
 }
 
-void
+bool_t
 relpriors_init 	( bool_t quietmode
 				, const struct PLAYERS *plyrs
 				, const char *f_name
@@ -184,7 +187,7 @@ relpriors_init 	( bool_t quietmode
 
 	if (NULL == f_name) {
 		fprintf (stderr, "Error, file not provided, absent, or corrupted\n");
-		exit(EXIT_FAILURE);
+		return FALSE;
 	}
 
 	if (NULL != (fil = fopen (f_name, "r"))) {
@@ -213,28 +216,30 @@ relpriors_init 	( bool_t quietmode
 					csv_line_done(&csvln);		
 				} else {
 					printf ("Failure to input -r file\n");	
-					exit(EXIT_FAILURE);
+					success = FALSE;
 				}
 			
 				if (!success) {
 					printf ("Problems with input in -r file\n");	
-					exit(EXIT_FAILURE);
 				}
 
 				file_success = success;
 
-				prior_success = rman_assign_relative_prior__ (plyrs, s, z, x, y, quietmode, &rpmanager);
+				if (file_success)
+					prior_success = rman_assign_relative_prior__ (plyrs, s, z, x, y, quietmode, &rpmanager);
 
 			}
 
-			rps->x 	= rpman_to_newarray (&rpmanager, &rps->n);
-			bak->x	= rpman_to_newarray (&rpmanager, &bak->n);
+			if (file_success && prior_success) {
+				rps->x 	= rpman_to_newarray (&rpmanager, &rps->n);
+				bak->x	= rpman_to_newarray (&rpmanager, &bak->n);
 
-			if (rps->x == NULL || bak->x == NULL) {
-				if (rps->x != NULL) {memrel (rps->x); rps->n = 0;}
-				if (bak->x != NULL) {memrel (bak->x); bak->n = 0;}
-				fprintf (stderr, "Not enough memory for relative priors\n");
-				exit(EXIT_FAILURE);
+				if (rps->x == NULL || bak->x == NULL) {
+					if (rps->x != NULL) {memrel (rps->x); rps->x = NULL; rps->n = 0;}
+					if (bak->x != NULL) {memrel (bak->x); bak->x = NULL; bak->n = 0;}
+					fprintf (stderr, "Not enough memory for relative priors\n");
+					prior_success = FALSE;
+				}
 			}
 
 			rpman_done(&rpmanager);
@@ -251,14 +256,14 @@ relpriors_init 	( bool_t quietmode
 
 	if (!file_success) {
 			fprintf (stderr, "Errors in file \"%s\"\n",f_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
 	if (!prior_success) {
 			fprintf (stderr, "Errors in file \"%s\" (not matching names)\n",f_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
 
-	return;
+	return TRUE;
 }
 
 void
@@ -286,9 +291,9 @@ relpriors_done2 (struct rel_prior_set *rps /*@out@*/, struct rel_prior_set *rps_
 //};
 
 bool_t 
-relpriors_replicate (struct rel_prior_set *rps, struct rel_prior_set *rps_dup)
+relpriors_replicate (const struct rel_prior_set *rps, struct rel_prior_set *rps_dup)
 {
-	struct relprior *x;
+	const struct relprior *x;
 	struct relprior *newx = NULL;
 	player_t n, i;
 	n = rps->n;
@@ -309,10 +314,17 @@ relpriors_replicate (struct rel_prior_set *rps, struct rel_prior_set *rps_dup)
 
 #include <math.h>
 
-player_t 	Priored_n = 0;
-
 bool_t has_a_prior(struct prior *pr, player_t j) {return pr[j].isset;}
 
+player_t
+priors_count (const struct prior *p, player_t n)
+{	player_t i, c = 0;
+	for (i = 0; i < n; i++) {
+		if (p[i].isset) c++;
+	}
+	return c;
+}
+
 void
 priors_reset(struct prior *p, player_t n)
 {	player_t i;
@@ -321,7 +333,6 @@ priors_reset(struct prior *p, player_t n)
 		p[i].sigma = 1;
 		p[i].isset = FALSE;
 	}
-	Priored_n = 0;
 }
 
 void
@@ -333,7 +344,7 @@ priors_copy(const struct prior *p, player_t n, struct prior *q)
 }
 
 void
-priors_shuffle(struct prior *p, player_t n)
+priors_shuffle(struct prior *p, player_t n, struct ranctx *rng)
 {
 	player_t i;
 	double value, sigma;
@@ -341,7 +352,7 @@ priors_shuffle(struct prior *p, player_t n)
 		if (p[i].isset) {
 			value = p[i].value;
 			sigma = p[i].sigma;
-			p[i].value = rand_gauss (value, sigma);
+			p[i].value = rand_gauss_r (rng, value, sigma);
 		}
 	}
 }
@@ -350,7 +361,7 @@ void
 priors_show (const struct PLAYERS *plyrs, struct prior *p, player_t n)
 { 
 	player_t i;
-	if (Priored_n > 0) {
+	if (priors_count (p, n) > 0) {
 		printf ("Loose Anchors {\n");
 		for (i = 0; i < n; i++) {
 			if (p[i].isset) {
@@ -374,7 +385,6 @@ set_prior (const struct PLAYERS *plyrs, const char *player_name, double x, doubl
 		pr[j].value = x;
 		pr[j].sigma = sigma;
 		pr[j].isset = TRUE;
-		Priored_n++;
 	}
 	return found;
 }
@@ -412,7 +422,7 @@ assign_prior (char *name_prior, double x, double y, bool_t quiet, struct RATINGS
 	return prior_success;
 }
 
-void
+bool_t
 priors_load (bool_t quietmode, const char *fpriors_name, struct RATINGS *rat /*@out@*/, struct PLAYERS *plyrs /*@out@*/, struct prior *pr /*@out@*/)
 {
 	FILE *fpriors;
@@ -428,7 +438,7 @@ priors_load (bool_t quietmode, const char *fpriors_name, struct RATINGS *rat /*@
 
 	if (NULL == fpriors_name) {
 		fprintf (stderr, "Error, file not provided, absent, or corrupted\n");
-		exit(EXIT_FAILURE);
+		return FALSE;
 	}
 
 	if (NULL != (fpriors = fopen (fpriors_name, "r"))) {
@@ -460,11 +470,12 @@ priors_load (bool_t quietmode, const char *fpriors_name, struct RATINGS *rat /*@
 				csv_line_done(&csvln);		
 			} else {
 				fprintf (stderr, "Failure to input -y file\n");
-				exit(EXIT_FAILURE);
+				success = FALSE;
 			}
 
 			file_success = success;
-			prior_success = assign_prior (name_prior, x, y, quietmode, rat, plyrs, pr);
+			if (file_success)
+				prior_success = assign_prior (name_prior, x, y, quietmode, rat, plyrs, pr);
 		}
 
 		fclose(fpriors);
@@ -475,14 +486,14 @@ priors_load (bool_t quietmode, const char *fpriors_name, struct RATINGS *rat /*@
 
 	if (!file_success) {
 			fprintf (stderr, "Errors in file \"%s\"\n",fpriors_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
 	if (!prior_success) {
 			fprintf (stderr, "Errors in file \"%s\" (not matching names)\n",fpriors_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
 
-	return;
+	return TRUE;
 }
 
 //====================== ANCHORS ============================================================================
@@ -519,7 +530,7 @@ assign_anchor (char *name_pinned, double x, bool_t quiet, struct RATINGS *rat /*
 	return pin_success;
 }
 
-void
+bool_t
 init_manchors (bool_t quietmode, const char *fpins_name, struct RATINGS *rat /*@out@*/, struct PLAYERS *plyrs /*@out@*/)
 {
 	FILE *fpins;
@@ -535,7 +546,7 @@ init_manchors (bool_t quietmode, const char *fpins_name, struct RATINGS *rat /*@
 
 	if (NULL == fpins_name) {
 		fprintf (stderr, "Error, file not provided, absent, or corrupted\n");
-		exit(EXIT_FAILURE);
+		return FALSE;
 	}
 
 	if (NULL != (fpins = fopen (fpins_name, "r"))) {
@@ -558,10 +569,11 @@ init_manchors (bool_t quietmode, const char *fpins_name, struct RATINGS *rat /*@
 				csv_line_done(&csvln);		
 			} else {
 				printf ("Failure to input -m file\n");
-				exit(EXIT_FAILURE);
+				success = FALSE;
 			}
 			file_success = success;
-			pin_success = assign_anchor (name_pinned, x, quietmode, rat, plyrs);
+			if (file_success)
+				pin_success = assign_anchor (name_pinned, x, quietmode, rat, plyrs);
 		}
 
 		fclose(fpins);
@@ -572,12 +584,12 @@ init_manchors (bool_t quietmode, const char *fpins_name, struct RATINGS *rat /*@
 
 	if (!file_success) {
 			fprintf (stderr, "Errors in file \"%s\"\n",fpins_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
 	if (!pin_success) {
 			fprintf (stderr, "Errors in file \"%s\" (not matching names)\n",fpins_name);
-			exit(EXIT_FAILURE);
+			return FALSE;
 	}
-	return;
+	return TRUE;
 }
 
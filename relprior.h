@@ -23,11 +23,12 @@
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 #include "mytypes.h"
+#include "randfast.h"
 
-extern void		relpriors_shuffle	(struct rel_prior_set *rps /*@out@*/);
+extern void		relpriors_shuffle	(struct rel_prior_set *rps /*@out@*/, struct ranctx *rng);
 extern void		relpriors_copy		(const struct rel_prior_set *r, struct rel_prior_set *s /*@out@*/);
 extern void 	relpriors_show		(const struct PLAYERS *plyrs, const struct rel_prior_set *rps);
-extern void 	relpriors_init 		( bool_t quietmode
+extern bool_t 	relpriors_init 		( bool_t quietmode
 									, const struct PLAYERS *plyrs
 									, const char *f_name
 									, struct rel_prior_set *rps /*@out@*/
@@ -38,23 +39,20 @@ extern void		relpriors_done2		( struct rel_prior_set *rps /*@out@*/
 
 extern void		relpriors_done1		( struct rel_prior_set *rps /*@out@*/);
 
-extern bool_t 	relpriors_replicate	( struct rel_prior_set *rps, struct rel_prior_set *rps_dup);
-
-//----------------------------------
-
-extern player_t	Priored_n;
+extern bool_t 	relpriors_replicate	( const struct rel_prior_set *rps, struct rel_prior_set *rps_dup);
 
 //----------------------------------
 
 extern void 	priors_reset	( struct prior *p, player_t n);
-extern void 	priors_load 	( bool_t quietmode
+extern player_t	priors_count	( const struct prior *p, player_t n);
+extern bool_t 	priors_load 	( bool_t quietmode
 								, const char *fpriors_name
 								, struct RATINGS *rat /*@out@*/
 								, struct PLAYERS *plyrs /*@out@*/
 								, struct prior *pr /*@out@*/);
 
 extern void 	priors_copy		(const struct prior *p, player_t n, struct prior *q);
-extern void 	priors_shuffle	(struct prior *p, player_t n);
+extern void 	priors_shuffle	(struct prior *p, player_t n, struct ranctx *rng);
 extern void 	priors_show 	(const struct PLAYERS *plyrs, struct prior *p, player_t n);
 
 extern bool_t 	has_a_prior		(struct prior *pr, player_t j);
@@ -63,7 +61,7 @@ extern void 	anchor_j 		( player_t j, double x
 								, struct RATINGS *rat /*@out@*/
 								, struct PLAYERS *plyrs /*@out@*/);
 
-extern void 	init_manchors 	( bool_t quietmode
+extern bool_t 	init_manchors 	( bool_t quietmode
 								, const char *fpins_name
 								, struct RATINGS *rat /*@out@*/
 								, struct PLAYERS *plyrs /*@out@*/);
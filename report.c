@@ -269,7 +269,8 @@ cegt_output	( bool_t quiet
 	assert (e);
 	assert (pgame_stats);
 
-	encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
+	if (g->n > 0) // without games (--tmpdir), e has them already
+		encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
 	calc_obtained_playedby(e->enc, e->n, p->n, r->obtained, r->playedby);
 	for (j = 0; j < p->n; j++) {
 		r->sorted[j] = j;
@@ -414,7 +415,8 @@ head2head_output( const struct GAMES 	*		g
 	assert (pgame_stats);
 	//assert (s); // maybe NULL
 
-	encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
+	if (g->n > 0) // without games (--tmpdir), e has them already
+		encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
 	calc_obtained_playedby(e->enc, e->n, p->n, r->obtained, r->playedby);
 	for (j = 0; j < p->n; j++) {
 		r->sorted[j] = j; 
@@ -844,7 +846,8 @@ all_report 	( const struct GAMES 			*g
 	}
 	listcopy (inp_list, listbuff);
 
-	encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
+	if (g->n > 0) // without games (--tmpdir), e has them already
+		encounters_calculate(ENCOUNTERS_NOFLAGGED, g, p->flagged, e);
 
 	calc_obtained_playedby(e->enc, e->n, p->n, r->obtained, r->playedby);
 
@@ -46,14 +46,18 @@ calc_rating ( bool_t 					quiet
 			, struct rel_prior_set *	rps
 			, struct PLAYERS *			plyrs
 			, struct RATINGS *			rat
-			, struct GAMES *			pGames
+			, const struct ENCOUNTERS *	encount_full
+			, struct ENCMERGE *			merge
 
 			, struct prior *			pPrior
 			, struct prior 				wa_prior
 			, struct prior 				dr_prior
 
+			, const struct APPROXCTRL *	approx
+
 			, double *					pWhite_advantage
 			, double *					pDraw_rate
+			, struct CONVERGENCE *		conv
 )
 
 {
@@ -77,7 +81,7 @@ calc_rating ( bool_t 					quiet
 
 				, encount
 				, plyrs
-				, pGames
+				, encount_full
 				, rat
 
 				, pPrior
@@ -87,6 +91,27 @@ calc_rating ( bool_t 					quiet
 
 				, pWhite_advantage
 				, &dr
+				, conv
+				);
+
+	} else if (approx && approx->epochs > 0) {
+
+		ret = calc_rating_approx
+				( quiet
+				, adjust_wadv
+				, adjust_drate
+				, anchor_use && !anchor_err_rel2avg
+				, approx
+				, beta
+				, general_average
+				, anchor
+				, encount
+				, plyrs
+				, encount_full
+				, rat
+				, pWhite_advantage
+				, &dr
+				, conv
 				);
 
 	} else {
@@ -109,10 +134,12 @@ calc_rating ( bool_t 					quiet
 					, anchor
 					, encount
 					, plyrs
-					, pGames
+					, encount_full
 					, rat
+					, merge
 					, pWhite_advantage
 					, &dr
+					, conv
 					);
 
 			memrel(ratingtmp_memory);
@@ -43,14 +43,18 @@ calc_rating ( bool_t 					quiet
 			, struct rel_prior_set *	rps
 			, struct PLAYERS *			plyrs
 			, struct RATINGS *			rat
-			, struct GAMES *			pGames
+			, const struct ENCOUNTERS *	encount_full
+			, struct ENCMERGE *			merge				// colors merged by the solver, may be NULL
 
 			, struct prior *			pPrior
 			, struct prior 				wa_prior
 			, struct prior 				dr_prior
 
+			, const struct APPROXCTRL *	approx				// NULL for the exact solver
+
 			, double *					pWhite_advantage
 			, double *					pDraw_rate
+			, struct CONVERGENCE *		conv				// out, may be NULL
 )
 ;
 
@@ -0,0 +1,227 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "scc.h"
+#include "mymem.h"
+
+#define UNVISITED (-1)
+
+bool_t
+scc_init (struct SCC *s, player_t n_players, gamesnum_t n_enc)
+{
+	size_t n = (size_t)n_players;
+	size_t m = (size_t)(2 * n_enc);
+
+	s->n 		= n_players;
+	s->max_arcs = 2 * n_enc;
+	s->n_comp	= 0;
+	s->start	= memnew (sizeof(gamesnum_t) * (n + 1));
+	s->adj		= memnew (sizeof(player_t) * (m > 0? m: 1));
+	s->comp		= memnew (sizeof(player_t) * (n + 1));
+	s->index	= memnew (sizeof(player_t) * (n + 1));
+	s->low		= memnew (sizeof(player_t) * (n + 1));
+	s->stack	= memnew (sizeof(player_t) * (n + 1));
+	s->path		= memnew (sizeof(player_t) * (n + 1));
+	s->iter		= memnew (sizeof(gamesnum_t) * (n + 1));
+
+	if (NULL == s->start || NULL == s->adj   || NULL == s->comp || NULL == s->index
+	 || NULL == s->low   || NULL == s->stack || NULL == s->path || NULL == s->iter) {
+		scc_done (s);
+		return FALSE;
+	}
+	s->start[0] = 0;
+	return TRUE;
+}
+
+void
+scc_done (struct SCC *s)
+{
+	if (s->start) memrel (s->start);
+	if (s->adj)   memrel (s->adj);
+	if (s->comp)  memrel (s->comp);
+	if (s->index) memrel (s->index);
+	if (s->low)   memrel (s->low);
+	if (s->stack) memrel (s->stack);
+	if (s->path)  memrel (s->path);
+	if (s->iter)  memrel (s->iter);
+	s->start = NULL;
+	s->adj   = NULL;
+	s->comp  = NULL;
+	s->index = NULL;
+	s->low   = NULL;
+	s->stack = NULL;
+	s->path  = NULL;
+	s->iter  = NULL;
+	s->n = 0;
+	s->max_arcs = 0;
+	s->n_comp = 0;
+}
+
+static bool_t only_wins   (const struct ENC *e) {return e->W  > 0 && e->D == 0 && e->L == 0;}
+static bool_t only_losses (const struct ENC *e) {return e->W == 0 && e->D == 0 && e->L  > 0;}
+
+// builds the arcs in compressed rows, no memory is allocated
+void
+scc_load (struct SCC *s, const struct ENCOUNTERS *e)
+{
+	gamesnum_t *start = s->start;
+	gamesnum_t *fill  = s->iter; // borrowed as insertion cursor
+	player_t i, n = s->n;
+	gamesnum_t k;
+	const struct ENC *pe;
+
+	assert (2 * e->n <= s->max_arcs);
+
+	for (i = 0; i <= n; i++) start[i] = 0;
+
+	for (k = 0; k < e->n; k++) {
+		pe = &e->enc[k];
+		if (only_wins(pe)) {
+			start[pe->wh + 1]++;
+		} else if (only_losses(pe)) {
+			start[pe->bl + 1]++;
+		} else {
+			start[pe->wh + 1]++;
+			start[pe->bl + 1]++;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		start[i+1] += start[i];
+		fill[i] = start[i];
+	}
+
+	for (k = 0; k < e->n; k++) {
+		pe = &e->enc[k];
+		if (only_wins(pe)) {
+			s->adj[fill[pe->wh]++] = pe->bl;
+		} else if (only_losses(pe)) {
+			s->adj[fill[pe->bl]++] = pe->wh;
+		} else {
+			s->adj[fill[pe->wh]++] = pe->bl;
+			s->adj[fill[pe->bl]++] = pe->wh;
+		}
+	}
+}
+
+/*
+|	Iterative Tarjan. If stop_first is set, it returns as soon as the
+|	first component is completed, which is enough to know whether the
+|	graph is strongly connected.
+*/
+static player_t
+tarjan (struct SCC *s, const bool_t *present, bool_t stop_first)
+{
+	const gamesnum_t *start = s->start;
+	const player_t *adj = s->adj;
+	player_t *comp  = s->comp;
+	player_t *index = s->index;
+	player_t *low   = s->low;
+	player_t *stack = s->stack;
+	player_t *path  = s->path;
+	gamesnum_t *iter = s->iter;
+
+	player_t n = s->n;
+	player_t r, v, w, u;
+	player_t counter = 0, sp = 0, pp = 0, first_size = 0;
+
+	s->n_comp = 0;
+
+	for (v = 0; v < n; v++) {
+		index[v] = UNVISITED;
+		comp[v]  = SCC_NONE;
+	}
+
+	for (r = 0; r < n; r++) {
+
+		if (!present[r] || index[r] != UNVISITED) continue;
+
+		index[r] = low[r] = counter++;
+		stack[sp++] = r;
+		path[pp++] = r;
+		iter[r] = start[r];
+
+		while (pp > 0) {
+			v = path[pp-1];
+			if (iter[v] < start[v+1]) {
+				w = adj[iter[v]++];
+				if (index[w] == UNVISITED) {
+					index[w] = low[w] = counter++;
+					stack[sp++] = w;
+					path[pp++] = w;
+					iter[w] = start[w];
+				} else if (comp[w] == SCC_NONE && index[w] < low[v]) {
+					low[v] = index[w]; // w is still on the stack
+				}
+			} else {
+				pp--;
+				if (low[v] == index[v]) {
+					do {
+						u = stack[--sp];
+						comp[u] = s->n_comp;
+						first_size++;
+					} while (u != v);
+					s->n_comp++;
+					if (stop_first) return first_size;
+				}
+				if (pp > 0) {
+					u = path[pp-1];
+					if (low[v] < low[u]) low[u] = low[v];
+				}
+			}
+		}
+	}
+
+	return s->n_comp;
+}
+
+// returns the number of components
+player_t
+scc_find (struct SCC *s, const struct PLAYERS *p)
+{
+	assert (p->n <= s->n);
+	return tarjan (s, p->present_in_games, FALSE);
+}
+
+// same, for the nodes marked in present (s->n of them)
+player_t
+scc_find_present (struct SCC *s, const bool_t *present)
+{
+	return tarjan (s, present, FALSE);
+}
+
+bool_t
+scc_strongly_connected (struct SCC *s, const struct ENCOUNTERS *e, const struct PLAYERS *p)
+{
+	player_t i, present;
+
+	for (i = 0, present = 0; i < p->n; i++) {
+		if (p->present_in_games[i]) present++;
+	}
+	if (present == 0) return FALSE;
+
+	scc_load (s, e);
+	return tarjan (s, p->present_in_games, TRUE) == present;
+}
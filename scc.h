@@ -0,0 +1,63 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if !defined(H_SCC)
+#define H_SCC
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "boolean.h"
+#include "mytypes.h"
+
+/*
+|	Strongly connected components of the "beat/lost" digraph.
+|	A node is a player. Encounters with only wins for one side give
+|	an arc winner -> loser, any other encounter gives arcs both ways.
+|	Players not present in games are left out (comp = SCC_NONE).
+|	Components are numbered in reverse topological order: no arc goes
+|	from a component to another one with a higher number.
+*/
+
+#define SCC_NONE (-1)
+
+struct SCC {
+	player_t		n;			// nodes
+	gamesnum_t		max_arcs;
+	gamesnum_t *	start;		// arcs of node i are adj[start[i]..start[i+1])
+	player_t *		adj;
+	player_t *		comp;		// component of each node
+	player_t		n_comp;
+	// work
+	player_t *		index;
+	player_t *		low;
+	player_t *		stack;
+	player_t *		path;
+	gamesnum_t *	iter;
+};
+
+extern bool_t 		scc_init (struct SCC *s, player_t n_players, gamesnum_t n_enc);
+extern void 		scc_done (struct SCC *s);
+extern void 		scc_load (struct SCC *s, const struct ENCOUNTERS *e);
+extern player_t		scc_find (struct SCC *s, const struct PLAYERS *p);
+extern player_t		scc_find_present (struct SCC *s, const bool_t *present);
+extern bool_t		scc_strongly_connected (struct SCC *s, const struct ENCOUNTERS *e, const struct PLAYERS *p);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
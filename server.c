@@ -0,0 +1,315 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "server.h"
+#include "csv.h"
+#include "pgnget.h"
+#include "mymem.h"
+#include "sysport.h"
+
+enum SERVERSTRINGS {S_ANCHOR, S_LOOSE, S_MULTI, S_RELATIONS, S_N};
+
+struct SERVER {
+	  struct ordo_ctx *		ctx
+	; thpool_t *			pool
+	; uint32_t				seed
+	; struct ordo_config	cfg
+	; char *				owned[S_N]		// strings pointed by cfg, once changed
+	; bool_t				dirty			// games or configuration changed since the last rebuild
+	; bool_t				solved
+	; bool_t				quit
+	;
+};
+
+static void
+server_init (struct SERVER *sv, struct ordo_ctx *ctx, thpool_t *pool, uint32_t seed)
+{
+	int i;
+	sv->ctx = ctx;
+	sv->pool = pool;
+	sv->seed = seed;
+	sv->cfg = ctx->cfg;
+	sv->cfg.quiet = TRUE;
+	for (i = 0; i < S_N; i++) sv->owned[i] = NULL;
+	sv->dirty = TRUE; // quiet from now on
+	sv->solved = FALSE;
+	sv->quit = FALSE;
+}
+
+static void
+server_done (struct SERVER *sv)
+{
+	int i;
+	for (i = 0; i < S_N; i++) {
+		if (sv->owned[i]) memrel (sv->owned[i]);
+		sv->owned[i] = NULL;
+	}
+}
+
+static bool_t
+answer_error (FILE *out, const char *msg)
+{
+	size_t i, n = strlen(msg);
+	fprintf (out, "error,");
+	while (n > 0 && msg[n-1] == '\n') n--;
+	for (i = 0; i < n; i++) {
+		fputc (msg[i] == '\n'? ' ': msg[i], out); // one line
+	}
+	fprintf (out, "\n");
+	return FALSE;
+}
+
+/*
+|
+|	COMMANDS
+|
+\*--------------------------------------------------------------*/
+
+static bool_t
+solution_update (struct SERVER *sv, FILE *out)
+{
+	struct ordo_ctx *ctx = sv->ctx;
+
+	if (sv->dirty) {
+		ordo_configure (ctx, &sv->cfg);
+		if (!ordo_rebuild (ctx))
+			return answer_error (out, ordo_errmsg(ctx));
+		sv->dirty = FALSE;
+		sv->solved = FALSE;
+	}
+	if (!sv->solved) {
+		if (!ordo_transform (ctx) || !ordo_solve (ctx)) {
+			sv->dirty = TRUE; // next time from the database again
+			return answer_error (out, ordo_errmsg(ctx));
+		}
+		sv->solved = TRUE;
+	}
+	return TRUE;
+}
+
+static void
+ratings_out (struct SERVER *sv, FILE *out, bool_t errors)
+{
+	const struct ordo_ctx *ctx = sv->ctx;
+	player_t j, n = ordo_players_n (ctx);
+	for (j = 0; j < n; j++) {
+		if (!ctx->players.present_in_games[j]) continue;
+		if (errors)
+			fprintf (out, "\"%s\",%.1f,%.1f\n", ordo_name(ctx,j), ordo_rating(ctx,j), ordo_error(ctx,j));
+		else
+			fprintf (out, "\"%s\",%.1f\n", ordo_name(ctx,j), ordo_rating(ctx,j));
+	}
+}
+
+static int
+str2result (const char *s)
+{
+	if (!strcmp(s,"1-0")) return WHITE_WIN;
+	if (!strcmp(s,"0-1")) return BLACK_WIN;
+	if (!strcmp(s,"1/2-1/2") || !strcmp(s,"=")) return RESULT_DRAW;
+	return -1;
+}
+
+static bool_t
+str2double (const char *s, double *x)
+{
+	return 1 == sscanf (s, "%lf", x);
+}
+
+static bool_t
+str2flag (const char *s, bool_t *x)
+{
+	if (!strcmp(s,"1") || !strcmp(s,"on")) {*x = TRUE; return TRUE;}
+	if (!strcmp(s,"0") || !strcmp(s,"off")) {*x = FALSE; return TRUE;}
+	return FALSE;
+}
+
+// empty value clears the setting
+static bool_t
+setstr (struct SERVER *sv, int k, const char **field, const char *value)
+{
+	char *p = NULL;
+	if (*value != '\0') {
+		if (NULL == (p = memnew (strlen(value) + 1))) return FALSE;
+		strcpy (p, value);
+	}
+	if (sv->owned[k]) memrel (sv->owned[k]);
+	sv->owned[k] = p;
+	*field = p;
+	return TRUE;
+}
+
+static bool_t
+cmd_set (struct SERVER *sv, FILE *out, const char *param, const char *value)
+{
+	struct ordo_config *cfg = &sv->cfg;
+	bool_t ok;
+	double x;
+
+	// nothing changes unless the value is valid
+	if (!strcmp(param,"average")) {
+		ok = str2double (value, &x);
+		if (ok) cfg->general_average = x;
+	} else if (!strcmp(param,"anchor")) {
+		ok = setstr (sv, S_ANCHOR, &cfg->anchor_name, value);
+	} else if (!strcmp(param,"white")) {
+		ok = str2double (value, &x);
+		if (ok) {
+			cfg->white_advantage = x;
+			cfg->adjust_white_advantage = FALSE;
+		}
+	} else if (!strcmp(param,"white-auto")) {
+		ok = str2flag (value, &cfg->adjust_white_advantage);
+	} else if (!strcmp(param,"draw")) {
+		ok = str2double (value, &x) && x > 0 && x < 100;
+		if (ok) {
+			cfg->drawrate = x/100.0;
+			cfg->adjust_draw_rate = FALSE;
+		}
+	} else if (!strcmp(param,"draw-auto")) {
+		ok = str2flag (value, &cfg->adjust_draw_rate);
+	} else if (!strcmp(param,"ml")) {
+		ok = str2flag (value, &cfg->force_ml);
+	} else if (!strcmp(param,"loose-anchors")) {
+		ok = setstr (sv, S_LOOSE, &cfg->loose_anchors, value);
+	} else if (!strcmp(param,"multi-anchors")) {
+		ok = setstr (sv, S_MULTI, &cfg->multi_anchors, value);
+	} else if (!strcmp(param,"relations")) {
+		ok = setstr (sv, S_RELATIONS, &cfg->relations, value);
+	} else {
+		return answer_error (out, "unknown parameter");
+	}
+
+	if (!ok) return answer_error (out, "wrong value");
+	sv->dirty = TRUE;
+	return TRUE;
+}
+
+static bool_t
+command (struct SERVER *sv, FILE *out, csv_line_t *c)
+{
+	struct ordo_ctx *ctx = sv->ctx;
+	const char *cmd = c->s[0];
+	int n = c->n;
+
+	if (!strcmp(cmd,"game") && n == 4) {
+		int result = str2result (c->s[3]);
+		if (result < 0) return answer_error (out, "wrong result");
+		if (!ordo_add_game (ctx, c->s[1], c->s[2], result)) return answer_error (out, ordo_errmsg(ctx));
+		sv->dirty = TRUE;
+		return TRUE;
+	}
+	if (!strcmp(cmd,"set") && (n == 3 || n == 2)) {
+		return cmd_set (sv, out, c->s[1], n == 3? c->s[2]: ""); // set,anchor, clears it
+	}
+	if (!strcmp(cmd,"rate") && n == 1) {
+		if (!solution_update (sv, out)) return FALSE;
+		ratings_out (sv, out, FALSE);
+		return TRUE;
+	}
+	if (!strcmp(cmd,"errors") && n == 2) {
+		struct SIMCTRL simctrl;
+		long sims;
+		if (1 != sscanf (c->s[1], "%ld", &sims) || sims < 2) return answer_error (out, "at least 2 simulations are needed");
+		if (!solution_update (sv, out)) return FALSE;
+		memset (&simctrl, 0, sizeof(simctrl));
+		simctrl.seed = sv->seed;
+		simctrl.shard_n = 1;
+		simctrl.checkpoint_every = 60;
+		ordo_simulate (ctx, sv->pool, sims, &simctrl, FALSE);
+		ratings_out (sv, out, TRUE);
+		return TRUE;
+	}
+	if (!strcmp(cmd,"info") && n == 1) {
+		fprintf (out, "%ld,%ld,%.1f,%.1f\n"
+				, (long)ctx->pdaba->n_players, (long)ctx->pdaba->n_games
+				, ordo_white_advantage(ctx), 100.0 * ordo_drawrate(ctx));
+		return TRUE;
+	}
+	if (!strcmp(cmd,"quit") && n == 1) {
+		sv->quit = TRUE;
+		return TRUE;
+	}
+	return answer_error (out, "unknown command");
+}
+
+// returns when the input ends or quit is received
+static void
+serve (struct SERVER *sv, FILE *in, FILE *out)
+{
+	char line[MAXSIZE_CSVLINE];
+	csv_line_t csvln;
+
+	while (!sv->quit && NULL != fgets (line, MAXSIZE_CSVLINE, in)) {
+		char *p = line;
+		while (*p == ' ' || *p == '\t') p++;
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') continue;
+
+		if (!csv_line_init (&csvln, p)) {
+			answer_error (out, "not enough memory");
+		} else {
+			if (csvln.n > 0 && command (sv, out, &csvln))
+				fprintf (out, "ok\n");
+			else if (csvln.n == 0)
+				answer_error (out, "empty command");
+			csv_line_done (&csvln);
+		}
+		fflush (out);
+	}
+}
+
+/*
+|
+|	ENTRY POINTS
+|
+\*--------------------------------------------------------------*/
+
+void
+server_stdio (struct ordo_ctx *ctx, thpool_t *pool, uint32_t seed)
+{
+	struct SERVER sv;
+	server_init (&sv, ctx, pool, seed);
+	serve (&sv, stdin, stdout);
+	server_done (&sv);
+}
+
+bool_t
+server_socket (struct ordo_ctx *ctx, thpool_t *pool, uint32_t seed, const char *path)
+{
+	struct SERVER sv;
+	FILE *in, *out;
+	int fd;
+
+	if (-1 == (fd = local_listen (path))) return FALSE;
+
+	server_init (&sv, ctx, pool, seed);
+	while (!sv.quit && local_accept (fd, &in, &out)) {
+		serve (&sv, in, out);
+		fclose (in);
+		fclose (out);
+	}
+	server_done (&sv);
+	local_close (fd, path);
+	return TRUE;
+}
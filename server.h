@@ -0,0 +1,53 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_SERVER)
+#define H_SERVER
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include <stdio.h>
+#include "boolean.h"
+#include "libordo.h"
+#include "thpool.h"
+
+/*
+|	Resident mode. The games stay loaded in ctx and commands are read one
+|	per line (comma separated values, names may be "quoted"):
+|
+|		game,<white>,<black>,<result>	result is 1-0, 0-1, 1/2-1/2 or =
+|		set,<parameter>,<value>			average, anchor, white, white-auto,
+|										draw, draw-auto, ml, loose-anchors,
+|										multi-anchors, relations
+|		rate							"<player>",<rating>
+|		errors,<n>						"<player>",<rating>,<sdev> after n simulations
+|		info							players,games,white advantage,draw rate
+|		quit
+|
+|	Each answer ends with a line "ok", or is a single "error,<message>".
+\*--------------------------------------------------------------*/
+
+// commands from stdin, answers to stdout. Simulations use pool and seed
+extern void	server_stdio (struct ordo_ctx *ctx, thpool_t *pool, uint32_t seed);
+
+// one client at a time on a UNIX socket, until a client sends quit
+extern bool_t server_socket (struct ordo_ctx *ctx, thpool_t *pool, uint32_t seed, const char *path);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
@@ -21,17 +21,23 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include <assert.h>
 
 #include "sim.h"
 #include "encount.h"
-#include "groups.h"
+#include "scc.h"
 #include "plyrs.h"
 #include "ra.h"
 #include "relprior.h"
 #include "randfast.h"
 #include "pgnget.h"
 #include "xpect.h"
+#include "mymem.h"
+#include "simfile.h"
+#include "pgnout.h"
+#include "mytimer.h"
+#include "stats.h"
 
 #if 0
 #define SAVE_SIMULATION
@@ -41,11 +47,13 @@
 // Prototypes
 
 static void
-simulate_scores ( const double 	*ratingof_results
-				, double 		deq
-				, double 		wadv
-				, double 		beta
-				, struct GAMES *g	// output
+simulate_encounters ( const double 	*ratingof_results
+					, double 		deq
+					, double 		wadv
+					, double 		beta
+					, const struct ENCOUNTERS *pEnc_ori
+					, struct ranctx *rng
+					, struct ENCOUNTERS *pEnc_sim	// output
 );
 
 static void
@@ -66,10 +74,13 @@ get_a_simulated_run	( int 					limit
 					, const struct RATINGS 			*pRA
 					, const struct prior 			*PP_ori			
 					, const struct rel_prior_set	*pRPset_ori 	
+					, const struct ENCOUNTERS 		*pEnc_ori
 
+					, struct ranctx			*rng			// io
+					, struct SCC			*scc			// work
+					, struct ENCOUNTERS 	*pEnc_sim 		// output
 					, struct ENCOUNTERS 	*pEncounters 	// output
 					, struct PLAYERS 		*pPlayers 		// output
-					, struct GAMES 			*pGames			// output
 					, struct prior 			*PP				// output
 					, struct rel_prior_set	*pRPset 		// output
 )
@@ -84,93 +95,101 @@ get_a_simulated_run	( int 					limit
 			printf("--> Simulation: [Rejected]\n\n");
 
 		players_flags_reset (pPlayers);
-		simulate_scores ( pRA->ratingof_results
-						, drawrate_evenmatch_result
-						, white_advantage_result
-						, beta
-						, pGames /*out*/);
+		simulate_encounters ( pRA->ratingof_results
+							, drawrate_evenmatch_result
+							, white_advantage_result
+							, beta
+							, pEnc_ori
+							, rng
+							, pEnc_sim /*out*/);
 
 		relpriors_copy    (pRPset_ori, pRPset); 	// reload original
-		relpriors_shuffle (pRPset);					// simulate new
+		relpriors_shuffle (pRPset, rng);			// simulate new
 		priors_copy       (PP_ori, pPlayers->n, PP);// reload original
-		priors_shuffle    (PP, pPlayers->n);		// simulate new
+		priors_shuffle    (PP, pPlayers->n, rng);	// simulate new
 
 		assert(players_have_clear_flags(pPlayers));
 
-		encounters_calculate(ENCOUNTERS_FULL, pGames, pPlayers->flagged, pEncounters);
+		encounters_select (ENCOUNTERS_FULL, pEnc_sim, pPlayers->flagged, pEncounters);
 
 		players_set_priored_info (PP, pRPset, pPlayers);
 		if (0 < players_set_super (quiet_mode, pEncounters, pPlayers)) {
 			players_purge (quiet_mode, pPlayers);
-			encounters_calculate(ENCOUNTERS_NOFLAGGED, pGames, pPlayers->flagged, pEncounters);
+			encounters_select (ENCOUNTERS_NOFLAGGED, pEnc_sim, pPlayers->flagged, pEncounters);
 		}
 
-	} while (failed_sim++ < limit && !well_connected (pEncounters, pPlayers));
+	} while (failed_sim++ < limit && !scc_strongly_connected (scc, pEncounters, pPlayers));
 
 	if (!quiet_mode) printf("--> Simulation: [Accepted]\n");
 }
 
 /*=== simulation routines ==========================================*/
 
-static int
-rand_threeway_wscore(double pwin, double pdraw)
-{	
-	long z,x,y;
-	z = (long)((unsigned)(pwin * (0xffff+1)));
-	x = (long)((unsigned)((pwin+pdraw) * (0xffff+1)));
-	y = randfast32() & 0xffff;
-
-	if (y < z) {
-		return WHITE_WIN;
-	} else if (y < x) {
-		return RESULT_DRAW;
-	} else {
-		return BLACK_WIN;		
-	}
-}
-
-
+/*
+|	Games are simulated directly on the encounters of the original
+|	database. All the games of an encounter share the same probabilities,
+|	so they are calculated once per encounter, and the result is already
+|	sorted and merged, ready for encounters_select().
+*/
 // no globals
 static void
-simulate_scores ( const double 	*ratingof_results
-				, double 		deq
-				, double 		wadv
-				, double 		beta
-				, struct GAMES *g	// output
+simulate_encounters ( const double 	*ratingof_results
+					, double 		deq
+					, double 		wadv
+					, double 		beta
+					, const struct ENCOUNTERS *pEnc_ori
+					, struct ranctx *rng
+					, struct ENCOUNTERS *pEnc_sim	// output
 )
 {
-	gamesnum_t n_games = g->n;
-	struct gamei *gam = g->ga;
+	gamesnum_t n_enc = pEnc_ori->n;
+	const struct ENC *ori = pEnc_ori->enc;
+	struct ENC *enc = pEnc_sim->enc;
 
-	gamesnum_t i;
+	gamesnum_t e, k;
+	gamesnum_t W, D, L;
 	player_t w, b;
 	const double *rating = ratingof_results;
 	double pwin, pdraw, plos;
+	gamesnum_t games = 0;
 	assert(deq <= 1 && deq >= 0);
-
-	for (i = 0; i < n_games; i++) {
-		if (gam[i].score != DISCARD) {
-			w = gam[i].whiteplayer;
-			b = gam[i].blackplayer;
-			get_pWDL(rating[w] + wadv - rating[b], &pwin, &pdraw, &plos, deq, beta);
-			gam[i].score = rand_threeway_wscore(pwin,pdraw);
+	assert(pEnc_sim->size >= n_enc);
+
+	for (e = 0; e < n_enc; e++) {
+		w = ori[e].wh;
+		b = ori[e].bl;
+		get_pWDL(rating[w] + wadv - rating[b], &pwin, &pdraw, &plos, deq, beta);
+		W = D = L = 0;
+		for (k = 0; k < ori[e].played; k++) {
+			switch (rand_threeway_wscore(pwin,pdraw,rng)) {
+				case WHITE_WIN: 	W++; break;
+				case RESULT_DRAW:	D++; break;
+				default:			L++; break;
+			}
 		}
+		enc[e].wh 		= w;
+		enc[e].bl 		= b;
+		enc[e].played 	= ori[e].played;
+		enc[e].W 		= W;
+		enc[e].D 		= D;
+		enc[e].L 		= L;
+		enc[e].wscore 	= (double)W + 0.5 * (double)D;
+		games += ori[e].played;
 	}
+	pEnc_sim->n = n_enc;
+	STAT_ADD (STAT_SIM_GAMES, games);
 }
 
 /*==================================================================*/
 
 // This section is to save simulated results for debugging purposes
 
-static const char *Result_string[4] = {"1-0","1/2-1/2","0-1","*"};
-
 void
-save_simulated(struct PLAYERS *pPlayers, struct GAMES *pGames, int num)
+save_simulated(const struct PLAYERS *pPlayers, const struct ENCOUNTERS *pEnc, int num)
 {
-	gamesnum_t i;
+	gamesnum_t e;
 	const char *name_w;
 	const char *name_b;
-	const char *result;
 	char filename[256] = "";	
 	FILE *fout;
 
@@ -180,22 +199,10 @@ save_simulated(struct PLAYERS *pPlayers, struct GAMES *pGames, int num)
 
 	if (NULL != (fout = fopen (filename, "w"))) {
 
-		for (i = 0; i < pGames->n; i++) {
-
-			int32_t score_i = pGames->ga[i].score;
-			player_t wp_i = pGames->ga[i].whiteplayer;
-			player_t bp_i = pGames->ga[i].blackplayer;
-
-			if (score_i == DISCARD) continue;
-	
-			name_w = pPlayers->name [wp_i];
-			name_b = pPlayers->name [bp_i];		
-			result = Result_string[score_i];
-
-			fprintf(fout,"[White \"%s\"]\n",name_w);
-			fprintf(fout,"[Black \"%s\"]\n",name_b);
-			fprintf(fout,"[Result \"%s\"]\n",result);
-			fprintf(fout,"%s\n\n",result);
+		for (e = 0; e < pEnc->n; e++) {
+			name_w = pPlayers->name [pEnc->enc[e].wh];
+			name_b = pPlayers->name [pEnc->enc[e].bl];		
+			pgnout_results (fout, name_w, name_b, pEnc->enc[e].W, pEnc->enc[e].D, pEnc->enc[e].L);
 		}
 
 		fclose(fout);
@@ -205,40 +212,84 @@ save_simulated(struct PLAYERS *pPlayers, struct GAMES *pGames, int num)
 //========================================================================
 #include "sysport.h"
 
-mythread_mutex_t Smpcount;
-mythread_mutex_t Groupmtx;
-mythread_mutex_t Summamtx;
 mythread_mutex_t Printmtx;
 
-static long Sim_N = 0;
+// Changed by every thread during the simulations of one run
+struct SIMSHARED {
+	  mythread_mutex_t				smpcount			// hands out the simulations
+	; long							first
+	; long							next				// next simulation to be handed out
+	; long							end
+	; const unsigned char *			skip				// completed in a previous run
+	; bool_t						stop				// no more simulations will be handed out
+
+	; mythread_mutex_t				summamtx			// protects the results
+	; long							done				// completed
+	; myclock_t						checkpoint_last
+
+	; double						fraction			// progress bar, protected by Printmtx
+	; double						asterisk
+	; int							astcount
+	;
+};
 
 static bool_t
-smpcount_get (long *x)
+smpcount_get (struct SIMSHARED *sh, long *x)
 {
 	bool_t ok;
-	mythread_mutex_lock (&Smpcount);
-	if (Sim_N > 0) {
-		*x = Sim_N--;
+	STAT_LOCK (&sh->smpcount, STAT_SMPCOUNT_LOCKS);
+	while (sh->next < sh->end && sh->skip[sh->next - sh->first])
+		sh->next++;
+	if (sh->next < sh->end && !sh->stop) {
+		*x = sh->next++;
 		ok = TRUE;
 	} else {
 		*x = 0;
 		ok = FALSE;
 	}
-	mythread_mutex_unlock (&Smpcount);
+	mythread_mutex_unlock (&sh->smpcount);
 	return ok;
 }
 
+// simulations first <= z < last will be handed out, except those with skip[z-first] set
+static void
+smpcount_set (struct SIMSHARED *sh, long first, long last, const unsigned char *skip, long done)
+{
+	mythread_mutex_lock (&sh->smpcount);
+	sh->first = first;
+	sh->next = first;
+	sh->end = last;
+	sh->skip = skip;
+	sh->stop = FALSE;
+	sh->done = done;
+	mythread_mutex_unlock (&sh->smpcount);
+}
+
 static void
-smpcount_set (long x)
+smpcount_stop (struct SIMSHARED *sh)
 {
-	mythread_mutex_lock (&Smpcount);
-	Sim_N = x;
-	mythread_mutex_unlock (&Smpcount);
+	mythread_mutex_lock (&sh->smpcount);
+	sh->stop = TRUE;
+	mythread_mutex_unlock (&sh->smpcount);
 }
 
 //========================================================================
 
+// Minimum number of simulations before the precision target is checked
+#define SIMUL_PRECISION_MIN 20
+
+// One for each NUMA node, when threads are placed by node
+struct SIMNODE {
+	  mythread_mutex_t				mtx
+	; bool_t						ready
+	; struct ENCOUNTERS				encount_full		// local copy, read only once ready
+	; int							threads				// different workers of the pool that ran here
+	; unsigned char *				ran					// per worker, locked with mtx
+	; long							sims				// locked with summamtx
+	;
+};
 
+// Shared by all threads, read only during the simulations
 struct SIMSMP {
 	  long							simulate
 	; bool_t 						sim_updates
@@ -261,23 +312,169 @@ struct SIMSMP {
 	; struct prior 					wa_prior
 	; struct prior 					dr_prior
 
-	; struct ENCOUNTERS	*			encount				// io, modified
-	; struct PLAYERS *				plyrs				// io, modified
-	; struct RATINGS *				rat					// io, modified
-	; struct GAMES *				pGames				// io, modified
+	; const struct ENCOUNTERS *		encount_full
+	; const struct PLAYERS *		plyrs
+	; const struct RATINGS *		rat
+	; const struct ENCMERGE *		merge_layout
+	; uint32_t						seed				// simulation z uses the series (seed, z)
+
+	; double						target_relerr		// 0 if not used
+	; const player_t *				target_list			// players checked for precision
+	; player_t						target_n
+
+	; struct SIMFILE *				acc					// completed simulations, locked with summamtx
+	; const char *					checkpoint_file
+	; myclock_t						checkpoint_ticks	// interval between checkpoints
 
-	; struct rel_prior_set 			RPset_work			// mem provided
-	; struct prior *				PP_work				// mem provided
+	; struct summations *			p_sfe_io 			// output, locked with summamtx
+
+	; struct SIMNODE *				node				// NULL if threads are not placed by node
+	; int							node_n
+
+	; double *						busy				// per thread, seconds spent in simulations
+	; struct SIMSHARED *			sh
+	;
+};
 
-	; struct summations *			p_sfe_io 			// output
+// Owned by each thread, only what a simulation modifies
+struct SIMWORK {
+	  struct PLAYERS 				plyrs				// flags only, names etc. shared
+	; struct ENCOUNTERS				enc_sim				// simulated games
+	; struct ENCOUNTERS				encount				// selected for the calculation
+	; struct RATINGS 				rat					// results arrays shared
+	; struct prior *				PP_work
+	; struct rel_prior_set 			RPset_work
+	; struct ranctx					rng
+	; struct SCC					scc					// connectivity check
+	; struct ENCMERGE				encmerge			// colors merged by the solver
+	; const struct ENCOUNTERS *		encount_full		// shared, or the copy of its node
+	; int							node				// -1 if not placed
 	;
 };
 
+#include "inidone.h"
+
+static bool_t
+simwork_init (const struct SIMSMP *s, struct SIMWORK *w)
+{
+	bool_t ok = TRUE;
+
+	w->PP_work = NULL;
+
+	ok = ok && players_replicate_shared	(s->plyrs, &w->plyrs);
+	ok = ok && encounters_replicate		(s->encount_full, &w->enc_sim);
+	ok = ok && encounters_replicate		(s->encount_full, &w->encount);
+	ok = ok && ratings_replicate_shared	(s->rat, &w->rat);
+	ok = ok && priorlist_replicate		(s->plyrs->n, s->pPrior, &w->PP_work);
+	ok = ok && relpriors_replicate		(s->rps, &w->RPset_work);
+	ok = ok && scc_init					(&w->scc, s->plyrs->n, s->encount_full->n);
+	ok = ok && encmerge_replicate		(s->merge_layout, &w->encmerge);
+
+	return ok;
+}
+
+static void
+simwork_done (struct SIMWORK *w)
+{
+	players_done_shared (&w->plyrs);
+	encounters_done (&w->enc_sim);
+	encounters_done (&w->encount);
+	ratings_done_shared (&w->rat);
+	priorlist_done (&w->PP_work);
+	relpriors_done1	(&w->RPset_work);
+	scc_done (&w->scc);
+	encmerge_done (&w->encmerge);
+}
+
 //========================================================================
 
 #include "summations.h"
 #include "rtngcalc.h"
 
+// Must be called with summamtx locked
+static void
+checkpoint_save (const struct SIMSMP *s, bool_t forced)
+{
+	myclock_t now;
+
+	if (s->checkpoint_file == NULL) return;
+
+	now = myclock();
+	if (!forced && now - s->sh->checkpoint_last < s->checkpoint_ticks) return;
+	s->sh->checkpoint_last = now;
+
+	if (!simfile_write (s->checkpoint_file, s->acc, s->p_sfe_io)) {
+		mythread_mutex_lock (&Printmtx);
+		fprintf (stderr, "Checkpoint \"%s\" could not be saved\n", s->checkpoint_file);
+		mythread_mutex_unlock (&Printmtx);
+	}
+}
+
+// Must be called with summamtx locked
+static bool_t
+precision_reached (const struct SIMSMP *s, long sim_n)
+{
+	player_t i;
+	double relerr;
+
+	if (sim_n < SIMUL_PRECISION_MIN) return FALSE;
+
+	for (i = 0; i < s->target_n; i++) {
+		relerr = summations_sdev_relerror (s->p_sfe_io, s->target_list[i], (double)sim_n);
+		if (relerr >= s->target_relerr) 
+			return FALSE;
+	}
+	return TRUE;
+}
+
+struct RANKED {
+	player_t	j;
+	double		r;
+};
+
+static int
+compare_RANKED (const void *a, const void *b)
+{
+	const struct RANKED *ap = a;
+	const struct RANKED *bp = b;
+	if (ap->r < bp->r) return  1;
+	if (ap->r > bp->r) return -1;
+	return (ap->j > bp->j) - (ap->j < bp->j);
+}
+
+// players checked for the precision target, all or the top k by rating
+static player_t *
+target_list_new (const struct PLAYERS *plyrs, const struct RATINGS *rat, player_t top_k, player_t *pn)
+{
+	struct RANKED *ranked;
+	player_t *list;
+	player_t i, n;
+
+	if (NULL == (ranked = memnew (sizeof(struct RANKED) * (size_t)plyrs->n)))
+		return NULL;
+
+	for (n = 0, i = 0; i < plyrs->n; i++) {
+		if (plyrs->flagged[i]) continue;
+		ranked[n].j = i;
+		ranked[n].r = rat->ratingof_results[i];
+		n++;
+	}
+
+	if (top_k > 0 && top_k < n) {
+		qsort (ranked, (size_t)n, sizeof(struct RANKED), compare_RANKED);
+		n = top_k;
+	}
+
+	if (NULL != (list = memnew (sizeof(player_t) * (size_t)(n > 0? n: 1)))) {
+		for (i = 0; i < n; i++) 
+			list[i] = ranked[i].j;
+		*pn = n;
+	}
+
+	memrel (ranked);
+	return list;
+}
+
 static void
 ratings_set_to	( double general_average	
 				, const struct PLAYERS *pPlayers
@@ -309,31 +506,27 @@ updates_print_head (bool_t quiet, long z, long simulate)
 	mythread_mutex_unlock (&Printmtx);
 }
 
-static	double 					Fraction = 0.0;
-static	double 					Asterisk = 1;
-static	int 					Astcount = 0;
-
 static void
-updates_print_progress (bool_t sim_updates)
+updates_print_progress (struct SIMSHARED *sh, bool_t sim_updates)
 {
 	double fraction;
 	int astcount;
 
 	mythread_mutex_lock (&Printmtx);
 
-	fraction = Fraction;
-	astcount = Astcount;
+	fraction = sh->fraction;
+	astcount = sh->astcount;
 	if (sim_updates) {
 		fraction += 1.0;
-		while (fraction > Asterisk) {
-			fraction -= Asterisk;
+		while (fraction > sh->asterisk) {
+			fraction -= sh->asterisk;
 			astcount++;
 			printf ("*"); 
 		}
 		fflush(stdout);
 	}
-	Fraction = fraction;
-	Astcount = astcount;
+	sh->fraction = fraction;
+	sh->astcount = astcount;
 
 	mythread_mutex_unlock (&Printmtx);
 
@@ -341,11 +534,11 @@ updates_print_progress (bool_t sim_updates)
 }
 
 static void
-updates_print_reachedgoal (bool_t sim_updates)
+updates_print_reachedgoal (struct SIMSHARED *sh, bool_t sim_updates)
 {
 	int astcount;
 	mythread_mutex_lock (&Printmtx);
-	astcount = Astcount;
+	astcount = sh->astcount;
 	if (sim_updates) {
 		int x = 51-astcount;
 		while (x-->0) {printf ("*"); fflush(stdout);}
@@ -355,168 +548,369 @@ updates_print_reachedgoal (bool_t sim_updates)
 }
 
 
-void
-simul
-	( long 							simulate
-	, bool_t 						sim_updates
-	, bool_t 						quiet_mode
-	, bool_t						prior_mode
-	, bool_t 						adjust_white_advantage
-	, bool_t 						adjust_draw_rate
-	, bool_t						anchor_use
-	, bool_t						anchor_err_rel2avg
-
-	, double						general_average
-	, player_t 						anchor
-	, player_t						priored_n
-	, double						beta
-
-	, double 						drawrate_evenmatch_result
-	, double 						white_advantage_result
-	, const struct rel_prior_set *	rps
-	, const struct prior *			pPrior
-	, struct prior 					wa_prior
-	, struct prior 					dr_prior
-
-	, struct ENCOUNTERS	*			encount				// io, modified
-	, struct PLAYERS *				plyrs				// io, modified
-	, struct RATINGS *				rat					// io, modified
-	, struct GAMES *				pGames				// io, modified
-
-	, struct rel_prior_set 			RPset_work			// mem provided
-	, struct prior *				PP_work				// mem provided
-
-	, struct summations *			p_sfe_io 			// output
-)
+static void
+simul (const struct SIMSMP *s, struct SIMWORK *w)
 {
-	double 					white_advantage = white_advantage_result;
-	double 					drawrate_evenmatch = drawrate_evenmatch_result;
+	double 					white_advantage = s->white_advantage_result;
+	double 					drawrate_evenmatch = s->drawrate_evenmatch_result;
 
-	struct summations 		*sfe = p_sfe_io; 	// summations for errors
+	struct summations 		*sfe = s->p_sfe_io; 	// summations for errors
+	long					simulate = s->simulate;
 
-	struct ENCOUNTERS		Encounters = *encount;
-	struct rel_prior_set 	RPset = *rps;
-	struct PLAYERS 			Players = *plyrs;
-	struct RATINGS 			RA = *rat;
-	struct GAMES 			Games = *pGames;
+	struct PLAYERS 			*pPlayers = &w->plyrs;
+	struct RATINGS 			*pRA = &w->rat;
 
-	const struct prior *	PP = pPrior;
-
-	long 					zz;
-	ptrdiff_t 				topn = (ptrdiff_t)Players.n;
+	long 					z;
+	ptrdiff_t 				topn = (ptrdiff_t)pPlayers->n;
+	bool_t					stop;
 
 	assert (simulate > 1);
 	if (simulate <= 1) return;
 
 	/* Simulation block, begin */
 
-	while (smpcount_get(&zz)) {
-
-		long z = simulate-zz;
-
-		if (z == 0) {
-			// original run
-			// should be done only once by only one thread, that is why z == 0
-			mythread_mutex_lock (&Summamtx);
-			sfe->wa_sum1 += white_advantage_result;
-			sfe->wa_sum2 += white_advantage_result * white_advantage_result;				
-			sfe->dr_sum1 += drawrate_evenmatch_result;
-			sfe->dr_sum2 += drawrate_evenmatch_result * drawrate_evenmatch_result;
-			mythread_mutex_unlock (&Summamtx);
-		}
+	while (smpcount_get(s->sh, &z)) {
 
-		updates_print_head (quiet_mode, z, simulate);
+		updates_print_head (s->quiet_mode, z, simulate);
 
-		// store originals
-		relpriors_copy (&RPset, &RPset_work); 
-		priors_copy (PP, Players.n, PP_work);
+		// results of simulation z do not depend on the thread that runs it
+		ranctx_init (&w->rng, s->seed, (uint32_t)z);
 
-		mythread_mutex_lock (&Groupmtx);
 		get_a_simulated_run	( 100
-							, quiet_mode
-							, beta
-							, drawrate_evenmatch_result
-							, white_advantage_result
-							, &RA	
-							, PP			
-							, &RPset		
-							, &Encounters 	// output
-							, &Players		// output
-							, &Games		// output
-							, PP_work		// output
-							, &RPset_work 	// output
+							, s->quiet_mode
+							, s->beta
+							, s->drawrate_evenmatch_result
+							, s->white_advantage_result
+							, s->rat	
+							, s->pPrior			
+							, s->rps
+							, w->encount_full
+							, &w->rng
+							, &w->scc
+							, &w->enc_sim		// output
+							, &w->encount 		// output
+							, pPlayers			// output
+							, w->PP_work		// output
+							, &w->RPset_work 	// output
 							);
-		mythread_mutex_unlock (&Groupmtx);
 
 		#if defined(SAVE_SIMULATION)
 		if (z+1 == SAVE_SIMULATION_N) {
-			save_simulated(&Players, &Games, (int)(z+1)); 
+			save_simulated(pPlayers, &w->enc_sim, (int)(z+1)); 
 		}
 		#endif
 
 		// may improve convergence in pathological cases, it should not be needed.
-		ratings_set_to (general_average, &Players, &RA);
-
-		Encounters.n = calc_rating 
-						( quiet_mode
-						, prior_mode 
-						, adjust_white_advantage
-						, adjust_draw_rate
-						, anchor_use
-						, anchor_err_rel2avg
-
-						, general_average
-						, anchor
-						, priored_n
-						, beta
-
-						, &Encounters
-						, &RPset_work
-						, &Players
-						, &RA
-						, &Games
-
-						, PP_work
-						, wa_prior
-						, dr_prior
+		ratings_set_to (s->general_average, pPlayers, pRA);
+
+		w->encount.n = calc_rating 
+						( s->quiet_mode
+						, s->prior_mode 
+						, s->adjust_white_advantage
+						, s->adjust_draw_rate
+						, s->anchor_use
+						, s->anchor_err_rel2avg
+
+						, s->general_average
+						, s->anchor
+						, s->priored_n
+						, s->beta
+
+						, &w->encount
+						, &w->RPset_work
+						, pPlayers
+						, pRA
+						, &w->enc_sim
+						, &w->encmerge
+
+						, w->PP_work
+						, s->wa_prior
+						, s->dr_prior
+
+						, NULL
 
 						, &white_advantage
 						, &drawrate_evenmatch
+						, NULL
 						);
 
-		ratings_cleared_for_purged (&Players, &RA);
+		ratings_cleared_for_purged (pPlayers, pRA);
 
-		if (anchor_err_rel2avg) {
-			ratings_copy (Players.n, RA.ratingof, RA.ratingbk);	// ** save
-			ratings_center_to_zero (Players.n, Players.flagged, RA.ratingof);
+		if (s->anchor_err_rel2avg) {
+			ratings_copy (pPlayers->n, pRA->ratingof, pRA->ratingbk);	// ** save
+			ratings_center_to_zero (pPlayers->n, pPlayers->flagged, pRA->ratingof);
 		}
 
 		// update summations for errors
-		mythread_mutex_lock (&Summamtx);
-		summations_update (sfe, topn, RA.ratingof, white_advantage, drawrate_evenmatch);
-		mythread_mutex_unlock (&Summamtx);
-
-		if (anchor_err_rel2avg) {
-			ratings_copy (Players.n, RA.ratingbk, RA.ratingof); // ** restore
+		STAT_LOCK (&s->sh->summamtx, STAT_SUMMAMTX_LOCKS);
+		if (z == 0) {
+			// original run, counted with simulation 0 so that a checkpoint
+			// never has one without the other
+			sfe->wa_sum1 += s->white_advantage_result;
+			sfe->wa_sum2 += s->white_advantage_result * s->white_advantage_result;				
+			sfe->dr_sum1 += s->drawrate_evenmatch_result;
+			sfe->dr_sum2 += s->drawrate_evenmatch_result * s->drawrate_evenmatch_result;
+		}
+		summations_update (sfe, topn, pRA->ratingof, white_advantage, drawrate_evenmatch);
+		s->sh->done++;
+		STAT_INC (STAT_SIMULATIONS);
+		if (w->node >= 0) s->node[w->node].sims++;
+		s->acc->done[z - s->acc->first] = 1;
+		s->acc->done_n = s->sh->done;
+		stop = s->target_relerr > 0 && precision_reached (s, s->sh->done);
+		checkpoint_save (s, FALSE);
+		mythread_mutex_unlock (&s->sh->summamtx);
+
+		// simulations already handed out are still completed and counted
+		if (stop) smpcount_stop(s->sh);
+
+		if (s->anchor_err_rel2avg) {
+			ratings_copy (pPlayers->n, pRA->ratingbk, pRA->ratingof); // ** restore
 		}
 
-		updates_print_progress (sim_updates);
+		updates_print_progress (s->sh, s->sim_updates);
 
 	} // for loop end
 
 } /* Simulation function, end */
 
 
-static /*@null@*/
-thread_return_t THREAD_CALL
-simul_smp_process (void *p);
+static void
+simul_smp_process (void *p, long first, long last, int worker);
 
-#include "inidone.h"
+static void
+simnodes_init (struct SIMSMP *s, int workers)
+{
+	int i;
+	s->node_n = mysys_numa_nodes();
+	if (NULL == (s->node = memnew (sizeof(struct SIMNODE) * (size_t)s->node_n))) {
+		fprintf(stderr, "Memory for simulations could not be allocated\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < s->node_n; i++) {
+		if (NULL == (s->node[i].ran = memnew ((size_t)workers))) {
+			fprintf(stderr, "Memory for simulations could not be allocated\n");
+			exit(EXIT_FAILURE);
+		}
+		memset (s->node[i].ran, 0, (size_t)workers);
+		mythread_mutex_init (&s->node[i].mtx);
+		s->node[i].ready = FALSE;
+		s->node[i].threads = 0;
+		s->node[i].sims = 0;
+	}
+}
 
-void
+static void
+simnodes_done (struct SIMSMP *s)
+{
+	int i;
+	for (i = 0; i < s->node_n; i++) {
+		if (s->node[i].ready) encounters_done (&s->node[i].encount_full);
+		memrel (s->node[i].ran);
+		mythread_mutex_destroy (&s->node[i].mtx);
+	}
+	memrel (s->node);
+	s->node = NULL;
+	s->node_n = 0;
+}
+
+static void
+simnodes_report (const struct SIMSMP *s, double elapsed)
+{
+	int i;
+	printf ("\n");
+	for (i = 0; i < s->node_n; i++) {
+		const struct SIMNODE *nd = &s->node[i];
+		if (nd->threads == 0) continue;
+		printf ("NUMA node %d: threads=%d, simulations=%ld, %.2f simulations/s\n"
+				, i, nd->threads, nd->sims, elapsed > 0? (double)nd->sims / elapsed: 0.0);
+	}
+}
+
+//------------------------------------------------------------------------
+
+// FNV-1a
+static uint64_t
+hash_bytes (uint64_t h, const void *p, size_t n)
+{
+	const unsigned char *c = p;
+	size_t i;
+	for (i = 0; i < n; i++) {
+		h ^= (uint64_t)c[i];
+		h *= 0x100000001b3u;
+	}
+	return h;
+}
+
+static uint64_t hash_dbl (uint64_t h, double x) 	{return hash_bytes (h, &x, sizeof(x));}
+static uint64_t hash_i64 (uint64_t h, int64_t x) 	{return hash_bytes (h, &x, sizeof(x));}
+
+/*
+|	Signature of everything that determines the simulations: games,
+|	names, ratings obtained, priors and options. Files of accumulators
+|	can only be combined when it is the same.
+*/
+static uint64_t
+sim_signature (const struct SIMSMP *s)
+{
+	uint64_t h = 0xcbf29ce484222325u;
+	const struct PLAYERS *p = s->plyrs;
+	const struct ENC *enc = s->encount_full->enc;
+	gamesnum_t e;
+	player_t j;
+
+	h = hash_i64 (h, (int64_t)p->n);
+	for (j = 0; j < p->n; j++) {
+		h = hash_bytes (h, p->name[j], strlen(p->name[j]) + 1);
+		h = hash_i64 (h, (int64_t)p->flagged[j]);
+		h = hash_i64 (h, (int64_t)p->prefed[j]);
+		h = hash_dbl (h, s->rat->ratingof_results[j]);
+		h = hash_i64 (h, (int64_t)s->pPrior[j].isset);
+		if (s->pPrior[j].isset) {
+			h = hash_dbl (h, s->pPrior[j].value);
+			h = hash_dbl (h, s->pPrior[j].sigma);
+		}
+	}
+
+	h = hash_i64 (h, (int64_t)s->encount_full->n);
+	for (e = 0; e < s->encount_full->n; e++) {
+		h = hash_i64 (h, (int64_t)enc[e].wh);
+		h = hash_i64 (h, (int64_t)enc[e].bl);
+		h = hash_i64 (h, (int64_t)enc[e].W);
+		h = hash_i64 (h, (int64_t)enc[e].D);
+		h = hash_i64 (h, (int64_t)enc[e].L);
+	}
+
+	h = hash_i64 (h, (int64_t)s->rps->n);
+	for (j = 0; j < s->rps->n; j++) {
+		h = hash_i64 (h, (int64_t)s->rps->x[j].player_a);
+		h = hash_i64 (h, (int64_t)s->rps->x[j].player_b);
+		h = hash_dbl (h, s->rps->x[j].delta);
+		h = hash_dbl (h, s->rps->x[j].sigma);
+	}
+
+	h = hash_i64 (h, (int64_t)s->prior_mode);
+	h = hash_i64 (h, (int64_t)s->adjust_white_advantage);
+	h = hash_i64 (h, (int64_t)s->adjust_draw_rate);
+	h = hash_i64 (h, (int64_t)s->anchor_use);
+	h = hash_i64 (h, (int64_t)s->anchor_err_rel2avg);
+	h = hash_i64 (h, (int64_t)s->anchor);
+	h = hash_i64 (h, (int64_t)s->priored_n);
+	h = hash_dbl (h, s->general_average);
+	h = hash_dbl (h, s->beta);
+	h = hash_dbl (h, s->drawrate_evenmatch_result);
+	h = hash_dbl (h, s->white_advantage_result);
+	h = hash_i64 (h, (int64_t)s->wa_prior.isset);
+	if (s->wa_prior.isset) {
+		h = hash_dbl (h, s->wa_prior.value);
+		h = hash_dbl (h, s->wa_prior.sigma);
+	}
+	h = hash_i64 (h, (int64_t)s->dr_prior.isset);
+	if (s->dr_prior.isset) {
+		h = hash_dbl (h, s->dr_prior.value);
+		h = hash_dbl (h, s->dr_prior.sigma);
+	}
+
+	return h;
+}
+
+// the ratings of the original run, as the simulations accumulate them, so
+// the shift is the same in every run with the same signature
+static void
+sim_shift_set (const struct SIMSMP *s)
+{
+	struct summations *sm = s->p_sfe_io;
+	summations_set_shift (sm, s->plyrs->n, s->rat->ratingof);
+	if (s->anchor_err_rel2avg)
+		ratings_center_to_zero (s->plyrs->n, s->plyrs->flagged, sm->shift);
+}
+
+/*
+|	Adds up the accumulators saved in the files, which should
+|	cover every simulation of the same run exactly once.
+*/
+static long
+simul_merge (const struct SIMSMP *s, strlist_t *files)
+{
+	struct summations 	sm;
+	struct SIMFILE 		h;
+	unsigned char *		covered = NULL;
+	const char *		fname;
+	long				simulate = 0;
+	uint32_t			seed = 0;
+	long				sim_n = 0;
+	long				z;
+	bool_t				first = TRUE;
+	uint64_t			signature = sim_signature (s);
+
+	if (!summations_calloc (s->p_sfe_io, s->plyrs->n)) {
+		fprintf(stderr, "Memory for simulations could not be allocated\n");
+		exit(EXIT_FAILURE);
+	}
+	sim_shift_set (s);
+
+	strlist_rwnd (files);
+	while (NULL != (fname = strlist_next (files))) {
+
+		summations_init (&sm);
+		if (!simfile_read (fname, &h, &sm)) {
+			fprintf (stderr, "Simulation file \"%s\" could not be read\n", fname);
+			exit(EXIT_FAILURE);
+		}
+		if (h.signature != signature || h.n_players != s->plyrs->n) {
+			fprintf (stderr, "Simulation file \"%s\" was obtained with different games or options\n", fname);
+			exit(EXIT_FAILURE);
+		}
+		if (first) {
+			simulate = h.simulate;
+			seed = h.seed;
+			if (NULL == (covered = memnew ((size_t)simulate))) {
+				fprintf(stderr, "Memory for simulations could not be allocated\n");
+				exit(EXIT_FAILURE);
+			}
+			memset (covered, 0, (size_t)simulate);
+			first = FALSE;
+		} else if (h.simulate != simulate || h.seed != seed) {
+			fprintf (stderr, "Simulation file \"%s\" belongs to a different run (-s or --sim-seed)\n", fname);
+			exit(EXIT_FAILURE);
+		}
+		for (z = h.first; z < h.last; z++) {
+			if (!h.done[z - h.first]) continue;
+			if (covered[z]) {
+				fprintf (stderr, "Simulation %ld is present in more than one file\n", z);
+				exit(EXIT_FAILURE);
+			}
+			covered[z] = 1;
+		}
+
+		summations_add (s->p_sfe_io, &sm, s->plyrs->n);
+		sim_n += h.done_n;
+
+		summations_done (&sm);
+		simfile_done (&h);
+	}
+
+	for (z = 0; z < simulate; z++) {
+		if (!covered[z]) {
+			fprintf (stderr, "Simulation %ld is missing, not all the files were provided\n", z);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (covered) memrel (covered);
+
+	if (sim_n > 1)
+		summations_calc_sdev (s->p_sfe_io, s->plyrs->n, (double)sim_n);
+	return sim_n;
+}
+
+//------------------------------------------------------------------------
+
+long
 simul_smp
-	( int							cpus
+	( thpool_t *					pool
 	, long 							simulate
+	, const struct SIMCTRL *		ctrl
 	, bool_t 						sim_updates
 	, bool_t 						quiet_mode
 	, bool_t						prior_mode
@@ -537,21 +931,28 @@ simul_smp
 	, struct prior 					wa_prior
 	, struct prior 					dr_prior
 
-	, struct ENCOUNTERS	*			encount				// io, modified
-	, struct PLAYERS *				plyrs				// io, modified
-	, struct RATINGS *				rat					// io, modified
-	, struct GAMES *				pGames				// io, modified
-
-	, struct rel_prior_set 			RPset_work			// mem provided
-	, struct prior *				PP_work				// mem provided
+	, const struct ENCOUNTERS *		encount_full		// shared, read only
+	, const struct PLAYERS *		plyrs				// shared, read only
+	, const struct RATINGS *		rat					// shared, read only
+	, const struct ENCMERGE *		merge_layout		// of the solve, copied by each thread, may be NULL
 
 	, struct summations *			p_sfe_io 			// output
 )
 {
 	struct SIMSMP s;
+	struct SIMSHARED sh;
+	struct SIMFILE acc;
+	struct SIMFILE ckp;
+	struct summations ckp_sm;
 	void *pdata;
-
-	if (cpus < 1) return;
+	player_t *target_list = NULL;
+	long sim_n;
+	long first, last;
+	int cpus = thpool_workers (pool) + 1;
+	int i;
+	bool_t report = !quiet_mode;
+	myclock_t t_start;
+	double t_elapsed;
 
 	if (cpus > 1 && !quiet_mode) {quiet_mode = TRUE; sim_updates = TRUE;}
 
@@ -574,14 +975,49 @@ simul_smp
 	s.wa_prior					= wa_prior						;
 	s.dr_prior					= dr_prior						;
 
-	s.encount					= encount						;
-	s.plyrs						= plyrs						;
+	s.encount_full				= encount_full					;
+	s.plyrs						= plyrs							;
 	s.rat						= rat							;
-	s.pGames					= pGames						;
-	s.RPset_work				= RPset_work					;
-	s.PP_work					= PP_work						;
+	s.merge_layout				= merge_layout					;
+	s.seed						= ctrl->seed					;
+
+	s.target_relerr				= ctrl->target_relerr			;
+	s.target_list				= NULL							;
+	s.target_n					= 0								;
 
 	s.p_sfe_io 					= p_sfe_io						;
+	s.node						= NULL							;
+	s.node_n					= 0								;
+	s.busy						= NULL							;
+
+	if (ctrl->merge) {
+		return simul_merge (&s, ctrl->merge);
+	}
+
+	// simulations of this shard
+	first = (long)((int64_t)simulate *  ctrl->shard_k      / ctrl->shard_n);
+	last  = (long)((int64_t)simulate * (ctrl->shard_k + 1) / ctrl->shard_n);
+
+	if (!simfile_init (&acc, first, last)) {
+		fprintf(stderr, "Memory for simulations could not be allocated\n");
+		exit(EXIT_FAILURE);
+	}
+	acc.signature	= sim_signature (&s);
+	acc.n_players	= plyrs->n;
+	acc.simulate	= simulate;
+	acc.seed		= ctrl->seed;
+	s.acc			= &acc;
+
+	s.checkpoint_file	= ctrl->checkpoint_file;
+	s.checkpoint_ticks	= (myclock_t)ctrl->checkpoint_every * ticks_per_sec();
+
+	if (s.target_relerr > 0) {
+		if (NULL == (target_list = target_list_new (plyrs, rat, ctrl->target_topk, &s.target_n))) {
+			fprintf(stderr, "Memory for simulations could not be allocated\n");
+			exit(EXIT_FAILURE);
+		}
+		s.target_list = target_list;
+	}
 
 	pdata = &s; // convert to a void pointer, needed for the SMP call
 
@@ -589,115 +1025,152 @@ simul_smp
 		fprintf(stderr, "Memory for simulations could not be allocated\n");
 		exit(EXIT_FAILURE);
 	}
+	sim_shift_set (&s);
+
+	// continue from the checkpoint, only if it belongs to the same run
+	if (ctrl->resume && ctrl->checkpoint_file != NULL) {
+		FILE *f = fopen (ctrl->checkpoint_file, "rb");
+		if (f == NULL) {
+			if (!quiet_mode) printf ("No checkpoint found, simulations start from the beginning\n");
+		} else {
+			fclose (f);
+			summations_init (&ckp_sm);
+			if (!simfile_read (ctrl->checkpoint_file, &ckp, &ckp_sm)) {
+				fprintf (stderr, "Checkpoint \"%s\" could not be read\n", ctrl->checkpoint_file);
+				exit(EXIT_FAILURE);
+			}
+			if (ckp.signature != acc.signature || ckp.n_players != acc.n_players) {
+				fprintf (stderr, "Checkpoint \"%s\" was obtained with different games or options\n", ctrl->checkpoint_file);
+				exit(EXIT_FAILURE);
+			}
+			if (ckp.simulate != simulate || ckp.seed != acc.seed || ckp.first != first || ckp.last != last) {
+				fprintf (stderr, "Checkpoint \"%s\" belongs to a different run (-s, --sim-seed or --sim-shard)\n", ctrl->checkpoint_file);
+				exit(EXIT_FAILURE);
+			}
+			summations_add (s.p_sfe_io, &ckp_sm, s.plyrs->n);
+			memcpy (acc.done, ckp.done, (size_t)(last - first));
+			acc.done_n = ckp.done_n;
+			if (!quiet_mode) printf ("Resuming simulations, %ld already completed\n", acc.done_n);
+			summations_done (&ckp_sm);
+			simfile_done (&ckp);
+		}
+	}
 
-	{
-		#define MAX_CPUS 64
+	mythread_mutex_init (&sh.smpcount);
+	mythread_mutex_init (&sh.summamtx);
+	sh.checkpoint_last = myclock();
+	sh.fraction = 0;
+	sh.astcount = 0;
+	sh.asterisk = (double)(last-first-acc.done_n)/50.0;
+	s.sh = &sh;
 
-		int CPUS = cpus > MAX_CPUS? MAX_CPUS: cpus;
-		int t;
-		static bool_t		iret     [MAX_CPUS];
-		static mythread_t 	threadid [MAX_CPUS];
-		static int			err		 [MAX_CPUS];
+	smpcount_set(&sh, first, last, acc.done, acc.done_n);
+	updates_print_scale (sim_updates);
 
-		smpcount_set(simulate);
-		updates_print_scale (sim_updates);
-		Asterisk = (double)simulate/50.0;
+	if (ctrl->numa) 
+		simnodes_init (&s, cpus);
 
-		/* Create independent threads each of which will execute function */
-		for (t = 0; t < CPUS; t++) {
-			iret[t] = mythread_create( &threadid[t], simul_smp_process, pdata, &err[t]);
-		}
+	if (NULL == (s.busy = memnew (sizeof(double) * (size_t)cpus))) {
+		fprintf(stderr, "Memory for simulations could not be allocated\n");
+		exit(EXIT_FAILURE);
+	}
 
-		/* reporting error */
-		for (t = 0; t < CPUS; t++) {
-			if (!iret[(short int)t]) { //cast to short int silences a warning
-				fprintf (stderr, "thread %d, fatal error at creating: %s\n", t, mythread_create_error(err[t]) );
-				exit(EXIT_FAILURE);
-			}
-		}
+	// one simulation loop for each thread, they take simulations from the same counter
+	t_start = myclock();
+	thpool_parallel_for (pool, 0, cpus, 1, simul_smp_process, pdata);
+	t_elapsed = (double)(myclock() - t_start) / (double)ticks_per_sec();
 
-		/* Wait for threads to be done */
-		for (t = 0; t < CPUS; t++) {
-			if (0==mythread_join( threadid[t] )) {
-				fprintf (stderr, "thread %d: fatal problems at joining\n", t);	
-				exit(EXIT_FAILURE);	
-			};
-		}
+	sim_n = sh.done;
+	summations_calc_sdev (s.p_sfe_io, s.plyrs->n, (double)sim_n);
+	updates_print_reachedgoal (&sh, sim_updates);
+
+	if (ctrl->numa) {
+		if (report) simnodes_report (&s, t_elapsed);
+		simnodes_done (&s);
+	}
+
+	for (i = 0; i < cpus; i++) {
+		double idle = t_elapsed - s.busy[i];
+		phase_thread (i, s.busy[i], idle > 0? idle: 0);
 	}
+	memrel (s.busy);
 
-	summations_calc_sdev (s.p_sfe_io, s.plyrs->n, (double)simulate);
-	updates_print_reachedgoal (sim_updates);
+	checkpoint_save (&s, TRUE);
 
-	return;
+	if (ctrl->save_file != NULL && !simfile_write (ctrl->save_file, &acc, s.p_sfe_io)) {
+		fprintf (stderr, "Simulation file \"%s\" could not be saved\n", ctrl->save_file);
+		exit(EXIT_FAILURE);
+	}
+
+	simfile_done (&acc);
+	if (target_list) memrel (target_list);
+	mythread_mutex_destroy (&sh.smpcount);
+	mythread_mutex_destroy (&sh.summamtx);
+
+	return sim_n;
 }
 
-static /*@null@*/
-thread_return_t THREAD_CALL
-simul_smp_process (void *p)
+/*
+|	Thread number r goes to node r % n, so threads are spread over the
+|	nodes. The first thread that arrives at a node makes its local copy
+|	of the shared encounters. The caller restores the affinity it had,
+|	the thread may be the main one or run other things later.
+*/
+static int
+simnode_enter (const struct SIMSMP *s, long r, int worker)
 {
-	bool_t ok;
-	struct SIMSMP *s = p;
-
-	struct PLAYERS 			_plyrs			;	
-	struct ENCOUNTERS		_encount		;	
-	struct GAMES 			_games			;	
-	struct RATINGS 			_rat			;		
-	struct prior 		*	_PP_work  = NULL;			
-	struct rel_prior_set 	_RPset_work 	;	
-
-	// save locally
-	ok = TRUE;
-	ok = ok && players_replicate 	(s->plyrs, &_plyrs);
-	ok = ok && encounters_replicate	(s->encount, &_encount);
-	ok = ok && games_replicate 		(s->pGames, &_games);
-	ok = ok && ratings_replicate 	(s->rat, &_rat);	
-	ok = ok && priorlist_replicate 	(s->plyrs->n, s->PP_work, &_PP_work);
-	ok = ok && relpriors_replicate	(&s->RPset_work, &_RPset_work);
-
-	if (!ok) {
+	int node = (int)(r % s->node_n);
+	int k    = (int)(r / s->node_n);
+	int ncpu = mysys_numa_cpus (node);
+	struct SIMNODE *nd = &s->node[node];
+
+	if (ncpu > 0)
+		mythread_set_affinity (mysys_numa_cpu (node, k % ncpu));
+
+	mythread_mutex_lock (&nd->mtx);
+	if (!nd->ready) {
+		if (!encounters_replicate (s->encount_full, &nd->encount_full)) {
+			fprintf (stderr, "Not enough memory to run in parallel\n");
+			exit(EXIT_FAILURE);
+		}
+		nd->ready = TRUE;
+	}
+	if (!nd->ran[worker]) {
+		nd->ran[worker] = 1;
+		nd->threads++;
+	}
+	mythread_mutex_unlock (&nd->mtx);
+
+	return node;
+}
+
+static void
+simul_smp_process (void *p, long first, long last, int worker)
+{
+	const struct SIMSMP *s = p;
+	struct SIMWORK w;
+	myaffinity_t saved;
+	bool_t restore;
+	double t;
+
+	(void)last;
+
+	// placed before anything is allocated, so memory is touched first on the local node
+	restore = s->node != NULL && mythread_get_affinity (&saved);
+	w.node = s->node == NULL? -1: simnode_enter (s, first, worker);
+	w.encount_full = w.node < 0? s->encount_full: &s->node[w.node].encount_full;
+
+	// only what is modified is allocated locally
+	if (!simwork_init (s, &w)) {
 		printf ("Not enough memory to run in parallel\n");
 		exit(EXIT_FAILURE);
 	}
 
-	simul (	s->simulate
-	, 		s->sim_updates
-	, 		s->quiet_mode
-	, 		s->prior_mode
-	, 		s->adjust_white_advantage
-	, 		s->adjust_draw_rate
-	, 		s->anchor_use
-	, 		s->anchor_err_rel2avg
-	, 		s->general_average
-	, 		s->anchor
-	, 		s->priored_n
-	, 		s->beta
-	, 		s->drawrate_evenmatch_result
-	, 		s->white_advantage_result
-	, 		s->rps
-	, 		s->pPrior
-	, 		s->wa_prior
-	, 		s->dr_prior
-
-	, 		&_encount			// io, modified
-	, 		&_plyrs				// io, modified
-	, 		&_rat				// io, modified
-	, 		&_games				// io, modified
-	, 		_RPset_work			// mem provided
-	, 		_PP_work			// mem provided
-
-	, 		s->p_sfe_io 		// output
-	);
+	t = wallclock();
+	simul (s, &w);
+	s->busy[first] = wallclock() - t;
 
 	// done
-	players_done (&_plyrs);
-	encounters_done (&_encount);
-	games_done (&_games);
-	ratings_done (&_rat);
-	priorlist_done (&_PP_work);
-	relpriors_done1	(&_RPset_work);
-
-	mythread_exit ();
-	return (thread_return_t) 0;
+	simwork_done (&w);
+	if (restore) mythread_restore_affinity (&saved);
 }
-
-
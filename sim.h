@@ -26,12 +26,28 @@
 #include "mytypes.h"
 
 #include "sysport.h"
+#include "thpool.h"
 
-extern mythread_mutex_t Smpcount;
-extern mythread_mutex_t Groupmtx;
-extern mythread_mutex_t Summamtx;
 extern mythread_mutex_t Printmtx;
 
+#include "randfast.h"
+#include "scc.h"
+#include "strlist.h"
+
+struct SIMCTRL {
+	double				target_relerr;	// stop when sdevs have this precision, 0 if not used
+	player_t			target_topk;	// precision checked only for the top k, 0 = all
+	uint32_t			seed;			// simulation z uses the random series (seed, z)
+	long				shard_k;		// simulations of shard k out of n, 0 <= k < n
+	long				shard_n;
+	const char *		save_file;		// accumulators are saved here, if not NULL
+	strlist_t *			merge;			// files to be added up instead of simulating, if not NULL
+	const char *		checkpoint_file;// progress is saved here periodically, if not NULL
+	long				checkpoint_every;// seconds
+	bool_t				resume;			// continue from checkpoint_file
+	bool_t				numa;			// threads bound to processors, shared data copied on each node
+};
+
 void
 get_a_simulated_run	( int 					limit
 					, bool_t 				quiet_mode
@@ -42,57 +58,28 @@ get_a_simulated_run	( int 					limit
 					, const struct RATINGS 			*pRA
 					, const struct prior 			*PP_ori			
 					, const struct rel_prior_set	*pRPset_ori 	
+					, const struct ENCOUNTERS 		*pEnc_ori
 
+					, struct ranctx			*rng			// io
+					, struct SCC			*scc			// work
+					, struct ENCOUNTERS 	*pEnc_sim 		// output
 					, struct ENCOUNTERS 	*pEncounters 	// output
 					, struct PLAYERS 		*pPlayers 		// output
-					, struct GAMES 			*pGames			// output
 					, struct prior 			*PP				// output
 					, struct rel_prior_set	*pRPset 		// output
 )
 ;
 
 extern void
-save_simulated(struct PLAYERS *pPlayers, struct GAMES *pGames, int num);
-
-extern void
-simul
-	( long 							simulate
-	, bool_t 						sim_updates
-	, bool_t 						quiet_mode
-	, bool_t						prior_mode
-	, bool_t 						adjust_white_advantage
-	, bool_t 						adjust_draw_rate
-	, bool_t						anchor_use
-	, bool_t						anchor_err_rel2avg
-
-	, double						general_average
-	, player_t 						anchor
-	, player_t						priored_n
-	, double						beta
+save_simulated(const struct PLAYERS *pPlayers, const struct ENCOUNTERS *pEnc, int num);
 
-	, double 						drawrate_evenmatch_result
-	, double 						white_advantage_result
-	, const struct rel_prior_set *	rps
-	, const struct prior *			pPrior
-	, struct prior 					wa_prior
-	, struct prior 					dr_prior
-
-	, struct ENCOUNTERS	*			encount				// io, modified
-	, struct PLAYERS *				plyrs				// io, modified
-	, struct RATINGS *				rat					// io, modified
-	, struct GAMES *				pGames				// io, modified
-
-	, struct rel_prior_set 			RPset_work			// mem provided
-	, struct prior *				PP_work				// mem provided
-
-	, struct summations *			p_sfe_io 			// output
-)
-;
-
-void
+// returns the number of simulations performed (or merged), less than
+// "simulate" if the precision target was reached before
+extern long
 simul_smp
-	( int							cpus
+	( thpool_t *					pool
 	, long 							simulate
+	, const struct SIMCTRL *		ctrl
 	, bool_t 						sim_updates
 	, bool_t 						quiet_mode
 	, bool_t						prior_mode
@@ -113,13 +100,10 @@ simul_smp
 	, struct prior 					wa_prior
 	, struct prior 					dr_prior
 
-	, struct ENCOUNTERS	*			encount				// io, modified
-	, struct PLAYERS *				plyrs				// io, modified
-	, struct RATINGS *				rat					// io, modified
-	, struct GAMES *				pGames				// io, modified
-
-	, struct rel_prior_set 			RPset_work			// mem provided
-	, struct prior *				PP_work				// mem provided
+	, const struct ENCOUNTERS *		encount_full		// shared, read only
+	, const struct PLAYERS *		plyrs				// shared, read only
+	, const struct RATINGS *		rat					// shared, read only
+	, const struct ENCMERGE *		merge_layout		// of the solve, copied by each thread, may be NULL
 
 	, struct summations *			p_sfe_io 			// output
 )
@@ -0,0 +1,185 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "simfile.h"
+#include "summations.h"
+#include "mymem.h"
+
+static const char Simfile_magic[8] = "ORDOSIM";
+#define SIMFILE_VERSION 1
+#define SIMFILE_BYTEORDER 0x01020304u
+
+//---------------------------------- statics
+
+static bool_t
+u32_fwrite (FILE *f, uint32_t x)
+{
+	return 1 == fwrite (&x, sizeof(x), 1, f);
+}
+
+static bool_t
+i64_fwrite (FILE *f, int64_t x)
+{
+	return 1 == fwrite (&x, sizeof(x), 1, f);
+}
+
+static bool_t
+u64_fwrite (FILE *f, uint64_t x)
+{
+	return 1 == fwrite (&x, sizeof(x), 1, f);
+}
+
+static bool_t
+u32_fread (FILE *f, uint32_t *x)
+{
+	return 1 == fread (x, sizeof(*x), 1, f);
+}
+
+static bool_t
+i64_fread (FILE *f, int64_t *x)
+{
+	return 1 == fread (x, sizeof(*x), 1, f);
+}
+
+static bool_t
+u64_fread (FILE *f, uint64_t *x)
+{
+	return 1 == fread (x, sizeof(*x), 1, f);
+}
+
+//---------------------------------- extern
+
+bool_t
+simfile_init (struct SIMFILE *h, long first, long last)
+{
+	size_t n = (size_t)(last > first? last - first: 1);
+	assert (last >= first);
+
+	h->signature = 0;
+	h->n_players = 0;
+	h->simulate	 = 0;
+	h->seed 	 = 0;
+	h->first	 = first;
+	h->last		 = last;
+	h->done_n	 = 0;
+	if (NULL == (h->done = memnew (n))) 
+		return FALSE;
+	memset (h->done, 0, n);
+	return TRUE;
+}
+
+void
+simfile_done (struct SIMFILE *h)
+{
+	if (h->done) memrel (h->done);
+	h->done = NULL;
+	h->done_n = 0;
+}
+
+// written to a temporary file first, the old file is replaced only when complete
+bool_t
+simfile_write (const char *fname, const struct SIMFILE *h, const struct summations *sm)
+{
+	FILE *f;
+	bool_t ok = TRUE;
+	char tmpname[1024];
+
+	if (strlen(fname) + 5 > sizeof(tmpname)) 
+		return FALSE;
+	sprintf (tmpname, "%s.tmp", fname);
+
+	if (NULL == (f = fopen (tmpname, "wb"))) 
+		return FALSE;
+
+	ok = ok && 8 == fwrite (Simfile_magic, 1, 8, f);
+	ok = ok && u32_fwrite (f, SIMFILE_VERSION);
+	ok = ok && u32_fwrite (f, SIMFILE_BYTEORDER);
+	ok = ok && u64_fwrite (f, h->signature);
+	ok = ok && i64_fwrite (f, (int64_t)h->n_players);
+	ok = ok && i64_fwrite (f, (int64_t)h->simulate);
+	ok = ok && u32_fwrite (f, h->seed);
+	ok = ok && i64_fwrite (f, (int64_t)h->first);
+	ok = ok && i64_fwrite (f, (int64_t)h->last);
+	ok = ok && i64_fwrite (f, (int64_t)h->done_n);
+	ok = ok && (size_t)(h->last - h->first) == fwrite (h->done, 1, (size_t)(h->last - h->first), f);
+	ok = ok && summations_fwrite (f, sm, h->n_players);
+
+	ok = (0 == fclose (f)) && ok;
+
+	if (ok) {
+		remove (fname);
+		ok = 0 == rename (tmpname, fname);
+	} else {
+		remove (tmpname);
+	}
+	return ok;
+}
+
+bool_t
+simfile_read (const char *fname, struct SIMFILE *h, struct summations *sm)
+{
+	FILE *f;
+	bool_t ok = TRUE;
+	char magic[8];
+	uint32_t version = 0, byteorder = 0, seed = 0;
+	uint64_t signature = 0;
+	int64_t n_players = 0, simulate = 0, first = 0, last = 0, done_n = 0;
+
+	h->done = NULL;
+
+	if (NULL == (f = fopen (fname, "rb"))) 
+		return FALSE;
+
+	ok = ok && 8 == fread (magic, 1, 8, f) && 0 == memcmp (magic, Simfile_magic, 8);
+	ok = ok && u32_fread (f, &version) && version == SIMFILE_VERSION;
+	ok = ok && u32_fread (f, &byteorder) && byteorder == SIMFILE_BYTEORDER;
+	ok = ok && u64_fread (f, &signature);
+	ok = ok && i64_fread (f, &n_players);
+	ok = ok && i64_fread (f, &simulate);
+	ok = ok && u32_fread (f, &seed);
+	ok = ok && i64_fread (f, &first);
+	ok = ok && i64_fread (f, &last);
+	ok = ok && i64_fread (f, &done_n);
+	ok = ok && n_players > 0 && 0 <= first && first <= last && last <= simulate && done_n <= last - first;
+
+	ok = ok && simfile_init (h, (long)first, (long)last);
+	if (ok) {
+		h->signature = signature;
+		h->seed		 = seed;
+		h->n_players = (player_t)n_players;
+		h->simulate	 = (long)simulate;
+		h->done_n	 = (long)done_n;
+	}
+	ok = ok && (size_t)(last - first) == fread (h->done, 1, (size_t)(last - first), f);
+	ok = ok && summations_calloc (sm, h->n_players);
+	ok = ok && summations_fread (f, sm, h->n_players);
+
+	fclose (f);
+
+	if (!ok) {
+		simfile_done (h);
+		summations_done (sm);
+	}
+	return ok;
+}
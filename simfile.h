@@ -0,0 +1,54 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_SIMFILE)
+#define H_SIMFILE
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "boolean.h"
+#include "mytypes.h"
+
+/*
+|	Simulation accumulators saved to a file. The file covers the
+|	simulations first <= z < last of a run of "simulate" simulations,
+|	done[z-first] tells which ones were completed.
+*/
+
+struct SIMFILE {
+	uint64_t		signature;	// input and options that produced the file
+	player_t		n_players;
+	long			simulate;
+	uint32_t		seed;
+	long			first;
+	long			last;
+	long			done_n;
+	unsigned char *	done;
+};
+
+extern bool_t 	simfile_init (struct SIMFILE *h, long first, long last);
+extern void 	simfile_done (struct SIMFILE *h);
+
+extern bool_t 	simfile_write (const char *fname, const struct SIMFILE *h, const struct summations *sm);
+
+// allocates h->done and sm, sm must have been set with summations_init()
+extern bool_t 	simfile_read (const char *fname, struct SIMFILE *h, struct summations *sm);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
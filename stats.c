@@ -0,0 +1,181 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "stats.h"
+#include "mytimer.h"
+
+static const char *Stat_key[STAT_N] = {
+	  "games"
+	, "encounters"
+	, "encounters_merged"
+	, "encmerge_builds"
+	, "iterations"
+	, "unfitness"
+	, "unfitness_bayes"
+	, "pwdl"
+	, "rollbacks"
+	, "simulations"
+	, "simulated_games"
+	, "summamtx_locks"
+	, "summamtx_wait_ns"
+	, "smpcount_locks"
+	, "smpcount_wait_ns"
+};
+
+static const char *Stat_label[STAT_N] = {
+	  "Games read"
+	, "Encounters built"
+	, "Encounters merged by color"
+	, "Merge layouts built"
+	, "Solver iterations"
+	, "Unfitness evaluations"
+	, "Unfitness evaluations (bayes)"
+	, "Probability evaluations (pWDL)"
+	, "Rejected steps (rolled back)"
+	, "Simulations"
+	, "Simulated games"
+	, "Summamtx locks"
+	, "Summamtx wait (s)"
+	, "Smpcount locks"
+	, "Smpcount wait (s)"
+};
+
+static bool_t 		Stats_print = FALSE;
+static const char *	Stats_json = NULL;
+
+#if !defined(NO_STATS)
+
+#define STATS_BLOCKS_MAX 1024
+
+bool_t Stats_on = FALSE; // set before any thread starts, only read afterwards
+
+MYTHREAD_LOCAL struct STATBLOCK *Stats_local = NULL;
+
+static struct STATBLOCK *	Block[STATS_BLOCKS_MAX];
+static myatomic_t			Block_n = 0;
+static struct STATBLOCK		Overflow; // shared by threads beyond the maximum, may lose counts
+
+struct STATBLOCK *
+stats_attach (void)
+{
+	int64_t i = myatomic_add (&Block_n, 1) - 1;
+	struct STATBLOCK *b = NULL;
+
+	if (i < STATS_BLOCKS_MAX && NULL != (b = calloc (1, sizeof(struct STATBLOCK))))
+		Block[i] = b;
+	else
+		b = &Overflow;
+	return Stats_local = b;
+}
+
+void
+stats_mutex_lock (mythread_mutex_t *m, enum STAT locks)
+{
+	double t = wallclock();
+	mythread_mutex_lock (m);
+	STAT_INC (locks);
+	STAT_ADD (locks + 1, (wallclock() - t) * 1E9);
+}
+
+static void
+stats_sum (int64_t *v)
+{
+	int64_t i, n = myatomic_get (&Block_n);
+	int c;
+
+	if (n > STATS_BLOCKS_MAX) n = STATS_BLOCKS_MAX;
+
+	for (c = 0; c < STAT_N; c++)
+		v[c] = Overflow.v[c];
+	for (i = 0; i < n; i++) {
+		if (Block[i] == NULL) continue;
+		for (c = 0; c < STAT_N; c++)
+			v[c] += Block[i]->v[c];
+	}
+}
+
+#else
+
+static void
+stats_sum (int64_t *v)
+{
+	int c;
+	for (c = 0; c < STAT_N; c++) v[c] = 0;
+}
+
+#endif
+
+static bool_t
+is_wait (int c)
+{
+	return c == STAT_SUMMAMTX_WAIT || c == STAT_SMPCOUNT_WAIT;
+}
+
+// at exit, so the counters are complete whatever path the program takes to finish
+static void
+stats_flush (void)
+{
+	int64_t v[STAT_N];
+	int c;
+
+	stats_sum (v);
+
+	if (Stats_print) {
+		printf ("\nCounters\n");
+		for (c = 0; c < STAT_N; c++) {
+			if (is_wait(c))
+				printf ("  %-32s %14.6f\n", Stat_label[c], (double)v[c] * 1E-9);
+			else
+				printf ("  %-32s %14ld\n", Stat_label[c], (long)v[c]);
+		}
+	}
+
+	if (Stats_json) {
+		FILE *f = fopen (Stats_json, "w");
+		if (f == NULL) {
+			fprintf (stderr, "Counters could not be saved in \"%s\"\n", Stats_json);
+			return;
+		}
+		fprintf (f, "{\n");
+		for (c = 0; c < STAT_N; c++)
+			fprintf (f, "  \"%s\": %ld%s\n", Stat_key[c], (long)v[c], c + 1 < STAT_N? ",": "");
+		fprintf (f, "}\n");
+		fclose (f);
+	}
+}
+
+void
+stats_output (bool_t print, const char *jsonfile)
+{
+	#if defined(NO_STATS)
+	if (print || jsonfile != NULL) 
+		fprintf (stderr, "Counters are not available in this build (NO_STATS)\n");
+	return;
+	#endif
+	if (!Stats_print && Stats_json == NULL && (print || jsonfile != NULL))
+		atexit (stats_flush);
+	Stats_print = Stats_print || print;
+	if (jsonfile != NULL) Stats_json = jsonfile;
+	#if !defined(NO_STATS)
+	Stats_on = Stats_print || Stats_json != NULL;
+	#endif
+}
@@ -0,0 +1,83 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if !defined(H_STATS)
+#define H_STATS
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "boolean.h"
+#include "sysport.h"
+
+/*
+|	Counters of the hot paths. Each thread counts in its own block,
+|	so counting needs no locks; blocks are added up when reported.
+|	Nothing is counted unless the counters are requested (stats_output),
+|	and the locks are only timed then. Compiling with -DNO_STATS removes
+|	them.
+*/
+
+enum STAT {
+	  STAT_GAMES				// games read
+	, STAT_ENCOUNTERS			// encounters built from the games
+	, STAT_ENCOUNTERS_MERGED	// encounters added to the one of the other color
+	, STAT_ENCMERGE_BUILDS		// pairs matched for the merge (not reused)
+	, STAT_ITERATIONS			// solver iterations
+	, STAT_UNFITNESS			// unfitness() evaluations
+	, STAT_UNFITNESS_BAYES		// calc_bayes_unfitness_full() evaluations
+	, STAT_PWDL					// get_pWDL() evaluations
+	, STAT_ROLLBACKS			// rejected solver steps restored from a backup
+	, STAT_SIMULATIONS			// simulations completed
+	, STAT_SIM_GAMES			// games simulated
+	, STAT_SUMMAMTX_LOCKS
+	, STAT_SUMMAMTX_WAIT		// nanoseconds
+	, STAT_SMPCOUNT_LOCKS
+	, STAT_SMPCOUNT_WAIT		// nanoseconds
+	, STAT_N
+};
+
+#if defined(NO_STATS)
+
+	#define STAT_ADD(c,x)
+	#define STAT_INC(c)
+	#define STAT_LOCK(m,c) mythread_mutex_lock(m)
+
+#else
+
+	struct STATBLOCK {
+		int64_t v[STAT_N];
+	};
+
+	extern bool_t Stats_on;
+	extern MYTHREAD_LOCAL struct STATBLOCK *Stats_local;
+	extern struct STATBLOCK *stats_attach (void);
+
+	#define STAT_ADD(c,x) do {if (Stats_on) (Stats_local? Stats_local: stats_attach())->v[c] += (int64_t)(x);} while (0)
+	#define STAT_INC(c) STAT_ADD(c,1)
+	#define STAT_LOCK(m,c) do {if (Stats_on) stats_mutex_lock(m,c); else mythread_mutex_lock(m);} while (0)
+
+	extern void stats_mutex_lock (mythread_mutex_t *m, enum STAT locks); // wait time goes to locks+1
+
+#endif
+
+extern void		stats_output (bool_t print, const char *jsonfile); // at exit
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
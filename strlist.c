@@ -127,6 +127,15 @@ strlist_done (strlist_t *sl)
 }
 
 
+size_t
+strlist_count (const strlist_t *sl)
+{
+	size_t n = 0;
+	const strnode_t *p;
+	if (sl) for (p = sl->prehead.nxt; p != NULL; p = p->nxt) n++;
+	return n;
+}
+
 void
 strlist_rwnd (strlist_t *sl)
 {
@@ -23,6 +23,7 @@
 #define H_STRLIST
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
+#include <stddef.h>
 #include "boolean.h"
 
 struct STRNODE;
@@ -47,6 +48,7 @@ typedef struct STRLIST strlist_t;
 extern bool_t 		strlist_init (strlist_t *sl);
 extern void 		strlist_done (strlist_t *sl);
 extern bool_t 		strlist_push (strlist_t *sl, const char *s);
+extern size_t 		strlist_count (const strlist_t *sl);
 extern void 		strlist_rwnd (strlist_t *sl);
 extern const char *	strlist_next (strlist_t *sl);
 
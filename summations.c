@@ -19,6 +19,7 @@
 */
 
 #include <stddef.h>
+#include <stdio.h>
 #include <assert.h>
 #include <math.h>
 
@@ -69,7 +70,10 @@ summations_clear (struct summations *sm, player_t nplayers)
 	for (i = 0; i < np; i++) {
 		sm->sum1[i] = 0;
 		sm->sum2[i] = 0;
+		sm->sum3[i] = 0;
+		sm->sum4[i] = 0;
 		sm->sdev[i] = 0;
+		sm->shift[i] = 0;
 	}
 }
 
@@ -86,11 +90,16 @@ summations_calloc (struct summations *sm, player_t nplayers)
 	double 					*b;
 	double 					*c;
 	struct DEVIATION_ACC	*d;
+	double 					*e;
+	double 					*f;
+	double 					*g;
 
 	size_t		sa = sizeof(double);
 	size_t		sb = sizeof(double);
 	size_t		sc = sizeof(double);
 	size_t		sd = allocsize;
+	size_t		se = sizeof(double);
+	size_t		sf = sizeof(double);
 
 	assert (sm);
 	assert(nplayers > 0);
@@ -112,12 +121,39 @@ summations_calloc (struct summations *sm, player_t nplayers)
 		memrel(b);
 		memrel(c);
 		return FALSE;
+	} else 
+	if (NULL == (e = memnew (se * (size_t)nplayers))) {
+		memrel(a);
+		memrel(b);
+		memrel(c);
+		memrel(d);
+		return FALSE;
+	} else 
+	if (NULL == (f = memnew (sf * (size_t)nplayers))) {
+		memrel(a);
+		memrel(b);
+		memrel(c);
+		memrel(d);
+		memrel(e);
+		return FALSE;
+	} else 
+	if (NULL == (g = memnew (sizeof(double) * (size_t)nplayers))) {
+		memrel(a);
+		memrel(b);
+		memrel(c);
+		memrel(d);
+		memrel(e);
+		memrel(f);
+		return FALSE;
 	} 
 
 	sm->sum1 	 	= a; 
 	sm->sum2 	 	= b; 
 	sm->sdev	 	= c; 
 	sm->relative 	= d; 
+	sm->sum3 	 	= e; 
+	sm->sum4 	 	= f; 
+	sm->shift 	 	= g; 
 
 	summations_clear (sm, nplayers);
 
@@ -131,6 +167,9 @@ summations_init (struct summations *sm)
 	sm->relative = NULL;
 	sm->sum1 = NULL;
 	sm->sum2 = NULL;
+	sm->sum3 = NULL;
+	sm->sum4 = NULL;
+	sm->shift = NULL;
 	sm->sdev = NULL; 
 	sm->wa_sum1 = 0;
 	sm->wa_sum2 = 0;                               
@@ -148,11 +187,17 @@ summations_done (struct summations *sm)
 
 	if (sm->sum1) 		memrel (sm->sum1);
 	if (sm->sum2) 		memrel (sm->sum2);
+	if (sm->sum3) 		memrel (sm->sum3);
+	if (sm->sum4) 		memrel (sm->sum4);
+	if (sm->shift) 		memrel (sm->shift);
 	if (sm->sdev)	 	memrel (sm->sdev);
 	if (sm->relative) 	memrel (sm->relative);
 
 	sm->sum1 	 	= NULL; 
 	sm->sum2 	 	= NULL; 
+	sm->sum3 	 	= NULL; 
+	sm->sum4 	 	= NULL; 
+	sm->shift 	 	= NULL; 
 	sm->sdev	 	= NULL; 
 	sm->relative 	= NULL; 
 
@@ -169,7 +214,7 @@ summations_update	( struct summations *sm
 {
 	player_t i, j;
 	ptrdiff_t idx;
-	double diff;
+	double diff, d, d2;
 
 	sm->wa_sum1 += white_advantage;
 	sm->wa_sum2 += white_advantage * white_advantage;				
@@ -178,8 +223,12 @@ summations_update	( struct summations *sm
 
 	// update summations for errors
 	for (i = 0; i < topn; i++) {
+		d = ratingof[i] - sm->shift[i];
+		d2 = d*d;
 		sm->sum1[i] += ratingof[i];
 		sm->sum2[i] += ratingof[i]*ratingof[i];
+		sm->sum3[i] += d2*d;
+		sm->sum4[i] += d2*d2;
 		for (j = 0; j < i; j++) {
 			idx = head2head_idx_sdev ((ptrdiff_t)i, (ptrdiff_t)j);
 			assert(idx < (ptrdiff_t)((topn*topn-topn)/2));
@@ -190,6 +239,15 @@ summations_update	( struct summations *sm
 	}
 }
 
+void
+summations_set_shift (struct summations *sm, player_t nplayers, const double *shift)
+{
+	player_t i;
+	for (i = 0; i < nplayers; i++) {
+		sm->shift[i] = shift[i];
+	}
+}
+
 void
 summations_calc_sdev (struct summations *sm, player_t topn, double sim_n)
 {
@@ -206,3 +264,127 @@ summations_calc_sdev (struct summations *sm, player_t topn, double sim_n)
 	sm->dr_sdev = get_sdev (sm->dr_sum1, sm->dr_sum2, sim_n+1);
 }
 
+/*
+|	Raw accumulators, so that summations of independent runs can be
+|	saved and added. sdev is not saved, it is recalculated after adding.
+*/
+
+static bool_t
+doubles_fwrite (FILE *f, const double *x, size_t n)
+{
+	return n == fwrite (x, sizeof(double), n, f);
+}
+
+static bool_t
+doubles_fread (FILE *f, double *x, size_t n)
+{
+	return n == fread (x, sizeof(double), n, f);
+}
+
+bool_t
+summations_fwrite (FILE *f, const struct summations *sm, player_t nplayers)
+{
+	ptrdiff_t np = (ptrdiff_t)nplayers;
+	ptrdiff_t est = (ptrdiff_t)((np*np-np)/2); /* elements of simulation table */
+	ptrdiff_t idx;
+	double x[4];
+	bool_t ok = TRUE;
+
+	x[0] = sm->wa_sum1;
+	x[1] = sm->wa_sum2;
+	x[2] = sm->dr_sum1;
+	x[3] = sm->dr_sum2;
+
+	ok = ok && doubles_fwrite (f, x, 4);
+	ok = ok && doubles_fwrite (f, sm->sum1, (size_t)np);
+	ok = ok && doubles_fwrite (f, sm->sum2, (size_t)np);
+	ok = ok && doubles_fwrite (f, sm->sum3, (size_t)np);
+	ok = ok && doubles_fwrite (f, sm->sum4, (size_t)np);
+	for (idx = 0; ok && idx < est; idx++) {
+		x[0] = sm->relative[idx].sum1;
+		x[1] = sm->relative[idx].sum2;
+		ok = doubles_fwrite (f, x, 2);
+	}
+	return ok;
+}
+
+bool_t
+summations_fread (FILE *f, struct summations *sm, player_t nplayers)
+{
+	ptrdiff_t np = (ptrdiff_t)nplayers;
+	ptrdiff_t est = (ptrdiff_t)((np*np-np)/2); /* elements of simulation table */
+	ptrdiff_t idx;
+	double x[4];
+	bool_t ok = TRUE;
+
+	ok = ok && doubles_fread (f, x, 4);
+	if (ok) {
+		sm->wa_sum1 = x[0];
+		sm->wa_sum2 = x[1];
+		sm->dr_sum1 = x[2];
+		sm->dr_sum2 = x[3];
+	}
+	ok = ok && doubles_fread (f, sm->sum1, (size_t)np);
+	ok = ok && doubles_fread (f, sm->sum2, (size_t)np);
+	ok = ok && doubles_fread (f, sm->sum3, (size_t)np);
+	ok = ok && doubles_fread (f, sm->sum4, (size_t)np);
+	for (idx = 0; ok && idx < est; idx++) {
+		ok = doubles_fread (f, x, 2);
+		sm->relative[idx].sum1 = x[0];
+		sm->relative[idx].sum2 = x[1];
+	}
+	return ok;
+}
+
+void
+summations_add (struct summations *sm, const struct summations *other, player_t nplayers)
+{
+	ptrdiff_t np = (ptrdiff_t)nplayers;
+	ptrdiff_t est = (ptrdiff_t)((np*np-np)/2); /* elements of simulation table */
+	ptrdiff_t i;
+
+	sm->wa_sum1 += other->wa_sum1;
+	sm->wa_sum2 += other->wa_sum2;
+	sm->dr_sum1 += other->dr_sum1;
+	sm->dr_sum2 += other->dr_sum2;
+
+	for (i = 0; i < np; i++) {
+		sm->sum1[i] += other->sum1[i];
+		sm->sum2[i] += other->sum2[i];
+		sm->sum3[i] += other->sum3[i];
+		sm->sum4[i] += other->sum4[i];
+	}
+	for (i = 0; i < est; i++) {
+		sm->relative[i].sum1 += other->relative[i].sum1;
+		sm->relative[i].sum2 += other->relative[i].sum2;
+	}
+}
+
+/*
+|	Relative standard error of the sdev estimated for player j.
+|	s = sqrt(m2), by the delta method var(s) = (m4 - m2^2) / (4 n m2),
+|	so that var(s)/s^2 = (m4/m2^2 - 1) / (4 n). Central moments m2 and m4
+|	are obtained from sums of d = rating - shift. With ratings around 2000,
+|	raw fourth powers would cancel out, d is only a few points.
+|	Returns a negative number if the rating of j did not vary (e.g. anchors).
+*/
+// no globals
+double
+summations_sdev_relerror (const struct summations *sm, player_t j, double sim_n)
+{
+	double mu = sm->sum1[j] / sim_n;
+	double m2 = sm->sum2[j] / sim_n - mu*mu;
+	double md = mu - sm->shift[j];	// mean of d
+	double e2 = m2 + md*md;
+	double e3 = sm->sum3[j] / sim_n;
+	double e4 = sm->sum4[j] / sim_n;
+	double m4 = e4 - 4*md*e3 + 6*md*md*e2 - 3*md*md*md*md;
+	double k;
+
+	if (!(m2 > 1E-12 * (1 + mu*mu))) return -1;
+
+	k = m4 / (m2*m2) - 1;
+	if (k < 0) k = 0;
+	return sqrt (k / (4 * sim_n));
+}
+
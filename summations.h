@@ -23,6 +23,7 @@
 #define H_SUMMA
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
+#include <stdio.h>
 #include "mytypes.h"
 
 extern bool_t 	summations_calloc (struct summations *sm, player_t nplayers);
@@ -39,7 +40,16 @@ extern void		summations_update
 					, double drawrate_evenmatch
 					);
 
+// ratings that sum3 and sum4 are relative to, the same for runs that are added
+extern void		summations_set_shift (struct summations *sm, player_t nplayers, const double *shift);
+
 extern void		summations_calc_sdev (struct summations *sm, player_t topn, double sim_n);
 
+extern double	summations_sdev_relerror (const struct summations *sm, player_t j, double sim_n);
+
+extern bool_t	summations_fwrite (FILE *f, const struct summations *sm, player_t nplayers);
+extern bool_t	summations_fread (FILE *f, struct summations *sm, player_t nplayers);
+extern void		summations_add (struct summations *sm, const struct summations *other, player_t nplayers);
+
 /*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 #endif
@@ -1,3 +1,7 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE /* CPU affinity */
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
@@ -37,6 +41,22 @@
 
 #endif
 
+/**** SLEEP ******************************************************************************/
+
+#if defined(MVSC)
+	extern void mysleep (long ms) {Sleep ((DWORD)ms);}
+#else
+	#include <time.h>
+	extern void mysleep (long ms) 
+	{
+		struct timespec ts;
+		ts.tv_sec = ms / 1000;
+		ts.tv_nsec = (ms % 1000) * 1000000L;
+		while (0 != nanosleep (&ts, &ts) && errno == EINTR)
+			;
+	}
+#endif
+
 /**** PATH NAMES *************************************************************************/
 
 #if defined(GCCLINUX)
@@ -73,6 +93,109 @@
 	extern int mysys_fopen_max (void) { return FOPEN_MAX;}
 #endif
 
+/**** MAPPED FILES ***********************************************************************/
+
+#if defined(MVSC)
+	extern const void *map_file (const char *path, size_t *psize)
+	{
+		HANDLE f, m;
+		LARGE_INTEGER sz;
+		void *p = NULL;
+
+		f = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (f == INVALID_HANDLE_VALUE) return NULL;
+		if (GetFileSizeEx (f, &sz) && sz.QuadPart > 0
+			&& NULL != (m = CreateFileMappingA (f, NULL, PAGE_READONLY, 0, 0, NULL))) {
+			p = MapViewOfFile (m, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle (m);
+		}
+		CloseHandle (f);
+		if (p != NULL) *psize = (size_t)sz.QuadPart;
+		return p;
+	}
+	extern void unmap_file (const void *p, size_t size) {(void)size; UnmapViewOfFile (p);}
+	extern long mysys_pid (void) {return (long)GetCurrentProcessId();}
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+
+	extern const void *map_file (const char *path, size_t *psize)
+	{
+		struct stat st;
+		void *p = NULL;
+		int fd;
+
+		if (-1 == (fd = open (path, O_RDONLY))) return NULL;
+		if (0 == fstat (fd, &st) && st.st_size > 0) {
+			p = mmap (NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (p == MAP_FAILED) p = NULL;
+		}
+		close (fd); /* the mapping stays */
+		if (p != NULL) *psize = (size_t)st.st_size;
+		return p;
+	}
+	extern void unmap_file (const void *p, size_t size) {munmap ((void *)p, size);}
+	extern long mysys_pid (void) {return (long)getpid();}
+#endif
+
+/**** LOCAL SOCKETS **********************************************************************/
+
+#if defined(GCCLINUX)
+	#include <string.h>
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+
+	extern int local_listen (const char *path)
+	{
+		struct sockaddr_un addr;
+		int fd;
+
+		if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+		if (-1 == (fd = socket (AF_UNIX, SOCK_STREAM, 0))) return -1;
+
+		memset (&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strcpy (addr.sun_path, path);
+		unlink (path); /* left by a previous run */
+
+		if (0 != bind (fd, (struct sockaddr *)&addr, sizeof(addr)) || 0 != listen (fd, 4)) {
+			close (fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	extern int local_accept (int listener, FILE **pin, FILE **pout)
+	{
+		int fd, fd2;
+		FILE *fi, *fo;
+		do {
+			fd = accept (listener, NULL, NULL);
+		} while (fd == -1 && errno == EINTR);
+		if (fd == -1) return 0;
+
+		if (-1 == (fd2 = dup (fd))) {close (fd); return 0;}
+		if (NULL == (fi = fdopen (fd, "r"))) {close (fd); close (fd2); return 0;}
+		if (NULL == (fo = fdopen (fd2, "w"))) {fclose (fi); close (fd2); return 0;}
+		*pin = fi;
+		*pout = fo;
+		return 1;
+	}
+
+	extern void local_close (int listener, const char *path)
+	{
+		close (listener);
+		unlink (path);
+	}
+#else
+	extern int local_listen (const char *path) {(void)path; return -1;}
+	extern int local_accept (int listener, FILE **pin, FILE **pout) {(void)listener; (void)pin; (void)pout; return 0;}
+	extern void local_close (int listener, const char *path) {(void)listener; (void)path;}
+#endif
+
 
 
 #if defined(MULTI_THREADED_INTERFACE)
@@ -389,6 +512,64 @@ mysem_getvalue	(mysem_t *psem, int *pval)
 #endif
 
 
+
+/* atomic counters */
+
+extern int64_t myatomic_add (myatomic_t *a, int64_t x) {return __sync_add_and_fetch (a, x);}
+extern int64_t myatomic_get (myatomic_t *a) {return __sync_add_and_fetch (a, 0);}
+extern void    myatomic_set (myatomic_t *a, int64_t x) {__sync_synchronize(); *a = x; __sync_synchronize();}
+
+/* processors */
+
+extern int
+mysys_cpus (void)
+{
+	long n = sysconf (_SC_NPROCESSORS_ONLN);
+	return n < 1? 1: (int)n;
+}
+
+#if defined(__linux__)
+#include <sched.h>
+#include <string.h>
+extern int /* boolean */
+mythread_set_affinity (int cpu)
+{
+	cpu_set_t set;
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return 0;
+	CPU_ZERO (&set);
+	CPU_SET ((size_t)cpu, &set);
+	return 0 == pthread_setaffinity_np (pthread_self(), sizeof(cpu_set_t), &set);
+}
+
+extern int /* boolean */
+mythread_get_affinity (myaffinity_t *a)
+{
+	cpu_set_t set;
+	if (sizeof(set) > sizeof(a->mask) || 0 != pthread_getaffinity_np (pthread_self(), sizeof(cpu_set_t), &set))
+		return 0;
+	memset (a->mask, 0, sizeof(a->mask));
+	memcpy (a->mask, &set, sizeof(set));
+	return 1;
+}
+
+extern void
+mythread_restore_affinity (const myaffinity_t *a)
+{
+	cpu_set_t set;
+	memcpy (&set, a->mask, sizeof(set));
+	pthread_setaffinity_np (pthread_self(), sizeof(cpu_set_t), &set);
+}
+#else
+extern int /* boolean */
+mythread_set_affinity (int cpu) {(void)cpu; return 0;}
+
+extern int /* boolean */
+mythread_get_affinity (myaffinity_t *a) {(void)a; return 0;}
+
+extern void
+mythread_restore_affinity (const myaffinity_t *a) {(void)a;}
+#endif
+
 /*
 |
 |	NT_THREADS
@@ -492,11 +673,176 @@ mysem_destroy	(mysem_t *sem)
 	return 0 != CloseHandle( *sem);
 }
 
+/* atomic counters */
+
+extern int64_t myatomic_add (myatomic_t *a, int64_t x) {return InterlockedExchangeAdd64 (a, x) + x;}
+extern int64_t myatomic_get (myatomic_t *a) {return InterlockedExchangeAdd64 (a, 0);}
+extern void    myatomic_set (myatomic_t *a, int64_t x) {InterlockedExchange64 (a, x);}
+
+/* processors */
+
+extern int
+mysys_cpus (void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo (&si);
+	return si.dwNumberOfProcessors < 1? 1: (int)si.dwNumberOfProcessors;
+}
+
+extern int /* boolean */
+mythread_set_affinity (int cpu)
+{
+	if (cpu < 0 || cpu >= (int)(8 * sizeof(DWORD_PTR))) return 0;
+	return 0 != SetThreadAffinityMask (GetCurrentThread(), (DWORD_PTR)1 << cpu);
+}
+
+// there is no query for a thread, so its mask is read back when replaced
+extern int /* boolean */
+mythread_get_affinity (myaffinity_t *a)
+{
+	DWORD_PTR process, system, old;
+	if (!GetProcessAffinityMask (GetCurrentProcess(), &process, &system)
+		|| 0 == (old = SetThreadAffinityMask (GetCurrentThread(), process)))
+		return 0;
+	SetThreadAffinityMask (GetCurrentThread(), old);
+	a->mask[0] = (uint64_t)old;
+	return 1;
+}
+
+extern void
+mythread_restore_affinity (const myaffinity_t *a)
+{
+	SetThreadAffinityMask (GetCurrentThread(), (DWORD_PTR)a->mask[0]);
+}
+
 /**** THREADS ****************************************************************************/
 #else
 	#error Definition of threads not present
 #endif
 
+/**** NUMA NODES *************************************************************************/
+
+#define NUMA_MAXNODES 256
+#define NUMA_MAXCPUS  4096
+
+static int Numa_n = 0; 						/* 0 = not read yet */
+static int Numa_start [NUMA_MAXNODES + 1];	/* cpus of node i are Numa_cpu[Numa_start[i]..Numa_start[i+1]) */
+static int Numa_cpu   [NUMA_MAXCPUS];
+
+#if defined(__linux__)
+/* list like "0-63,128-191" */
+static int
+numa_read_cpulist (const char *fname, int *cpu, int max)
+{
+	FILE *f;
+	int a, b, c, k = 0;
+	if (NULL == (f = fopen (fname, "r"))) return -1;
+	while (1 == fscanf (f, "%d", &a)) {
+		b = a;
+		c = fgetc (f);
+		if (c == '-') {
+			if (1 != fscanf (f, "%d", &b)) break;
+			c = fgetc (f);
+		}
+		for (; a <= b && k < max; a++) cpu[k++] = a;
+		if (c != ',') break;
+	}
+	fclose (f);
+	return k;
+}
+#endif
+
+/* not thread safe the first time, call it before starting threads */
+static void
+numa_topology (void)
+{
+	int i, k = 0;
+
+	if (Numa_n > 0) return;
+
+	#if defined(__linux__)
+	for (i = 0; i < NUMA_MAXNODES; i++) {
+		char fname[64];
+		int r;
+		sprintf (fname, "/sys/devices/system/node/node%d/cpulist", i);
+		r = numa_read_cpulist (fname, Numa_cpu + k, NUMA_MAXCPUS - k);
+		if (r < 0) break;
+		if (r == 0) continue; /* memory only node */
+		Numa_start[Numa_n++] = k;
+		k += r;
+	}
+	#endif
+
+	if (Numa_n == 0) {
+		int n = mysys_cpus();
+		for (i = 0; i < n && i < NUMA_MAXCPUS; i++) Numa_cpu[i] = i;
+		k = i;
+		Numa_start[Numa_n++] = 0;
+	}
+	Numa_start[Numa_n] = k;
+}
+
+extern int mysys_numa_nodes (void) {numa_topology(); return Numa_n;}
+
+extern int 
+mysys_numa_cpus (int node) 
+{
+	numa_topology(); 
+	return node < 0 || node >= Numa_n? 0: Numa_start[node+1] - Numa_start[node];
+}
+
+extern int 
+mysys_numa_cpu (int node, int k) 
+{
+	int n = mysys_numa_cpus (node);
+	return k < 0 || k >= n? -1: Numa_cpu[Numa_start[node] + k];
+}
+
+/**** BARRIERS ***************************************************************************/
+
+/*
+|	Two gates used alternately. A thread cannot arrive at the barrier
+|	after the next one before all threads left this one, so the posts
+|	of a gate are never taken by the wrong round.
+*/
+
+extern int /* boolean */
+mybarrier_init (mybarrier_t *b, unsigned n)
+{
+	b->n = n;
+	b->count = 0;
+	b->phase = 0;
+	mythread_mutex_init (&b->mtx);
+	if (!mysem_init (&b->gate[0], 0)) return 0;
+	if (!mysem_init (&b->gate[1], 0)) {mysem_destroy (&b->gate[0]); return 0;}
+	return 1;
+}
+
+extern void
+mybarrier_wait (mybarrier_t *b)
+{
+	unsigned i, p;
+	mythread_mutex_lock (&b->mtx);
+	p = b->phase;
+	if (++b->count == b->n) {
+		b->count = 0;
+		b->phase = 1 - p;
+		for (i = 1; i < b->n; i++) mysem_post (&b->gate[p]);
+		mythread_mutex_unlock (&b->mtx);
+	} else {
+		mythread_mutex_unlock (&b->mtx);
+		mysem_wait (&b->gate[p]);
+	}
+}
+
+extern void
+mybarrier_done (mybarrier_t *b)
+{
+	mysem_destroy (&b->gate[0]);
+	mysem_destroy (&b->gate[1]);
+	mythread_mutex_destroy (&b->mtx);
+}
+
 /* MULTI_THREADED_INTERFACE */
 #endif
 
@@ -149,6 +149,25 @@ extern int isfoldersep (int x);
 
 extern int mysys_fopen_max (void);
 
+/*-----------------
+	LOCAL SOCKETS
+------------------*/
+
+/* UNIX domain stream sockets, not available on Windows (local_listen fails) */
+#include <stdio.h>
+extern int		local_listen (const char *path); /* -1 on failure */
+extern int		local_accept (int listener, FILE **pin, FILE **pout); /* 0 on failure, one stream each way */
+extern void		local_close (int listener, const char *path);
+
+/*-----------------
+	MAPPED FILES
+------------------*/
+
+/* read-only view of a whole file, NULL on failure or if it is empty */
+extern const void *	map_file (const char *path, size_t *psize);
+extern void			unmap_file (const void *p, size_t size);
+extern long			mysys_pid (void);
+
 /*------------ 
 	TIMER 
 -------------*/
@@ -157,6 +176,7 @@ typedef int64_t myclock_t;
 
 extern myclock_t myclock(void);
 extern myclock_t ticks_per_sec (void);
+extern void mysleep (long ms);
 
 #define MYCLOCKS_PER_SEC (ticks_per_sec())
 #define GET_TICK (myclock())
@@ -281,6 +301,49 @@ extern int /*boolean*/	mysem_destroy	(mysem_t *sem);
 extern int /*boolean*/ 	mysem_getvalue	(mysem_t *sem, int *pval);
 #endif
 
+/* thread local storage, for static variables */
+#if defined(MVSC)
+	#define MYTHREAD_LOCAL __declspec(thread)
+#else
+	#define MYTHREAD_LOCAL __thread
+#endif
+
+/* atomic counters */
+typedef volatile int64_t myatomic_t;
+
+extern int64_t			myatomic_add	(myatomic_t *a, int64_t x); /* returns the new value */
+extern int64_t			myatomic_get	(myatomic_t *a);
+extern void				myatomic_set	(myatomic_t *a, int64_t x);
+
+/* barriers, reusable */
+struct myBARRIER {
+	mythread_mutex_t	mtx;
+	mysem_t				gate[2];
+	unsigned			n;
+	unsigned			count;
+	unsigned			phase;
+};
+
+typedef struct myBARRIER mybarrier_t;
+
+extern int /*boolean*/	mybarrier_init	(mybarrier_t *b, unsigned n);
+extern void				mybarrier_wait	(mybarrier_t *b);
+extern void				mybarrier_done	(mybarrier_t *b);
+
+/* processors */
+extern int				mysys_cpus (void);
+extern int /*boolean*/	mythread_set_affinity (int cpu); /* current thread, FALSE if cpu is out of range or not supported */
+
+/* affinity of the current thread, to put it back after mythread_set_affinity */
+typedef struct {uint64_t mask[16];} myaffinity_t;
+extern int /*boolean*/	mythread_get_affinity (myaffinity_t *a);
+extern void				mythread_restore_affinity (const myaffinity_t *a); /* only if get succeeded */
+
+/* NUMA nodes, a single one with all the processors if they cannot be found */
+extern int				mysys_numa_nodes (void);
+extern int				mysys_numa_cpus (int node);
+extern int				mysys_numa_cpu (int node, int k); /* k-th processor of node */
+
 #endif
 
 /* end MULTI_THREADED_INTERFACE*/
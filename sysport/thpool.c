@@ -0,0 +1,313 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "thpool.h"
+
+#define DEQUE_MIN 64
+
+struct TASK {
+	thpool_task_fn	fn;
+	void *			arg;
+};
+
+// ring buffer, tasks are buf[(head..tail-1) % cap]
+struct DEQUE {
+	mythread_spinx_t	lock;
+	struct TASK *		buf;
+	long				cap;
+	long				head;
+	long				tail;
+};
+
+struct WORKER {
+	thpool_t *		pool;
+	int				id;
+	int				affinity;
+};
+
+struct THPOOL {
+	int					n;
+	mythread_t *		th;
+	struct WORKER *		wk;
+	struct DEQUE *		dq;			// n + 1, the last one for the waiting thread
+	mysem_t				wake;		// one post for each task submitted
+	mysem_t				idle;		// posted when pending drops to zero
+	myatomic_t			pending;	// submitted and not finished
+	myatomic_t			rr;			// round robin for tasks from outside
+	myatomic_t			quit;
+};
+
+/*---- deques ------------------------------------------------------------*/
+
+static int
+deque_init (struct DEQUE *d)
+{
+	d->buf = malloc (sizeof(struct TASK) * DEQUE_MIN);
+	d->cap = DEQUE_MIN;
+	d->head = 0;
+	d->tail = 0;
+	mythread_spinx_init (&d->lock);
+	return d->buf != NULL;
+}
+
+static void
+deque_done (struct DEQUE *d)
+{
+	mythread_spinx_destroy (&d->lock);
+	free (d->buf);
+	d->buf = NULL;
+}
+
+static void
+deque_push (struct DEQUE *d, thpool_task_fn fn, void *arg)
+{
+	mythread_spinx_lock (&d->lock);
+	if (d->tail - d->head == d->cap) {
+		long i, cap = 2 * d->cap;
+		struct TASK *b = malloc (sizeof(struct TASK) * (size_t)cap);
+		if (b == NULL) {
+			fprintf (stderr, "Not enough memory for the thread pool\n");
+			exit(EXIT_FAILURE);
+		}
+		for (i = d->head; i < d->tail; i++)
+			b[i - d->head] = d->buf[i % d->cap];
+		free (d->buf);
+		d->buf = b;
+		d->tail -= d->head;
+		d->head = 0;
+		d->cap = cap;
+	}
+	d->buf[d->tail % d->cap].fn  = fn;
+	d->buf[d->tail % d->cap].arg = arg;
+	d->tail++;
+	mythread_spinx_unlock (&d->lock);
+}
+
+// owner side, newest first
+static int
+deque_pop (struct DEQUE *d, struct TASK *t)
+{
+	int ok = 0;
+	mythread_spinx_lock (&d->lock);
+	if (d->tail > d->head) {
+		d->tail--;
+		*t = d->buf[d->tail % d->cap];
+		ok = 1;
+	}
+	mythread_spinx_unlock (&d->lock);
+	return ok;
+}
+
+// thief side, oldest first
+static int
+deque_steal (struct DEQUE *d, struct TASK *t)
+{
+	int ok = 0;
+	mythread_spinx_lock (&d->lock);
+	if (d->tail > d->head) {
+		*t = d->buf[d->head % d->cap];
+		d->head++;
+		ok = 1;
+	}
+	mythread_spinx_unlock (&d->lock);
+	return ok;
+}
+
+/*---- workers -----------------------------------------------------------*/
+
+static int
+task_get (thpool_t *p, int self, struct TASK *t)
+{
+	int i, k, m = p->n + 1;
+	if (deque_pop (&p->dq[self], t)) return 1;
+	for (i = 1; i < m; i++) {
+		k = (self + i) % m;
+		if (deque_steal (&p->dq[k], t)) return 1;
+	}
+	return 0;
+}
+
+static void
+task_run (thpool_t *p, int self, struct TASK *t)
+{
+	t->fn (t->arg, self);
+	if (0 == myatomic_add (&p->pending, -1))
+		mysem_post (&p->idle);
+}
+
+static thread_return_t THREAD_CALL
+worker_main (void *a)
+{
+	struct WORKER *w = a;
+	thpool_t *p = w->pool;
+	struct TASK t;
+
+	if (w->affinity) 
+		mythread_set_affinity (w->id % mysys_cpus());
+
+	for (;;) {
+		mysem_wait (&p->wake);
+		if (myatomic_get (&p->quit)) break;
+		while (task_get (p, w->id, &t)) {
+			task_run (p, w->id, &t);
+		}
+	}
+	return (thread_return_t) 0;
+}
+
+/*---- interface ---------------------------------------------------------*/
+
+thpool_t *
+thpool_new (int workers, int affinity)
+{
+	thpool_t *p;
+	int i, err;
+
+	if (workers < 0) workers = 0;
+	if (NULL == (p = malloc (sizeof(thpool_t)))) return NULL;
+
+	p->n  = workers;
+	p->th = malloc (sizeof(mythread_t) * (size_t)(workers + 1));
+	p->wk = malloc (sizeof(struct WORKER) * (size_t)(workers + 1));
+	p->dq = malloc (sizeof(struct DEQUE) * (size_t)(workers + 1));
+	if (p->th == NULL || p->wk == NULL || p->dq == NULL) {
+		free (p->th); free (p->wk); free (p->dq); free (p);
+		return NULL;
+	}
+
+	for (i = 0; i <= workers; i++) {
+		if (!deque_init (&p->dq[i])) {
+			fprintf (stderr, "Not enough memory for the thread pool\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	mysem_init (&p->wake, 0);
+	mysem_init (&p->idle, 0);
+	myatomic_set (&p->pending, 0);
+	myatomic_set (&p->rr, 0);
+	myatomic_set (&p->quit, 0);
+
+	for (i = 0; i < workers; i++) {
+		p->wk[i].pool = p;
+		p->wk[i].id = i;
+		p->wk[i].affinity = affinity;
+		if (!mythread_create (&p->th[i], worker_main, &p->wk[i], &err)) {
+			fprintf (stderr, "thread %d, fatal error at creating: %s\n", i, mythread_create_error(err));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	return p;
+}
+
+void
+thpool_kill (thpool_t *p)
+{
+	int i;
+
+	thpool_wait (p);
+
+	myatomic_set (&p->quit, 1);
+	for (i = 0; i < p->n; i++) 
+		mysem_post (&p->wake);
+
+	for (i = 0; i < p->n; i++) {
+		if (!mythread_join (p->th[i])) {
+			fprintf (stderr, "thread %d: fatal problems at joining\n", i);	
+			exit(EXIT_FAILURE);	
+		}
+	}
+
+	for (i = 0; i <= p->n; i++) 
+		deque_done (&p->dq[i]);
+
+	mysem_destroy (&p->wake);
+	mysem_destroy (&p->idle);
+	free (p->th);
+	free (p->wk);
+	free (p->dq);
+	free (p);
+}
+
+int
+thpool_workers (const thpool_t *p)
+{
+	return p->n;
+}
+
+void
+thpool_submit (thpool_t *p, int from, thpool_task_fn fn, void *arg)
+{
+	int k = from;
+
+	if (from >= p->n && p->n > 0) // not a worker, spread the tasks
+		k = (int)(myatomic_add (&p->rr, 1) % p->n);
+
+	myatomic_add (&p->pending, 1);
+	deque_push (&p->dq[k], fn, arg);
+	if (p->n > 0)
+		mysem_post (&p->wake);
+}
+
+void
+thpool_wait (thpool_t *p)
+{
+	struct TASK t;
+
+	while (myatomic_get (&p->pending) > 0) {
+		if (task_get (p, p->n, &t)) {
+			task_run (p, p->n, &t);
+		} else {
+			mysem_wait (&p->idle); // may be a post from a previous round, check again
+		}
+	}
+}
+
+struct RANGEJOB {
+	thpool_range_fn	fn;
+	void *			arg;
+	long			last;
+	long			chunk;
+	myatomic_t		next;
+};
+
+static void
+range_run (void *a, int worker)
+{
+	struct RANGEJOB *j = a;
+	long f, l;
+
+	for (;;) {
+		f = (long)myatomic_add (&j->next, j->chunk) - j->chunk;
+		if (f >= j->last) break;
+		l = f + j->chunk < j->last? f + j->chunk: j->last;
+		j->fn (j->arg, f, l, worker);
+	}
+}
+
+void
+thpool_parallel_for (thpool_t *p, long first, long last, long chunk, thpool_range_fn fn, void *arg)
+{
+	struct RANGEJOB job;
+	int i;
+
+	if (last <= first) return;
+
+	if (chunk <= 0) {
+		chunk = (last - first) / (4 * (p->n + 1));
+		if (chunk < 1) chunk = 1;
+	}
+
+	job.fn = fn;
+	job.arg = arg;
+	job.last = last;
+	job.chunk = chunk;
+	myatomic_set (&job.next, first);
+
+	for (i = 0; i < p->n; i++) 
+		thpool_submit (p, p->n, range_run, &job);
+
+	range_run (&job, p->n);
+	thpool_wait (p);
+}
@@ -0,0 +1,37 @@
+#if !defined(H_THPOOL)
+#define H_THPOOL
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include "sysport.h"
+
+/*
+	Persistent pool of worker threads, built only on the sysport layer.
+
+	Each worker owns a deque of tasks. It takes its own tasks from the
+	back and, when it runs out, steals from the front of the others.
+	The thread that calls thpool_wait() or thpool_parallel_for() works
+	too, as worker number thpool_workers(p). So a pool of 0 workers is
+	valid, and everything runs in the calling thread.
+
+	Only one thread at a time may wait on a pool, and tasks must not
+	wait on the pool they run in.
+*/
+
+typedef struct THPOOL thpool_t;
+
+typedef void (*thpool_task_fn)  (void *arg, int worker);
+typedef void (*thpool_range_fn) (void *arg, long first, long last, int worker);
+
+extern thpool_t *	thpool_new			(int workers, int /*boolean*/ affinity);
+extern void			thpool_kill			(thpool_t *p);
+extern int			thpool_workers		(const thpool_t *p);
+
+/* from: worker that submits, or thpool_workers(p) if it is not a task */
+extern void			thpool_submit		(thpool_t *p, int from, thpool_task_fn fn, void *arg);
+extern void			thpool_wait			(thpool_t *p);
+
+/* fn is called for consecutive pieces of [first,last), chunk <= 0 picks a size */
+extern void			thpool_parallel_for	(thpool_t *p, long first, long last, long chunk, thpool_range_fn fn, void *arg);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
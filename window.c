@@ -0,0 +1,410 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "window.h"
+#include "encount.h"
+#include "pgnget.h"
+#include "mymem.h"
+
+enum WINDOWLIMITS {WINDOWS_x_TASK = 8}; // consecutive windows that warm start each other
+
+struct WINSPAN {
+	  gamesnum_t			first		// positions in the ordered games
+	; gamesnum_t			last
+	; long					label
+	;
+};
+
+struct WINROW {
+	  player_t				j
+	; double				rating
+	; double				error
+	;
+};
+
+struct WINRESULT {
+	  struct WINROW *		row
+	; player_t				n
+	; bool_t				ok
+	; char *				errmsg
+	;
+};
+
+struct WINJOB {
+	  const struct ordo_ctx *lender
+	; const struct WINDOWCTRL *wc
+	; const gamesnum_t *	slot		// encounter of the lender, for each ordered game
+	; const int32_t *		score
+	; const struct WINSPAN *span
+	; struct WINRESULT *	res
+	; long					n_spans
+	;
+};
+
+struct ORDERED {
+	  int32_t				key
+	; gamesnum_t			i
+	;
+};
+
+static int
+compare_ORDERED (const void *a, const void *b)
+{
+	const struct ORDERED *ap = a;
+	const struct ORDERED *bp = b;
+	if (ap->key != bp->key) return ap->key > bp->key? 1: -1;
+	if (ap->i   != bp->i  ) return ap->i   > bp->i  ? 1: -1; // stable
+	return 0;
+}
+
+// encounters are sorted by white, then black
+static gamesnum_t
+find_slot (const struct ENCOUNTERS *e, player_t w, player_t b)
+{
+	gamesnum_t lo = 0, hi = e->n;
+	while (lo < hi) {
+		gamesnum_t mid = lo + (hi - lo) / 2;
+		const struct ENC *x = &e->enc[mid];
+		if (x->wh < w || (x->wh == w && x->bl < b))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < e->n && e->enc[lo].wh == w && e->enc[lo].bl == b? lo: -1;
+}
+
+static char *
+string_dup (const char *s)
+{
+	char *p = memnew (strlen(s) + 1);
+	if (p) strcpy (p, s);
+	return p;
+}
+
+static void
+acc_game (struct ENC *x, int32_t score, int sign)
+{
+	x->played += sign;
+	switch (score) {
+		case WHITE_WIN:		x->W += sign; x->wscore += sign * 1.0; break;
+		case RESULT_DRAW:	x->D += sign; x->wscore += sign * 0.5; break;
+		case BLACK_WIN:		x->L += sign; break;
+	}
+}
+
+static bool_t
+window_store (struct ordo_ctx *ctx, struct WINRESULT *res, double *prev)
+{
+	player_t j, n = ordo_players_n (ctx);
+
+	if (NULL == (res->row = memnew (sizeof(struct WINROW) * (size_t)n)))
+		return FALSE;
+	for (res->n = 0, j = 0; j < n; j++) {
+		prev[j] = ctx->players.flagged[j]? HUGE_VAL: ctx->ra.ratingof[j];
+		if (!ctx->players.present_in_games[j]) continue;
+		res->row[res->n].j		= j;
+		res->row[res->n].rating	= ordo_rating (ctx, j);
+		res->row[res->n].error	= ordo_error (ctx, j);
+		res->n++;
+	}
+	return TRUE;
+}
+
+static void
+window_task (const struct WINJOB *job, long t)
+{
+	const struct ordo_ctx *lender = job->lender;
+	const struct ENCOUNTERS *full = &lender->encounters;
+	player_t n_players = ordo_players_n (lender);
+	long s, s_first = t * WINDOWS_x_TASK;
+	long s_last = s_first + WINDOWS_x_TASK < job->n_spans? s_first + WINDOWS_x_TASK: job->n_spans;
+	struct ordo_config cfg = lender->cfg;
+	struct ENCOUNTERS window;
+	struct ENC *acc;
+	double *prev;
+	bool_t warm = FALSE;
+	double wa = 0, dr = 0;
+	thpool_t *pool = NULL;
+	struct SIMCTRL simctrl;
+	gamesnum_t e, k, cur_first, cur_last;
+
+	cfg.quiet = TRUE;
+
+	memset (&simctrl, 0, sizeof(simctrl));
+	simctrl.seed = job->wc->seed;
+	simctrl.shard_n = 1;
+	simctrl.checkpoint_every = 60;
+
+	acc  = memnew (sizeof(struct ENC) * (size_t)full->n);
+	prev = memnew (sizeof(double) * (size_t)n_players);
+	if (acc == NULL || prev == NULL || !encounters_init (full->n, &window)
+		|| (job->wc->simulate > 1 && NULL == (pool = thpool_new (0, FALSE)))) { // this thread only
+		fprintf (stderr, "Not enough memory for the windows\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (e = 0; e < full->n; e++) {
+		acc[e] = full->enc[e];
+		acc[e].played = acc[e].W = acc[e].D = acc[e].L = 0;
+		acc[e].wscore = 0.0;
+	}
+
+	cur_first = cur_last = job->span[s_first].first;
+
+	for (s = s_first; s < s_last; s++) {
+		const struct WINSPAN *sp = &job->span[s];
+		struct WINRESULT *res = &job->res[s];
+		struct ordo_ctx *ctx;
+		bool_t ok;
+
+		// slide
+		for (k = cur_last; k < sp->last; k++)		acc_game (&acc[job->slot[k]], job->score[k], +1);
+		for (k = cur_first; k < sp->first; k++)		acc_game (&acc[job->slot[k]], job->score[k], -1);
+		cur_first = sp->first;
+		cur_last  = sp->last;
+
+		for (window.n = 0, e = 0; e < full->n; e++) {
+			if (acc[e].played > 0) window.enc[window.n++] = acc[e];
+		}
+
+		if (NULL == (ctx = ordo_new (&cfg))) {
+			fprintf (stderr, "Not enough memory for the windows\n");
+			exit(EXIT_FAILURE);
+		}
+
+		ok = ordo_load_window (ctx, lender, &window) && ordo_priors (ctx);
+		if (ok && warm) ordo_warm_start (ctx, prev, n_players, wa, dr);
+		ok = ok && ordo_transform (ctx) && ordo_solve (ctx);
+
+		if (ok && job->wc->simulate > 1)
+			ordo_simulate (ctx, pool, job->wc->simulate, &simctrl, FALSE);
+
+		if (ok) {
+			if (!window_store (ctx, res, prev)) {
+				fprintf (stderr, "Not enough memory for the windows\n");
+				exit(EXIT_FAILURE);
+			}
+			wa = ordo_white_advantage (ctx);
+			dr = ordo_drawrate (ctx);
+			warm = TRUE;
+		} else {
+			res->errmsg = string_dup (ordo_errmsg (ctx));
+		}
+		res->ok = ok;
+
+		ordo_free (ctx);
+	}
+
+	if (pool) thpool_kill (pool);
+	encounters_done (&window);
+	memrel (prev);
+	memrel (acc);
+}
+
+static void
+window_range (void *arg, long first, long last, int worker)
+{
+	long t;
+	(void)worker;
+	for (t = first; t < last; t++)
+		window_task (arg, t);
+}
+
+static gamesnum_t
+lower_key (const struct ORDERED *o, gamesnum_t n, int32_t key)
+{
+	gamesnum_t lo = 0, hi = n;
+	while (lo < hi) {
+		gamesnum_t mid = lo + (hi - lo) / 2;
+		if (o[mid].key < key) lo = mid + 1; else hi = mid;
+	}
+	return lo;
+}
+
+// room for spans_build, one window per step and the last one
+static long
+spans_max (const struct WINDOWCTRL *wc, const struct ORDERED *o, gamesnum_t m)
+{
+	if (wc->unit == WINDOW_GAMES)
+		return (long)(m / wc->step) + 2;
+	else
+		return (long)((o[m-1].key - o[0].key) / wc->step) + 2;
+}
+
+// windows that end every step, the last one at the end of the history
+static long
+spans_build (const struct WINDOWCTRL *wc, const struct ORDERED *o, gamesnum_t m, struct WINSPAN *span, long max)
+{
+	long n = 0;
+
+	if (wc->unit == WINDOW_GAMES) {
+		gamesnum_t end = wc->size < m? wc->size: m;
+		for (;;) {
+			assert (n < max);
+			if (n == max) break;
+			span[n].first = end > wc->size? end - wc->size: 0;
+			span[n].last  = end;
+			span[n].label = (long)end;
+			n++;
+			if (end == m) break;
+			end = end + wc->step < m? end + wc->step: m;
+		}
+	} else {
+		int32_t kmin = o[0].key, kmax = o[m-1].key;
+		int32_t end = kmin + wc->size - 1 < kmax? kmin + (int32_t)wc->size - 1: kmax;
+		for (;;) {
+			assert (n < max);
+			if (n == max) break;
+			span[n].first = lower_key (o, m, end - (int32_t)wc->size + 1);
+			span[n].last  = lower_key (o, m, end + 1);
+			span[n].label = (long)(end / 12) * 100 + end % 12 + 1;
+			if (span[n].last > span[n].first) n++;
+			if (end == kmax) break;
+			end = end + wc->step < kmax? end + (int32_t)wc->step: kmax;
+		}
+	}
+	return n;
+}
+
+static void
+window_output (FILE *f, const struct ordo_ctx *lender, const struct WINDOWCTRL *wc, const struct WINSPAN *span, const struct WINRESULT *res, long n)
+{
+	bool_t errors = wc->simulate > 1;
+	long s;
+	player_t r;
+
+	fprintf (f, "\"window\",\"player\",\"rating\"%s\n", errors? ",\"error\"": "");
+	for (s = 0; s < n; s++) {
+		for (r = 0; r < res[s].n; r++) {
+			const struct WINROW *x = &res[s].row[r];
+			fprintf (f, "%ld,\"%s\",%.*f", span[s].label, ordo_name (lender, x->j), wc->decimals, x->rating);
+			if (errors) fprintf (f, ",%.*f", wc->decimals, x->error);
+			fprintf (f, "\n");
+		}
+	}
+}
+
+bool_t
+window_run (const struct ordo_ctx *lender, thpool_t *pool, const struct WINDOWCTRL *wc, FILE *csvf)
+{
+	const struct DATA *pdaba = lender->pdaba;
+	struct ORDERED *o;
+	gamesnum_t *slot;
+	int32_t *score;
+	struct WINSPAN *span;
+	struct WINRESULT *res;
+	struct WINJOB job;
+	gamesnum_t i, m;
+	long n, s;
+	bool_t ok = TRUE;
+
+	o		= memnew (sizeof(struct ORDERED) * (size_t)pdaba->n_games);
+	slot	= memnew (sizeof(gamesnum_t) * (size_t)pdaba->n_games);
+	score	= memnew (sizeof(int32_t) * (size_t)pdaba->n_games);
+	if (o == NULL || slot == NULL || score == NULL) {
+		fprintf (stderr, "Not enough memory for the windows\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// games that count, in the order of the windows
+	for (m = 0, i = 0; i < pdaba->n_games; i++) {
+		struct gamei g;
+		int32_t date;
+		database_getgame (pdaba, i, &g, &date);
+		if (g.score >= DISCARD) continue;
+		if (wc->unit == WINDOW_MONTHS) {
+			int32_t year = date / 10000, month = date / 100 % 100;
+			if (year == 0 || month == 0) continue;
+			o[m].key = year * 12 + month - 1;
+		} else {
+			o[m].key = 0;
+		}
+		o[m].i = i;
+		m++;
+	}
+	if (m == 0) {
+		fprintf (stderr, "No games to make windows%s\n", wc->unit == WINDOW_MONTHS? " (Date tags needed)": "");
+		exit(EXIT_FAILURE);
+	}
+	if (wc->unit == WINDOW_MONTHS)
+		qsort (o, (size_t)m, sizeof(struct ORDERED), compare_ORDERED);
+
+	for (i = 0; i < m; i++) {
+		struct gamei g;
+		int32_t date;
+		database_getgame (pdaba, o[i].i, &g, &date);
+		score[i] = g.score;
+		if (0 > (slot[i] = find_slot (&lender->encounters, g.whiteplayer, g.blackplayer))) {
+			fprintf (stderr, "Internal error, game without encounter in the windows\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	n = spans_max (wc, o, m);
+	if (NULL == (span = memnew (sizeof(struct WINSPAN) * (size_t)n))) {
+		fprintf (stderr, "Not enough memory for the windows\n");
+		exit(EXIT_FAILURE);
+	}
+	n = spans_build (wc, o, m, span, n);
+
+	if (NULL == (res = memnew (sizeof(struct WINRESULT) * (size_t)n))) {
+		fprintf (stderr, "Not enough memory for the windows\n");
+		exit(EXIT_FAILURE);
+	}
+	for (s = 0; s < n; s++) {
+		res[s].row = NULL;
+		res[s].n = 0;
+		res[s].ok = FALSE;
+		res[s].errmsg = NULL;
+	}
+
+	job.lender	= lender;
+	job.wc		= wc;
+	job.slot	= slot;
+	job.score	= score;
+	job.span	= span;
+	job.res		= res;
+	job.n_spans	= n;
+	thpool_parallel_for (pool, 0, (n + WINDOWS_x_TASK - 1) / WINDOWS_x_TASK, 1, window_range, &job);
+
+	window_output (csvf, lender, wc, span, res, n);
+
+	for (s = 0; s < n; s++) {
+		if (!res[s].ok) {
+			fprintf (stderr, "Window %ld: %s", span[s].label, res[s].errmsg? res[s].errmsg: "not enough memory\n");
+			ok = FALSE;
+		}
+		if (res[s].row) memrel (res[s].row);
+		if (res[s].errmsg) memrel (res[s].errmsg);
+	}
+
+	memrel (res);
+	memrel (span);
+	memrel (score);
+	memrel (slot);
+	memrel (o);
+	return ok;
+}
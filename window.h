@@ -0,0 +1,60 @@
+/*
+	Ordo is program for calculating ratings of engine or chess players
+    Copyright 2013 Miguel A. Ballicora
+
+    This file is part of Ordo.
+
+    Ordo is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Ordo is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Ordo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if !defined(H_WINDOW)
+#define H_WINDOW
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#include <stdio.h>
+#include "boolean.h"
+#include "libordo.h"
+#include "thpool.h"
+
+/*
+|	Ratings of successive windows of the history, in one pass. Games are
+|	taken in input order, or ordered by their Date tag (WINDOW_MONTHS,
+|	games without year and month are skipped). A window has the last
+|	"size" games or months, and the next one ends "step" later.
+|	Encounters are updated with the games that enter and leave the window.
+|	Groups of consecutive windows are solved in parallel, each window
+|	starting from the ratings of the previous one.
+|
+|	Output, one row per player and window:
+|		"window","player",rating[,error]
+|	window is the number of games up to its end, or its last month yyyymm
+\*--------------------------------------------------------------*/
+
+enum WINDOWUNIT {WINDOW_GAMES, WINDOW_MONTHS};
+
+struct WINDOWCTRL {
+	  int					unit		// enum WINDOWUNIT
+	; long					size
+	; long					step
+	; long					simulate	// errors are written if > 1
+	; uint32_t				seed
+	; int					decimals
+	;
+};
+
+// lender is loaded (ordo_priors at most), its configuration is used for every window
+extern bool_t	window_run (const struct ordo_ctx *lender, thpool_t *pool, const struct WINDOWCTRL *wc, FILE *csvf);
+
+/*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#endif
@@ -23,6 +23,7 @@
 
 #include "boolean.h"
 #include "xpect.h"
+#include "stats.h"
 
 
 double inv_xpect	(double invbeta, double p) 
@@ -156,6 +157,8 @@ get_pWDL (double delta_rating /*delta rating*/, double *pw, double *pd, double *
 	double perf, pdra, pwin, plos;
 	bool_t switched;
 	
+	STAT_INC (STAT_PWDL);
+
 	switched = delta_rating < 0;
 	if (switched) delta_rating = -delta_rating;
 